@@ -87,6 +87,7 @@
 #include "ardour/session_state_utils.h"
 #include "ardour/session_utils.h"
 #include "ardour/slave.h"
+#include "ardour/source_factory.h"
 #include "ardour/system_exec.h"
 
 #ifdef WINDOWS_VST_SUPPORT
@@ -356,6 +357,10 @@ ARDOUR_UI::ARDOUR_UI (int *argcp, char **argvp[], const char* localedir, UIConfi
 	ARDOUR::Session::FeedbackDetected.connect (forever_connections, MISSING_INVALIDATOR, boost::bind (&ARDOUR_UI::feedback_detected, this), gui_context ());
 	ARDOUR::Session::SuccessfulGraphSort.connect (forever_connections, MISSING_INVALIDATOR, boost::bind (&ARDOUR_UI::successful_graph_sort, this), gui_context ());
 
+	/* show how far the background peakfile builders have got */
+
+	ARDOUR::SourceFactory::PeakBuildProgress.connect (forever_connections, MISSING_INVALIDATOR, boost::bind (&ARDOUR_UI::update_peak_build_progress, this, _1, _2), gui_context ());
+
 	/* handle requests to deal with missing files */
 
 	ARDOUR::Session::MissingFile.connect_same_thread (forever_connections, boost::bind (&ARDOUR_UI::missing_file, this, _1, _2, _3));
@@ -1464,6 +1469,21 @@ ARDOUR_UI::update_buffer_load ()
 	}
 }
 
+void
+ARDOUR_UI::update_peak_build_progress (uint32_t done, uint32_t total)
+{
+	/* only shown while there are peakfiles left to build */
+
+	if (done >= total) {
+		peak_build_label.set_text ("");
+		peak_build_label.hide ();
+		return;
+	}
+
+	peak_build_label.set_text (string_compose (_("Peaks: %1/%2"), done, total));
+	peak_build_label.show ();
+}
+
 void
 ARDOUR_UI::count_recenabled_streams (Route& route)
 {
@@ -557,6 +557,9 @@ class ARDOUR_UI : public Gtkmm2ext::UI, public ARDOUR::SessionHandlePtr
 	Gtk::Label   buffer_load_label;
 	void update_buffer_load ();
 
+	Gtk::Label   peak_build_label;
+	void update_peak_build_progress (uint32_t, uint32_t);
+
 	Gtk::Label   sample_rate_label;
 	void update_sample_rate (ARDOUR::framecnt_t);
 
@@ -500,6 +500,7 @@ ARDOUR_UI::build_menu_bar ()
 	xrun_label.set_use_markup ();
 	buffer_load_label.set_name ("BufferLoad");
 	buffer_load_label.set_use_markup ();
+	peak_build_label.set_name ("WallClock");
 	sample_rate_label.set_name ("SampleRate");
 	sample_rate_label.set_use_markup ();
 	format_label.set_name ("Format");
@@ -532,6 +533,8 @@ ARDOUR_UI::build_menu_bar ()
 	hbox->pack_end (sample_rate_label, false, false, 4);
 	hbox->pack_end (timecode_format_label, false, false, 4);
 	hbox->pack_end (format_label, false, false, 4);
+	/* not in _status_bar_visibility: shown only while peaks are being built */
+	hbox->pack_end (peak_build_label, false, false, 4);
 
 	menu_hbox.pack_end (*ev, false, false, 2);
 
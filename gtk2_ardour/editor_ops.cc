@@ -380,8 +380,18 @@ Editor::nudge_forward (bool next, bool force_playhead)
 
 		begin_reversible_command (_("nudge regions forward"));
 
+		/* batch the moves on each playlist, so that it is re-sorted,
+		   relayered and redrawn once rather than for every region.
+		*/
+		set<boost::shared_ptr<Playlist> > batched;
+
 		for (RegionSelection::iterator i = rs.begin(); i != rs.end(); ++i) {
 			boost::shared_ptr<Region> r ((*i)->region());
+			boost::shared_ptr<Playlist> pl (r->playlist());
+
+			if (pl && batched.insert (pl).second) {
+				pl->begin_batch ();
+			}
 
 			distance = get_nudge_distance (r->position(), next_distance);
 
@@ -391,7 +401,16 @@ Editor::nudge_forward (bool next, bool force_playhead)
 
 			r->clear_changes ();
 			r->set_position (r->position() + distance);
-			_session->add_command (new StatefulDiffCommand (r));
+
+			if (!pl) {
+				_session->add_command (new StatefulDiffCommand (r));
+			}
+		}
+
+		for (set<boost::shared_ptr<Playlist> >::iterator p = batched.begin(); p != batched.end(); ++p) {
+			vector<Command*> cmds;
+			(*p)->commit_batch (&cmds);
+			_session->add_commands (cmds);
 		}
 
 		commit_reversible_command ();
@@ -465,8 +484,16 @@ Editor::nudge_backward (bool next, bool force_playhead)
 
 		begin_reversible_command (_("nudge regions backward"));
 
+		/* see nudge_forward() */
+		set<boost::shared_ptr<Playlist> > batched;
+
 		for (RegionSelection::iterator i = rs.begin(); i != rs.end(); ++i) {
 			boost::shared_ptr<Region> r ((*i)->region());
+			boost::shared_ptr<Playlist> pl (r->playlist());
+
+			if (pl && batched.insert (pl).second) {
+				pl->begin_batch ();
+			}
 
 			distance = get_nudge_distance (r->position(), next_distance);
 
@@ -481,7 +508,16 @@ Editor::nudge_backward (bool next, bool force_playhead)
 			} else {
 				r->set_position (0);
 			}
-			_session->add_command (new StatefulDiffCommand (r));
+
+			if (!pl) {
+				_session->add_command (new StatefulDiffCommand (r));
+			}
+		}
+
+		for (set<boost::shared_ptr<Playlist> >::iterator p = batched.begin(); p != batched.end(); ++p) {
+			vector<Command*> cmds;
+			(*p)->commit_batch (&cmds);
+			_session->add_commands (cmds);
 		}
 
 		commit_reversible_command ();
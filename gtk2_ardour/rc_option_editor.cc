@@ -2075,6 +2075,25 @@ RCOptionEditor::RCOptionEditor ()
 
 	add_option (_("Transport"), _sync_source_2997);
 
+	ComboOption<VarispeedQuality>* vq = new ComboOption<VarispeedQuality> (
+		"varispeed-quality",
+		_("Varispeed and chase resampling"),
+		sigc::mem_fun (*_rc_config, &RCConfiguration::get_varispeed_quality),
+		sigc::mem_fun (*_rc_config, &RCConfiguration::set_varispeed_quality)
+		);
+
+	vq->add (VarispeedLinear, _("linear (fastest)"));
+	vq->add (VarispeedCubic, _("cubic"));
+	vq->add (VarispeedSinc16, _("16-point sinc"));
+	vq->add (VarispeedSinc64, _("64-point sinc (best)"));
+
+	Gtkmm2ext::UI::instance()->set_tip
+		(vq->tip_widget(),
+		 _("How audio played from disk is resampled when the transport speed is not 1, "
+		   "including while chasing external timecode. Better quality uses more CPU."));
+
+	add_option (_("Transport"), vq);
+
 	add_option (_("Transport"), new OptionEditorHeading (S_("LTC Reader")));
 
 	_ltc_port = new ComboStringOption (
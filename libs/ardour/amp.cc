@@ -28,6 +28,7 @@
 #include "ardour/buffer_set.h"
 #include "ardour/midi_buffer.h"
 #include "ardour/rc_configuration.h"
+#include "ardour/runtime_functions.h"
 #include "ardour/session.h"
 
 #include "i18n.h"
@@ -38,6 +39,37 @@ using namespace PBD;
 // used for low-pass filter denormal protection
 #define GAIN_COEFF_TINY (1e-10) // -200dB
 
+/* The declicking low-pass filter is recursive, so its output has to be
+ * computed one sample at a time; but it is the same for every channel.
+ * So compute it once, a block at a time, into a gain vector, and then
+ * apply that to each channel with the (vectorised) apply_gain_vector_to_buffer().
+ */
+static const pframes_t gain_ramp_block = 256;
+
+/** Fill @param gains with @param n steps of the filter from @param lpf
+ *  towards @param target, and @return the filter's next value.
+ */
+static double
+lpf_gain_ramp (gain_t* gains, pframes_t n, double lpf, double a, gain_t target)
+{
+	for (pframes_t nx = 0; nx < n; ++nx) {
+		gains[nx] = lpf;
+		lpf += a * (target - lpf);
+	}
+	return lpf;
+}
+
+/** As lpf_gain_ramp(), but towards a target which changes every sample */
+static double
+lpf_gain_ramp (gain_t* gains, pframes_t n, double lpf, double a, gain_t const * targets)
+{
+	for (pframes_t nx = 0; nx < n; ++nx) {
+		gains[nx] = lpf;
+		lpf += a * (targets[nx] - lpf);
+	}
+	return lpf;
+}
+
 Amp::Amp (Session& s, std::string type)
 	: Processor(s, "Amp")
 	, _apply_gain(true)
@@ -109,14 +141,15 @@ Amp::run (BufferSet& bufs, framepos_t /*start_frame*/, framepos_t /*end_frame*/,
 
 			const double a = 156.825 / _session.nominal_frame_rate(); // 25 Hz LPF; see Amp::apply_gain for details
 			double lpf = _current_gain;
+			gain_t gains[gain_ramp_block];
 
-			for (BufferSet::audio_iterator i = bufs.audio_begin(); i != bufs.audio_end(); ++i) {
-				Sample* const sp = i->data();
-				lpf = _current_gain;
-				for (pframes_t nx = 0; nx < nframes; ++nx) {
-					sp[nx] *= lpf;
-					lpf += a * (gab[nx] - lpf);
+			for (pframes_t done = 0; done < nframes; ) {
+				pframes_t const n = std::min (gain_ramp_block, nframes - done);
+				lpf = lpf_gain_ramp (gains, n, lpf, a, gab + done);
+				for (BufferSet::audio_iterator i = bufs.audio_begin(); i != bufs.audio_end(); ++i) {
+					apply_gain_vector_to_buffer (i->data() + done, gains, n);
 				}
+				done += n;
 			}
 
 			if (fabs (lpf) < GAIN_COEFF_TINY) {
@@ -212,17 +245,20 @@ Amp::apply_gain (BufferSet& bufs, framecnt_t sample_rate, framecnt_t nframes, ga
 	 */
 	const double a = 156.825 / sample_rate; // 25 Hz LPF
 
-	for (BufferSet::audio_iterator i = bufs.audio_begin(); i != bufs.audio_end(); ++i) {
-		Sample* const buffer = i->data();
+	if (bufs.count().n_audio()) {
 		double lpf = initial;
+		gain_t gains[gain_ramp_block];
 
-		for (pframes_t nx = 0; nx < nframes; ++nx) {
-			buffer[nx] *= lpf;
-			lpf += a * (target - lpf);
-		}
-		if (i == bufs.audio_begin()) {
-			rv = lpf;
+		for (pframes_t done = 0; done < nframes; ) {
+			pframes_t const n = std::min (gain_ramp_block, (pframes_t) nframes - done);
+			lpf = lpf_gain_ramp (gains, n, lpf, a, target);
+			for (BufferSet::audio_iterator i = bufs.audio_begin(); i != bufs.audio_end(); ++i) {
+				apply_gain_vector_to_buffer (i->data() + done, gains, n);
+			}
+			done += n;
 		}
+
+		rv = lpf;
 	}
 	if (fabsf (rv - target) < GAIN_COEFF_TINY) return target;
 	if (fabsf (rv) < GAIN_COEFF_TINY) return GAIN_COEFF_ZERO;
@@ -292,10 +328,14 @@ Amp::apply_gain (AudioBuffer& buf, framecnt_t sample_rate, framecnt_t nframes, g
 	const double a = 156.825 / sample_rate; // 25 Hz LPF, see [other] Amp::apply_gain() above for details
 
 	double lpf = initial;
-        for (pframes_t nx = 0; nx < nframes; ++nx) {
-                buffer[nx] *= lpf;
-		lpf += a * (target - lpf);
-        }
+	gain_t gains[gain_ramp_block];
+
+	for (pframes_t done = 0; done < nframes; ) {
+		pframes_t const n = std::min (gain_ramp_block, (pframes_t) nframes - done);
+		lpf = lpf_gain_ramp (gains, n, lpf, a, target);
+		apply_gain_vector_to_buffer (buffer + done, gains, n);
+		done += n;
+	}
 
 	if (fabs (lpf - target) < GAIN_COEFF_TINY) return target;
 	if (fabs (lpf) < GAIN_COEFF_TINY) return GAIN_COEFF_ZERO;
@@ -30,8 +30,10 @@
 
 #include <boost/utility.hpp>
 
+#include <glibmm/threads.h>
+
 #include "pbd/fastlog.h"
-#include "pbd/ringbufferNPT.h"
+#include "pbd/spsc_ringbuffer.h"
 #include "pbd/stateful.h"
 #include "pbd/rcu.h"
 
@@ -63,6 +65,12 @@ class LIBARDOUR_API AudioDiskstream : public Diskstream
 	float playback_buffer_load() const;
 	float capture_buffer_load() const;
 
+	/** Give the calling thread its own working buffers for do_refill(),
+	 *  so that it can refill diskstreams at the same time as the butler.
+	 *  They are freed when the thread exits.
+	 */
+	static void allocate_thread_working_buffers ();
+
 	std::string input_source (uint32_t n=0) const {
 		boost::shared_ptr<ChannelList> c = channels.reader();
 		if (n < c->size()) {
@@ -185,17 +193,17 @@ class LIBARDOUR_API AudioDiskstream : public Diskstream
 		/** A ringbuffer for data to be played back, written to in the
 		    butler thread, read from in the process thread.
 		*/
-		PBD::RingBufferNPT<Sample> *playback_buf;
-		PBD::RingBufferNPT<Sample> *capture_buf;
+		PBD::SPSCRingBuffer<Sample> *playback_buf;
+		PBD::SPSCRingBuffer<Sample> *capture_buf;
 
 		Sample* scrub_buffer;
 		Sample* scrub_forward_buffer;
 		Sample* scrub_reverse_buffer;
 
-		PBD::RingBufferNPT<Sample>::rw_vector playback_vector;
-		PBD::RingBufferNPT<Sample>::rw_vector capture_vector;
+		PBD::SPSCRingBuffer<Sample>::rw_vector playback_vector;
+		PBD::SPSCRingBuffer<Sample>::rw_vector capture_vector;
 
-		PBD::RingBufferNPT<CaptureTransition> * capture_transition_buf;
+		PBD::SPSCRingBuffer<CaptureTransition> * capture_transition_buf;
 		// the following are used in the butler thread only
 		framecnt_t                     curr_capture_cnt;
 
@@ -205,11 +213,12 @@ class LIBARDOUR_API AudioDiskstream : public Diskstream
 
 	typedef std::vector<ChannelInfo*> ChannelList;
 
-	CubicInterpolation interpolation;
+	VarispeedInterpolation interpolation;
 
 	/* The two central butler operations */
 	int do_flush (RunContext context, bool force = false);
-	int do_refill () { return _do_refill(_mixdown_buffer, _gain_buffer, 0); }
+	int do_refill ();
+	void prefetch (DiskReadAhead&);
 
 
 	int read (Sample* buf, Sample* mixdown_buffer, float* gain_buffer,
@@ -252,6 +261,16 @@ class LIBARDOUR_API AudioDiskstream : public Diskstream
 	static Sample* _mixdown_buffer;
 	static gain_t* _gain_buffer;
 
+	struct WorkingBuffers {
+		WorkingBuffers ();
+		~WorkingBuffers ();
+
+		Sample* mixdown_buffer;
+		gain_t* gain_buffer;
+	};
+
+	static Glib::Threads::Private<WorkingBuffers> _thread_working_buffers;
+
 	std::vector<boost::shared_ptr<AudioFileSource> > capturing_sources;
 
 	SerializedRCUManager<ChannelList> channels;
@@ -262,6 +281,7 @@ class LIBARDOUR_API AudioDiskstream : public Diskstream
  /* really */
   private:
 	int _do_refill (Sample *mixdown_buffer, float *gain_buffer, framecnt_t fill_level);
+	framecnt_t refill_read_size (framecnt_t total_space) const;
 
 	int add_channel_to (boost::shared_ptr<ChannelList>, uint32_t how_many);
 	int remove_channel_from (boost::shared_ptr<ChannelList>, uint32_t how_many);
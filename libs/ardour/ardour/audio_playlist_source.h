@@ -65,6 +65,12 @@ private:
 	uint32_t    _playlist_channel;
 	std::string _peak_path;
 
+	/** Serializes use of the shared per-level mixdown buffers, which
+	 *  more than one butler thread may want at the same time.  Reads
+	 *  recurse into lower levels, hence a recursive mutex.
+	 */
+	static Glib::Threads::RecMutex _level_read_lock;
+
 	int set_state (const XMLNode&, int version, bool with_descendants);
 };
 
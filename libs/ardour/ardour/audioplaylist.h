@@ -32,6 +32,7 @@ class Session;
 class AudioRegion;
 class Source;
 class AudioPlaylist;
+class DiskReadAhead;
 
 class LIBARDOUR_API AudioPlaylist : public ARDOUR::Playlist
 {
@@ -42,6 +43,7 @@ public:
 	AudioPlaylist (boost::shared_ptr<const AudioPlaylist>, framepos_t start, framecnt_t cnt, std::string name, bool hidden = false);
 
 	framecnt_t read (Sample *dst, Sample *mixdown, float *gain_buffer, framepos_t start, framecnt_t cnt, uint32_t chan_n=0);
+	void prefetch (DiskReadAhead&, framepos_t start, framecnt_t cnt, uint32_t chan_n=0);
 
 	bool destroy_region (boost::shared_ptr<Region>);
 
@@ -57,6 +59,18 @@ private:
 	bool region_changed (const PBD::PropertyChange&, boost::shared_ptr<Region>);
 	void source_offset_changed (boost::shared_ptr<AudioRegion>);
         void load_legacy_crossfades (const XMLNode&, int version);
+
+	class ReadPlan;
+
+	boost::shared_ptr<ReadPlan> read_plan ();
+
+	/* what read() must read, worked out for the whole playlist and
+	   rebuilt by read_plan() when _region_generation moves on from
+	   _read_plan_generation.
+	*/
+	Glib::Threads::Mutex _read_plan_lock;
+	boost::shared_ptr<ReadPlan> _read_plan;
+	gint _read_plan_generation;
 };
 
 } /* namespace ARDOUR */
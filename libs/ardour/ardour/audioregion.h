@@ -57,6 +57,8 @@ class Playlist;
 class Session;
 class Filter;
 class AudioSource;
+class DiskReadAhead;
+class PeakView;
 
 
 class LIBARDOUR_API AudioRegion : public Region
@@ -100,6 +102,14 @@ class LIBARDOUR_API AudioRegion : public Region
 			framecnt_t offset, framecnt_t cnt,
 			uint32_t chan_n=0, double frames_per_pixel = 1.0) const;
 
+	/** Like read_peaks(), but rather than copying the peaks set up
+	 *  @param view to look straight at the stored peaks of channel
+	 *  @param chan_n, scaled by our amplitude.
+	 *  @return false if there are no stored peaks to look at.
+	 */
+	bool peak_view (PeakView& view, framecnt_t offset, framecnt_t cnt,
+			uint32_t chan_n, double frames_per_pixel) const;
+
 	/* Readable interface */
 
 	virtual framecnt_t read (Sample*, framepos_t pos, framecnt_t cnt, int channel) const;
@@ -115,6 +125,8 @@ class LIBARDOUR_API AudioRegion : public Region
 
 	virtual framecnt_t read_raw_internal (Sample*, framepos_t, framecnt_t, int channel) const;
 
+	void prefetch (DiskReadAhead&, framepos_t position, framecnt_t cnt, uint32_t chan_n = 0) const;
+
 	XMLNode& state ();
 	XMLNode& get_basic_state ();
 	int set_state (const XMLNode&, int version);
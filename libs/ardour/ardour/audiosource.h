@@ -20,8 +20,11 @@
 #ifndef __ardour_audio_source_h__
 #define __ardour_audio_source_h__
 
+#include <list>
+
 #include <boost/shared_ptr.hpp>
 #include <boost/shared_array.hpp>
+#include <boost/weak_ptr.hpp>
 #include <boost/enable_shared_from_this.hpp>
 
 #include <time.h>
@@ -38,6 +41,37 @@
 
 namespace ARDOUR {
 
+class PeakFileMap;
+
+/** A read-only view of part of one level of the peak data in a peakfile,
+ *  pointing straight into the memory the peakfile is mapped to.  The view
+ *  holds a reference to the mapping, so it stays valid after the source
+ *  has remapped or rewritten its peakfile.
+ */
+class LIBARDOUR_API PeakView
+{
+  public:
+	PeakView () : peaks (0), npeaks (0), samples_per_peak (0), start (0), scale (1.0) {}
+
+	/** Reduce the view to @param n peaks of @param samples_per_visual_peak
+	 *  frames each, starting at frame @param pos of the source, and write
+	 *  them, multiplied by scale, to @param buf.  Any peaks beyond the end
+	 *  of the view are zeroed.
+	 *  @return number of peaks that came from the view.
+	 */
+	framecnt_t read (PeakData* buf, framecnt_t n, framepos_t pos, double samples_per_visual_peak) const;
+
+	PeakData const * peaks; ///< first peak of the view
+	framecnt_t npeaks;
+	framecnt_t samples_per_peak;
+	framepos_t start; ///< source frame of the first peak
+	float      scale; ///< gain to apply to the peaks when reading them
+
+  private:
+	friend class AudioSource;
+	boost::shared_ptr<PeakFileMap const> _map;
+};
+
 class LIBARDOUR_API AudioSource : virtual public Source,
 		public ARDOUR::Readable,
 		public boost::enable_shared_from_this<ARDOUR::AudioSource>
@@ -59,6 +93,13 @@ class LIBARDOUR_API AudioSource : virtual public Source,
 	virtual framecnt_t read (Sample *dst, framepos_t start, framecnt_t cnt, int channel=0) const;
 	virtual framecnt_t write (Sample *src, framecnt_t cnt);
 
+	/** @return true if read_ahead() does anything useful for this source */
+	virtual bool can_read_ahead () const { return false; }
+	/** Ask the OS to start reading @param cnt frames from @param start
+	 *  into its cache, ready for a later read().  Used by DiskReadAhead.
+	 */
+	void read_ahead (framepos_t start, framecnt_t cnt) const;
+
 	virtual float sample_rate () const = 0;
 
 	virtual void mark_streaming_write_completed (const Lock& lock);
@@ -71,6 +112,14 @@ class LIBARDOUR_API AudioSource : virtual public Source,
 	int read_peaks (PeakData *peaks, framecnt_t npeaks,
 			framepos_t start, framecnt_t cnt, double samples_per_visual_peak) const;
 
+	/** Set up @param view to look at the stored peaks covering @param cnt
+	 *  frames from @param start, from the coarsest level of the peakfile
+	 *  with no more than @param samples_per_visual_peak frames per peak.
+	 *  @return false if there are no suitable stored peaks, in which case
+	 *  read_peaks() must be used instead.
+	 */
+	bool peak_view (PeakView& view, framepos_t start, framecnt_t cnt, double samples_per_visual_peak) const;
+
 	int  build_peaks ();
 	bool peaks_ready (boost::function<void()> callWhenReady, PBD::ScopedConnection** connection_created_if_not_ready, PBD::EventLoop* event_loop) const;
 
@@ -136,6 +185,10 @@ class LIBARDOUR_API AudioSource : virtual public Source,
 
 	virtual framecnt_t read_unlocked (Sample *dst, framepos_t start, framecnt_t cnt) const = 0;
 	virtual framecnt_t write_unlocked (Sample *dst, framecnt_t cnt) = 0;
+	/** Called by read_ahead() without _lock held; implementations should
+	 *  take it only for as long as it takes to copy what they need.
+	 */
+	virtual void read_ahead_unlocked (framepos_t /*start*/, framecnt_t /*cnt*/) const {}
 	virtual std::string peak_path(std::string audio_path) = 0;
 	virtual std::string find_broken_peakfile (std::string /* missing_peak_path */,
 	                                          std::string audio_path) { return peak_path (audio_path); }
@@ -169,6 +222,53 @@ class LIBARDOUR_API AudioSource : virtual public Source,
 	mutable off_t _last_map_off;
 	mutable size_t  _last_raw_map_length;
 	mutable boost::scoped_array<PeakData> peak_cache;
+
+	/* Coarser levels of peak data (a "pyramid"), each one made from
+	 * the level-0 peaks as they are written, and stored after the level-0
+	 * data at the end of the peakfile once it is complete.  Zoomed-out
+	 * reads use the coarsest level that still has enough resolution.
+	 */
+
+	struct PeakLevel {
+		PeakLevel (framecnt_t f, off_t o, framecnt_t n) : fpp (f), offset (o), npeaks (n) {}
+		framecnt_t fpp;
+		off_t      offset; ///< byte offset of this level in the peakfile
+		framecnt_t npeaks;
+	};
+
+	struct PeakLevelBuilder {
+		PeakLevelBuilder (framecnt_t f) : fpp (f), count (0) {}
+		framecnt_t fpp;
+		std::vector<PeakData> peaks;
+		PeakData   current;
+		framecnt_t count; ///< number of level-0 peaks merged into current
+	};
+
+	/** levels that are present in the peakfile; protected by _peak_levels_lock */
+	std::vector<PeakLevel> _peak_levels;
+	/** the peakfile, mapped into memory by the first read that needs it and
+	 *  kept until it has to be remapped; also protected by _peak_levels_lock
+	 */
+	mutable boost::shared_ptr<PeakFileMap const> _peak_map;
+	/** earlier mappings, which may still be held by PeakViews */
+	mutable std::list<boost::weak_ptr<PeakFileMap const> > _retired_peak_maps;
+	mutable Glib::Threads::Mutex _peak_levels_lock;
+
+	std::vector<PeakLevelBuilder> _peak_level_builders;
+	/** frame following the last level-0 peak given to the builders,
+	 *  or -1 if the levels cannot be built from this pass of writes.
+	 */
+	framepos_t _peak_level_next_frame;
+
+	void add_to_peak_levels (PeakData const *, uint32_t npeaks, framepos_t first_frame, framepos_t end_frame);
+	int  write_peak_levels ();
+	off_t load_peak_levels (off_t file_size);
+	bool peak_level_for (double samples_per_visual_peak, PeakLevel&) const;
+
+	boost::shared_ptr<PeakFileMap const> peak_map (off_t length_needed) const;
+	void drop_peak_map ();
+	bool peak_map_in_use () const;
+	int  shrink_peakfile (off_t length);
 };
 
 }
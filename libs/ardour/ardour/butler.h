@@ -21,6 +21,9 @@
 #define __ardour_butler_h__
 
 #include <pthread.h>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
 
 #include <glibmm/threads.h>
 
@@ -31,6 +34,7 @@
 #include "pbd/crossthread.h"
 #include "pbd/ringbuffer.h"
 #include "pbd/pool.h"
+#include "ardour/disk_read_ahead.h"
 #include "ardour/libardour_visibility.h"
 #include "ardour/types.h"
 #include "ardour/session_handle.h"
@@ -39,6 +43,8 @@
 
 namespace ARDOUR {
 
+class Track;
+
 /**
  *  One of the Butler's functions is to clean up (ie delete) unused CrossThreadPools.
  *  When a thread with a CrossThreadPool terminates, its CTP is added to pool_trash.
@@ -70,6 +76,9 @@ class LIBARDOUR_API Butler : public SessionHandleRef
 	static void* _thread_work(void *arg);
 	void*         thread_work();
 
+	static void* _helper_thread_work(void *arg);
+	void*         helper_thread_work();
+
 	struct Request {
 		enum Type {
 			Run,
@@ -93,6 +102,47 @@ private:
 	void empty_pool_trash ();
 	void config_changed (std::string);
 
+	/* Disk work is shared out amongst the butler thread and a set of
+	   helper threads.  The butler thread fills in a list of tracks,
+	   wakes the helpers, works through the list alongside them and then
+	   waits for them all to finish, so transport work is never done
+	   while any disk work is in progress.  The helpers are started
+	   before the butler thread and stopped after it, so _helpers does
+	   not change while the butler thread is running.
+	*/
+
+	typedef std::vector<boost::shared_ptr<Track> > TrackList;
+
+	std::vector<pthread_t> _helpers;
+	Glib::Threads::Mutex   _work_lock;
+	Glib::Threads::Cond    _work_cond;
+	Glib::Threads::Cond    _work_done_cond;
+	/** incremented each time a new batch of work is posted */
+	uint32_t               _work_generation;
+	/** _work_generation when the helpers were started, before the
+	    butler thread could post any work; each helper waits for a
+	    batch newer than this.
+	*/
+	uint32_t               _helpers_start_generation;
+	/** number of helpers still working on the current batch */
+	uint32_t               _helpers_busy;
+	bool                   _helpers_quit;
+
+	TrackList const*       _work_tracks;
+	bool                   _work_is_flush;
+	/** index of the next track in _work_tracks to be processed */
+	volatile gint          _work_next;
+	/** set if any track has more work to do after this batch */
+	volatile gint          _work_outstanding;
+	volatile gint          _work_errors;
+
+	DiskReadAhead          _read_ahead;
+
+	void start_helpers (uint32_t);
+	void stop_helpers ();
+	bool do_disk_work (TrackList const &, bool flush, uint32_t& errors);
+	void process_work ();
+
 	/**
 	 * Add request to butler thread request queue
 	 */
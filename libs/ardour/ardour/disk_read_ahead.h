@@ -0,0 +1,103 @@
+/*
+    Copyright (C) 2015 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __ardour_disk_read_ahead_h__
+#define __ardour_disk_read_ahead_h__
+
+#include <pthread.h>
+#include <deque>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include <glibmm/threads.h>
+
+#include "ardour/libardour_visibility.h"
+#include "ardour/types.h"
+
+namespace ARDOUR {
+
+class AudioSource;
+
+/** Asynchronous read-ahead for the butler's disk reads.
+ *
+ *  Before refilling, the butler asks every track which parts of which
+ *  sources it is about to read.  The requests for all channels of all
+ *  tracks are queued here, merged where they overlap, and then submitted
+ *  as one batch to a small pool of threads which ask the OS to start
+ *  reading the data into its cache.  The butler's own (blocking) reads
+ *  then mostly find their data already in memory, instead of waiting for
+ *  each seek in turn.
+ *
+ *  The reads themselves still go through the sources as usual, so this is
+ *  purely an optimisation; if it is not running, nothing changes.
+ */
+class LIBARDOUR_API DiskReadAhead
+{
+  public:
+	DiskReadAhead ();
+	~DiskReadAhead ();
+
+	int  start (uint32_t nthreads);
+	void stop ();
+	bool running () const { return !_threads.empty (); }
+
+	/** Note that @param cnt frames from @param start of @param src will
+	 *  soon be read.  Nothing is done until submit() is called.
+	 */
+	void queue (boost::shared_ptr<AudioSource const> src, framepos_t start, framecnt_t cnt);
+
+	/** Hand everything queued since the last call to the I/O threads,
+	 *  replacing any earlier requests which they have not yet started.
+	 */
+	void submit ();
+
+  private:
+	struct Request {
+		Request (boost::shared_ptr<AudioSource const> s, framepos_t st, framecnt_t c, uint32_t o)
+			: source (s), start (st), cnt (c), order (o) {}
+
+		boost::shared_ptr<AudioSource const> source;
+		framepos_t start;
+		framecnt_t cnt;
+		/** position in the order that requests were queued */
+		uint32_t   order;
+	};
+
+	struct SourceSorter;
+	struct OrderSorter;
+
+	typedef std::vector<Request> Requests;
+
+	std::vector<pthread_t> _threads;
+	Glib::Threads::Mutex   _lock;
+	Glib::Threads::Cond    _cond;
+	/** requests queued but not yet submitted */
+	Requests               _pending;
+	/** requests submitted and waiting for an I/O thread */
+	std::deque<Request>    _submitted;
+	bool                   _quit;
+
+	static void* _thread_work (void *);
+	void thread_work ();
+};
+
+} // namespace ARDOUR
+
+#endif /* __ardour_disk_read_ahead_h__ */
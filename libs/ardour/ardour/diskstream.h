@@ -244,6 +244,8 @@ class LIBARDOUR_API Diskstream : public SessionObject, public PublicDiskstream
 	/* The two central butler operations */
 	virtual int do_flush (RunContext context, bool force = false) = 0;
 	virtual int do_refill () = 0;
+	/** Queue read-ahead for the data that the next do_refill() will read */
+	virtual void prefetch (DiskReadAhead&) {}
 
 	/* XXX fix this redundancy ... */
 
@@ -0,0 +1,139 @@
+/*
+    Copyright (C) 2015 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __ardour_dsp_profiler_h__
+#define __ardour_dsp_profiler_h__
+
+#include <list>
+#include <map>
+#include <vector>
+
+#include <glibmm/threads.h>
+
+#include "pbd/ringbuffer.h"
+
+#include "ardour/cycles.h"
+#include "ardour/libardour_visibility.h"
+
+namespace ARDOUR {
+
+/** Continuous, realtime-safe timing of the work done by routes and processors.
+ *
+ *  Process threads time each processor that they run, and each route's
+ *  whole processor chain, and push the results into a ring buffer that
+ *  belongs to the thread (see ThreadBuffers).  When profiling is disabled
+ *  nothing is timed or recorded, and the only cost is a flag test.
+ *
+ *  Any other thread may call stats(), which moves everything in the ring
+ *  buffers into per-object histories and summarises the most recent
+ *  window_size measurements for the object in question.  Objects are
+ *  identified by their address, which the profiler never dereferences.
+ */
+class LIBARDOUR_API DSPProfiler
+{
+  public:
+	/** One measurement, as written by a process thread */
+	struct Timing {
+		void const* object;
+		cycles_t    cycles;
+	};
+
+	typedef RingBuffer<Timing> Timings;
+
+	/** A summary of recent measurements of one object, in microseconds per cycle */
+	struct Stats {
+		Stats () : count (0), min (0), avg (0), max (0), p95 (0), p99 (0) {}
+
+		uint32_t count; ///< number of measurements summarised
+		float min;
+		float avg;
+		float max;
+		float p95;      ///< 95th percentile
+		float p99;      ///< 99th percentile
+	};
+
+	static const uint32_t window_size = 1024;
+
+	static void set_enabled (bool);
+	static bool enabled () { return _enabled; }
+
+	/** @return a timestamp for a measurement, in the profiler's own units */
+	static cycles_t now () { return _use_cycles ? get_cycles () : (cycles_t) fallback_now (); }
+
+	/** Process thread: record that @param object took from @param start until
+	 *  now to run.  Measurements are dropped if the thread's ring buffer is full.
+	 */
+	static void record (void const* object, cycles_t start);
+
+	static bool stats (void const* object, Stats&);
+	static void forget (void const* object);
+	static void reset ();
+
+	/* for ThreadBuffers */
+	static Timings* add_timings ();
+
+  private:
+	struct History {
+		History () : next (0) {}
+		std::vector<float> usecs;
+		uint32_t next;
+	};
+
+	typedef std::map<void const*, History> Histories;
+
+	static bool   _enabled;
+	static bool   _use_cycles;
+	static float  _cycles_per_usec;
+
+	static Glib::Threads::Mutex _lock;
+	static Histories            _histories;
+	static std::list<Timings*>  _timings;
+
+	static uint64_t fallback_now ();
+	static void calibrate ();
+	static void collect ();
+};
+
+/** Time the lifetime of an instance, if profiling is enabled,
+ *  and record it against some object.
+ */
+class LIBARDOUR_API DSPTimer
+{
+  public:
+	DSPTimer (void const* object)
+		: _object (object)
+		, _start (DSPProfiler::enabled () ? DSPProfiler::now () : 0)
+		, _active (DSPProfiler::enabled ())
+	{}
+
+	~DSPTimer () {
+		if (_active) {
+			DSPProfiler::record (_object, _start);
+		}
+	}
+
+  private:
+	void const* _object;
+	cycles_t    _start;
+	bool        _active;
+};
+
+} // namespace
+
+#endif /* __ardour_dsp_profiler_h__ */
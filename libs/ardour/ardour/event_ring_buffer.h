@@ -23,7 +23,7 @@
 #include <algorithm>
 #include <iostream>
 
-#include "pbd/ringbufferNPT.h"
+#include "pbd/spsc_ringbuffer.h"
 
 #include "evoral/EventSink.hpp"
 #include "evoral/types.hpp"
@@ -35,18 +35,18 @@ namespace ARDOUR {
  * This packs a timestamp, size, and size bytes of data flat into the buffer.
  * Useful for MIDI events, OSC messages, etc.
  *
- * Note: the uint8_t template argument to RingBufferNPT<> indicates "byte
+ * Note: the uint8_t template argument to SPSCRingBuffer<> indicates "byte
  * oriented data", not anything particular linked to MIDI or any other
  * possible interpretation of uint8_t.
  */
 template<typename Time>
-class EventRingBuffer : public PBD::RingBufferNPT<uint8_t>
+class EventRingBuffer : public PBD::SPSCRingBuffer<uint8_t>
                       , public Evoral::EventSink<Time> {
 public:
 
 	/** @param capacity Ringbuffer capacity in bytes.
 	 */
-	EventRingBuffer(size_t capacity) : PBD::RingBufferNPT<uint8_t>(capacity)
+	EventRingBuffer(size_t capacity) : PBD::SPSCRingBuffer<uint8_t>(capacity)
 	{}
 
 	inline size_t capacity() const { return bufsize(); }
@@ -69,7 +69,7 @@ template<typename Time>
 inline bool
 EventRingBuffer<Time>::peek (uint8_t* buf, size_t size)
 {
-	PBD::RingBufferNPT<uint8_t>::rw_vector vec;
+	PBD::SPSCRingBuffer<uint8_t>::rw_vector vec;
 
 	get_read_vector (&vec);
 
@@ -94,19 +94,19 @@ template<typename Time>
 inline bool
 EventRingBuffer<Time>::read(Time* time, Evoral::EventType* type, uint32_t* size, uint8_t* buf)
 {
-	if (PBD::RingBufferNPT<uint8_t>::read ((uint8_t*)time, sizeof (Time)) != sizeof (Time)) {
+	if (PBD::SPSCRingBuffer<uint8_t>::read ((uint8_t*)time, sizeof (Time)) != sizeof (Time)) {
 		return false;
 	}
 
-	if (PBD::RingBufferNPT<uint8_t>::read ((uint8_t*)type, sizeof(Evoral::EventType)) != sizeof (Evoral::EventType)) {
+	if (PBD::SPSCRingBuffer<uint8_t>::read ((uint8_t*)type, sizeof(Evoral::EventType)) != sizeof (Evoral::EventType)) {
 		return false;
 	}
 
-	if (PBD::RingBufferNPT<uint8_t>::read ((uint8_t*)size, sizeof(uint32_t)) != sizeof (uint32_t)) {
+	if (PBD::SPSCRingBuffer<uint8_t>::read ((uint8_t*)size, sizeof(uint32_t)) != sizeof (uint32_t)) {
 		return false;
 	}
 
-	if (PBD::RingBufferNPT<uint8_t>::read (buf, *size) != *size) {
+	if (PBD::SPSCRingBuffer<uint8_t>::read (buf, *size) != *size) {
 		return false;
 	}
 
@@ -120,10 +120,10 @@ EventRingBuffer<Time>::write(Time time, Evoral::EventType type, uint32_t size, c
 	if (!buf || write_space() < (sizeof(Time) + sizeof(Evoral::EventType) + sizeof(uint32_t) + size)) {
 		return 0;
 	} else {
-		PBD::RingBufferNPT<uint8_t>::write ((uint8_t*)&time, sizeof(Time));
-		PBD::RingBufferNPT<uint8_t>::write ((uint8_t*)&type, sizeof(Evoral::EventType));
-		PBD::RingBufferNPT<uint8_t>::write ((uint8_t*)&size, sizeof(uint32_t));
-		PBD::RingBufferNPT<uint8_t>::write (buf, size);
+		PBD::SPSCRingBuffer<uint8_t>::write ((uint8_t*)&time, sizeof(Time));
+		PBD::SPSCRingBuffer<uint8_t>::write ((uint8_t*)&type, sizeof(Evoral::EventType));
+		PBD::SPSCRingBuffer<uint8_t>::write ((uint8_t*)&size, sizeof(uint32_t));
+		PBD::SPSCRingBuffer<uint8_t>::write (buf, size);
 		return size;
 	}
 }
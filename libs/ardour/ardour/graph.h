@@ -29,8 +29,10 @@
 #include <boost/shared_ptr.hpp>
 
 #include <glib.h>
+#include <glibmm/threads.h>
 
 #include "pbd/semutils.h"
+#include "pbd/work_stealing_deque.h"
 
 #include "ardour/libardour_visibility.h"
 #include "ardour/types.h"
@@ -52,10 +54,51 @@ typedef boost::shared_ptr<GraphNode> node_ptr_t;
 typedef std::list< node_ptr_t > node_list_t;
 typedef std::set< node_ptr_t > node_set_t;
 
+/** A piece of a node's work which is independent of the rest of it,
+ *  and which can therefore be handed to other graph threads while the
+ *  node is being processed; see Graph::process_subtasks().
+ */
+class LIBARDOUR_API GraphSubTask
+{
+public:
+	GraphSubTask () : _pending (0), _done (0) {}
+	virtual ~GraphSubTask () {}
+
+	virtual void run () = 0;
+
+private:
+	friend class Graph;
+	/** count of unfinished tasks in the batch that this task belongs to */
+	gint* _pending;
+	/** signalled by whichever thread finishes the batch's last task */
+	PBD::ProcessSemaphore* _done;
+};
+
 class LIBARDOUR_API Graph : public SessionHandleRef
 {
 public:
 	Graph (Session & session);
+	~Graph ();
+
+	/** Scheduler statistics for one process cycle, only collected when
+	 *  the work-stealing scheduler is in use.
+	 */
+	struct CycleStats {
+		CycleStats () : steals (0), failed_steals (0), overflows (0), idle_usecs (0) {}
+
+		/** nodes that were run by a thread other than the one that triggered them */
+		uint32_t steals;
+		/** steal attempts that found another thread's deque empty or lost a race */
+		uint32_t failed_steals;
+		/** nodes that went to the shared queue because a thread's deque was full */
+		uint32_t overflows;
+		/** total time that process threads spent with no node to run */
+		uint32_t idle_usecs;
+	};
+
+	bool work_stealing () const { return _work_stealing; }
+	/** @return statistics for the most recently completed cycle */
+	CycleStats cycle_stats () const;
 
 	void prep();
 	void trigger (GraphNode * n);
@@ -84,6 +127,9 @@ public:
 	void clear_other_chain ();
 
 	bool in_process_thread () const;
+	bool in_graph_thread () const;
+
+	void process_subtasks (GraphSubTask** tasks, uint32_t n_tasks);
 
 protected:
 	virtual void session_going_away ();
@@ -93,14 +139,64 @@ private:
 
 	void reset_thread_list ();
 	void drop_threads ();
+	void run_node (GraphNode*);
+	void push_trigger_queue (GraphNode*);
+	GraphNode* pop_trigger_queue ();
+	GraphSubTask* pop_subtask ();
+	void run_subtask (GraphSubTask*);
+	void parameter_changed (std::string const &);
+
+	/* work-stealing scheduler */
+
+	struct Worker {
+		Worker (std::string const & name);
+
+		/** nodes triggered by this worker's thread, in LIFO order */
+		PBD::WorkStealingDeque<GraphNode> deque;
+		/** signalled once for each batch of subtasks that this worker's
+		    thread queues, when the last of them has finished
+		*/
+		PBD::ProcessSemaphore subtasks_done;
+
+		gint steals;
+		gint failed_steals;
+		gint overflows;
+		gint idle_usecs;
+	};
+
+	bool run_one_stealing ();
+	GraphNode* steal (Worker*);
+	void wake_one ();
+	void claim_worker ();
+	void publish_cycle_stats ();
+
+	bool                 _work_stealing;
+	std::vector<Worker*> _workers;
+	volatile gint        _next_worker;
+	/** number of nodes in _trigger_queue; only used by the work-stealing scheduler */
+	volatile gint        _overflow_size;
+	/** start of the current cycle, used to clip idle time to the cycle */
+	microseconds_t       _cycle_start;
+
+	/** the Worker owned by the calling thread */
+	static Glib::Threads::Private<Worker> _worker;
+
+	CycleStats    _cycle_stats[2];
+	volatile gint _cycle_stats_index;
 
 	node_list_t _nodes_rt[2];
 
 	node_list_t _init_trigger_list[2];
 
+	/** nodes ready to run, kept as a heap with the highest priority first */
 	std::vector<GraphNode *> _trigger_queue;
 	pthread_mutex_t          _trigger_mutex;
 
+	/** subtasks waiting for a thread; protected by _trigger_mutex */
+	std::vector<GraphSubTask *> _subtask_queue;
+	/** number of entries in _subtask_queue, for checking without the lock */
+	volatile gint               _subtask_count;
+
 	PBD::ProcessSemaphore _execution_sem;
 
 	/** Signalled to start a run of the graph for a process callback */
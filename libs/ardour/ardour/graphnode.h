@@ -27,6 +27,8 @@
 
 #include <boost/shared_ptr.hpp>
 
+#include "ardour/types.h"
+
 namespace ARDOUR
 {
 
@@ -50,6 +52,14 @@ class LIBARDOUR_API GraphNode
 
 	virtual void process();
 
+	/** @return smoothed time taken by process(), in microseconds */
+	float dsp_cost () const { return _cost; }
+
+	/** @return dsp_cost() plus the cost of the most expensive path
+	 *  from this node to the output end of the graph.
+	 */
+	float priority () const { return _priority; }
+
     private:
 	friend class Graph;
 
@@ -61,6 +71,12 @@ class LIBARDOUR_API GraphNode
 	gint _refcount;
 	/** The number of nodes that we directly feed us (one count for each chain) */
 	gint _init_refcount[2];
+
+	void update_cost (microseconds_t);
+	void update_priority (int chain);
+
+	float _cost;
+	float _priority;
 };
 
 }
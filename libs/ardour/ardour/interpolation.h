@@ -19,6 +19,7 @@
 
 #include <math.h>
 #include <samplerate.h>
+#include <vector>
 
 #include "ardour/libardour_visibility.h"
 #include "ardour/types.h"
@@ -68,6 +69,69 @@ public:
 	framecnt_t interpolate (int channel, framecnt_t nframes, Sample* input, Sample* output);
 };
 
+/** Varispeed for disk playback.  Resamples each channel by a speed which
+ *  may glide, within a block, from the one set by set_speed() to the one set
+ *  by set_target_speed(), using an interpolator chosen by set_quality().
+ *
+ *  Unlike the interpolators above this one keeps the last few input samples
+ *  of each channel, so that there is no discontinuity at block boundaries;
+ *  and it may read lookahead() samples beyond the last one it consumes.
+ */
+class LIBARDOUR_API VarispeedInterpolation : public Interpolation {
+public:
+	VarispeedInterpolation ();
+
+	void set_quality (VarispeedQuality);
+	VarispeedQuality quality () const { return _quality; }
+
+	/** @return the number of input samples after the last one consumed which
+	 *  interpolate() may read at the current quality.
+	 */
+	framecnt_t lookahead () const { return _taps / 2; }
+	/** @return the greatest value that lookahead() can take */
+	static framecnt_t max_lookahead () { return max_taps / 2; }
+
+	void add_channel_to (int input_buffer_size, int output_buffer_size);
+	void remove_channel_from ();
+	void reset ();
+
+	/** @return the number of input samples that interpolate() may read
+	 *  for a block of @param nframes at the current speeds.
+	 */
+	framecnt_t input_needed (framecnt_t nframes) const;
+
+	/** Interpolate @param nframes samples into @param output from @param input,
+	 *  which must hold at least input_needed (nframes) samples.  A glide
+	 *  consumes a different number from the session at target_speed(), and
+	 *  the following blocks make up the difference.  If either buffer is 0
+	 *  nothing is interpolated, but the position is still moved on.
+	 *  @return the number of input samples consumed.
+	 */
+	framecnt_t interpolate (int channel, framecnt_t nframes, Sample* input, Sample* output);
+
+private:
+	static const int max_taps = 64;
+
+	struct Channel {
+		/** the last max_taps input samples consumed, followed by space for
+		 *  the first max_taps of the next block
+		 */
+		Sample edge[max_taps * 2];
+		bool   primed;
+		/** how far the session has moved beyond this channel */
+		double owed;
+	};
+
+	VarispeedQuality     _quality;
+	int                  _taps;
+	float const *        _kernel;
+	std::vector<Channel> _channels;
+
+	double catch_up_speed (Channel const &, framecnt_t nframes) const;
+
+	static float const * sinc_kernel (int taps);
+};
+
 class BufferSet;
 
 class LIBARDOUR_API CubicMidiInterpolation : public Interpolation {
@@ -50,6 +50,7 @@ namespace ARDOUR  {
 class Session;
 class Playlist;
 class Crossfade;
+class RegionIndex;
 
 namespace Properties {
 	/* fake the type, since regions are handled by SequenceProperty which doesn't
@@ -206,6 +207,21 @@ public:
 	void freeze ();
 	void thaw (bool from_undo = false);
 
+	/** Begin a batch of edits.  Until the matching commit_batch() the
+	 *  playlist is frozen, and it also stops keeping its region list in
+	 *  position order as regions are added or moved; the list is sorted
+	 *  once, and the playlist relayered and its signals emitted once, on
+	 *  commit.  The change records of the playlist and its regions are
+	 *  cleared so that commit_batch() can report what the batch did.
+	 *  Batches may be nested.
+	 */
+	void begin_batch ();
+	/** Finish a batch of edits started by begin_batch().  If this ends the
+	 *  outermost batch and @param cmds is non-0, undo commands for the
+	 *  regions and the playlist which the batch changed are appended to it.
+	 */
+	void commit_batch (std::vector<Command*>* cmds = 0);
+
 	void raise_region (boost::shared_ptr<Region>);
 	void lower_region (boost::shared_ptr<Region>);
 	void raise_region_to_top (boost::shared_ptr<Region>);
@@ -236,6 +252,12 @@ public:
 	void set_layer (boost::shared_ptr<Region>, double);
 
 	void set_capture_insertion_in_progress (bool yn);
+
+	/** Called when the region list or anything about a region in it
+	 *  changes, so that the caches derived from them (the region index,
+	 *  and an AudioPlaylist's read plan) are rebuilt before their next use.
+	 */
+	void invalidate_region_caches () { g_atomic_int_inc (&_region_generation); }
 	
   protected:
 	friend class Session;
@@ -259,6 +281,7 @@ public:
             }
 
         ~RegionWriteLock() {
+                playlist->invalidate_region_caches ();
                 Glib::Threads::RWLock::WriterLock::release ();
                 if (block_notify) {
                         playlist->release_notifications ();
@@ -302,9 +325,17 @@ public:
 	bool             in_partition;
 	bool            _frozen;
 	bool            _capture_insertion_underway;
+	uint32_t        _batch_depth;
+	bool            _batch_needs_sort;
+	/** regions to be put on top when the current batch is committed */
+	RegionList      _batch_top_regions;
 	uint32_t         subcnt;
 	PBD::ID         _orig_track_id;
 	uint32_t        _combine_ops;
+	/** incremented by invalidate_region_caches(), so that caches built
+	 *  from the region list can tell when they are out of date.
+	 */
+	mutable gint    _region_generation;
 
 	void init (bool hide);
 
@@ -395,8 +426,32 @@ public:
 
   private:
 	void setup_layering_indices (RegionList const &);
-	void coalesce_and_check_crossfades (std::list<Evoral::Range<framepos_t> >);
+	void apply_batch_layering ();
+	void note_relayer_range (framepos_t, framepos_t);
+	void note_relayer_region (boost::shared_ptr<Region>);
 	boost::shared_ptr<RegionList> find_regions_at (framepos_t);
+	boost::shared_ptr<RegionIndex> region_index () const;
+
+	/* an interval tree over `regions', rebuilt on demand by region_index()
+	   when _region_generation has moved on from _region_index_generation.
+	*/
+	mutable Glib::Threads::Mutex _region_index_lock;
+	mutable boost::shared_ptr<RegionIndex> _region_index;
+	mutable gint _region_index_generation;
+
+	/* the span of time in which layers may need recomputing at the
+	   next relayer(); empty if _relayer_start > _relayer_end.
+	*/
+	framepos_t _relayer_start;
+	framepos_t _relayer_end;
+	/** true if the next relayer() must recompute every region's layer */
+	bool       _relayer_all;
+	/** true if the next relayer() must renumber the layering indices */
+	bool       _relayer_renumber;
+	/** the layer model used by the last relayer() */
+	LayerModel _relayer_model;
+	/** the first and last frames of each region when its layer was last computed */
+	std::map<Region const *, std::pair<framepos_t, framepos_t> > _layered_extents;
 
 	framepos_t _end_space;  //this is used when we are pasting a range with extra space at the end
 };
@@ -39,6 +39,7 @@ namespace ARDOUR {
 class Session;
 class Route;
 class Plugin;
+class GraphSubTask;
 
 /** Plugin inserts: send data through a plugin
  */
@@ -172,6 +173,17 @@ class LIBARDOUR_API PluginInsert : public Processor
 	typedef std::vector<boost::shared_ptr<Plugin> > Plugins;
 	Plugins _plugins;
 
+	/** One per plugin instance, used to run replicated instances in
+	 *  parallel on the process graph's threads.
+	 */
+	class ReplicaTask;
+	std::vector<ReplicaTask*>  _replica_tasks;
+	std::vector<GraphSubTask*> _replica_subtasks;
+
+	void setup_replica_tasks ();
+	void drop_replica_tasks ();
+	bool run_replicas_in_parallel () const;
+
 	boost::weak_ptr<Plugin> _impulseAnalysisPlugin;
 
 	framecnt_t _signal_analysis_collected_nframes;
@@ -23,6 +23,7 @@
 #include <glibmm/threads.h>
 
 #include "ardour/chan_count.h"
+#include "ardour/dsp_profiler.h"
 #include "ardour/libardour_visibility.h"
 #include "ardour/types.h"
 
@@ -53,6 +54,7 @@ public:
 	static gain_t* trim_automation_buffer ();
 	static gain_t* send_gain_automation_buffer ();
 	static pan_t** pan_automation_buffer ();
+	static DSPProfiler::Timings* dsp_timings ();
 
 protected:
 	void session_going_away ();
@@ -25,6 +25,7 @@ namespace ARDOUR {
 class Playlist;
 class Source;
 class Location;
+class DiskReadAhead;
 
 /** Public interface to a Diskstream */
 class LIBARDOUR_API PublicDiskstream
@@ -43,6 +44,7 @@ public:
 	virtual float playback_buffer_load () const = 0;
 	virtual float capture_buffer_load () const = 0;
 	virtual int do_refill () = 0;
+	virtual void prefetch (DiskReadAhead&) = 0;
 	virtual int do_flush (RunContext, bool force = false) = 0;
 	virtual void set_pending_overwrite (bool) = 0;
 	virtual int seek (framepos_t, bool complete_refill = false) = 0;
@@ -217,6 +217,11 @@ CONFIG_VARIABLE_SPECIAL (std::string, default_session_parent_dir, "default-sessi
 #endif
 CONFIG_VARIABLE (bool, allow_special_bus_removal, "allow-special-bus-removal", false)
 CONFIG_VARIABLE (int32_t, processor_usage, "processor-usage", -1)
+CONFIG_VARIABLE (bool, work_stealing_graph, "work-stealing-graph", false)
+CONFIG_VARIABLE (bool, parallel_plugin_replicas, "parallel-plugin-replicas", false)
+CONFIG_VARIABLE (bool, dsp_profiling, "dsp-profiling", false)
+CONFIG_VARIABLE (uint32_t, butler_threads, "butler-threads", 1)
+CONFIG_VARIABLE (uint32_t, disk_read_ahead_threads, "disk-read-ahead-threads", 0)
 CONFIG_VARIABLE (gain_t, max_gain, "max-gain", 2.0) /* +6.0dB */
 CONFIG_VARIABLE (uint32_t, max_recent_sessions, "max-recent-sessions", 10)
 CONFIG_VARIABLE (uint32_t, max_recent_templates, "max-recent-templates", 10)
@@ -245,6 +250,10 @@ CONFIG_VARIABLE (std::string, plugin_path_lxvst, "plugin-path-lxvst", "@default@
 CONFIG_VARIABLE (bool, denormal_protection, "denormal-protection", false)
 CONFIG_VARIABLE (DenormalModel, denormal_model, "denormal-model", DenormalFTZDAZ)
 
+/* resampling of disk playback at speeds other than 1 */
+
+CONFIG_VARIABLE (VarispeedQuality, varispeed_quality, "varispeed-quality", VarispeedCubic)
+
 /* visibility of various things */
 
 
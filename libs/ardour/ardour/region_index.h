@@ -0,0 +1,117 @@
+/*
+    Copyright (C) 2015 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __ardour_region_index_h__
+#define __ardour_region_index_h__
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "ardour/libardour_visibility.h"
+#include "ardour/types.h"
+
+namespace ARDOUR {
+
+class Region;
+
+/** An immutable interval tree over the extents of a playlist's regions.
+ *
+ *  The regions are held in a vector sorted by first frame, and the vector
+ *  is itself laid out as an implicit balanced binary tree in which each
+ *  node also records the greatest last frame found beneath it.  Point and
+ *  range queries then cost O(log n + k) rather than a walk of the whole
+ *  list.
+ *
+ *  An index is built from a snapshot of the region list and never
+ *  changes; the playlist throws it away and builds another when the list
+ *  or any region's extent changes.  Every query returns its regions in the
+ *  order in which they appeared in the list it was built from, so that
+ *  callers see exactly what a walk of the list would have given them.
+ *
+ *  The index does not keep its regions alive, so it must only be queried
+ *  while that list is unchanged and the caller holds a lock on it.
+ */
+class LIBARDOUR_API RegionIndex
+{
+  public:
+	RegionIndex (RegionList::const_iterator begin, RegionList::const_iterator end);
+
+	size_t size () const { return _entries.size (); }
+
+	/** Append the regions which cover @param frame to @param result */
+	void at (framepos_t frame, RegionList& result) const;
+	uint32_t count_at (framepos_t frame) const;
+
+	/** Append the regions which have some part within the range
+	 *  @param start to @param end (inclusive) to @param result.
+	 */
+	void touched (framepos_t start, framepos_t end, RegionList& result) const;
+
+	/** Append the regions whose first frame is within @param start to
+	 *  @param end (inclusive) to @param result.
+	 */
+	void with_start_within (framepos_t start, framepos_t end, RegionList& result) const;
+	/** Append the regions whose last frame is within @param start to
+	 *  @param end (inclusive) to @param result.
+	 */
+	void with_end_within (framepos_t start, framepos_t end, RegionList& result) const;
+
+	/** @return the region with the closest first frame after @param frame
+	 *  (if @param forwards) or before it (if not), taking the earliest in
+	 *  list order if several start at the same place.  Only valid if
+	 *  in_position_order() is true.
+	 */
+	boost::shared_ptr<Region> next_start (framepos_t frame, bool forwards) const;
+
+	/** @return true if the list this index was built from was sorted by
+	 *  position, in which case sort order and list order agree.
+	 */
+	bool in_position_order () const { return _in_position_order; }
+
+  private:
+	struct Entry {
+		framepos_t start;
+		framepos_t end;
+		framepos_t max_end; ///< greatest end of this entry and its subtree
+		uint32_t   order;   ///< position in the original list
+		Region*    region;
+	};
+
+	struct EntrySorter {
+		bool operator() (Entry const & a, Entry const & b) const {
+			if (a.start != b.start) {
+				return a.start < b.start;
+			}
+			return a.order < b.order;
+		}
+	};
+
+	std::vector<Entry> _entries;
+	int  _max_level;
+	bool _in_position_order;
+
+	void build_tree ();
+	void overlapping (framepos_t start, framepos_t end, std::vector<size_t>& hits) const;
+	void append (std::vector<size_t>& hits, RegionList& result) const;
+};
+
+} /* namespace ARDOUR */
+
+#endif /* __ardour_region_index_h__ */
@@ -218,6 +218,9 @@ class LIBARDOUR_API Session : public PBD::StatefulDestructible, public PBD::Scop
 	BufferSet& get_route_buffers (ChanCount count = ChanCount::ZERO, bool silence = true);
 	BufferSet& get_mix_buffers (ChanCount count = ChanCount::ZERO);
 
+	/** @return the process graph, or 0 if routes are processed by a single thread */
+	Graph* process_graph () const { return _process_graph.get (); }
+
 	bool have_rec_enabled_track () const;
     bool have_rec_disabled_track () const;
 
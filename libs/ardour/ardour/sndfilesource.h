@@ -70,6 +70,8 @@ class LIBARDOUR_API SndFileSource : public AudioFileSource {
 
 	bool clamped_at_unity () const;
 
+	bool can_read_ahead () const;
+
 	static void setup_standard_crossfades (Session const &, framecnt_t sample_rate);
 	static const Source::Flag default_writable_flags;
 
@@ -84,12 +86,22 @@ class LIBARDOUR_API SndFileSource : public AudioFileSource {
 	framecnt_t read_unlocked (Sample *dst, framepos_t start, framecnt_t cnt) const;
 	framecnt_t write_unlocked (Sample *dst, framecnt_t cnt);
 	framecnt_t write_float (Sample* data, framepos_t pos, framecnt_t cnt);
+	void read_ahead_unlocked (framepos_t start, framecnt_t cnt) const;
 
   private:
 	SNDFILE* _sndfile;
 	SF_INFO _info;
 	BroadcastInfo *_broadcast_info;
 
+	/* for read-ahead: the descriptor that _sndfile was opened on,
+	   the number of bytes per (interleaved) frame, or 0 if the file is
+	   not uncompressed PCM, and the number of non-sample-data bytes in
+	   the file.
+	*/
+	int           _fd;
+	size_t        _frame_bytes;
+	off_t         _header_bytes;
+
 	void init_sndfile ();
 	int open();
 	int setup_broadcast_info (framepos_t when, struct tm&, time_t);
@@ -42,6 +42,12 @@ class LIBARDOUR_API SourceFactory {
 
 	static PBD::Signal1<void,boost::shared_ptr<Source> > SourceCreated;
 
+	/** Emitted by a peak building thread each time it has dealt with a
+	 *  source queued by setup_peakfile(), with the number dealt with and
+	 *  the number queued since the queue was last empty.
+	 */
+	static PBD::Signal2<void,uint32_t,uint32_t> PeakBuildProgress;
+
 	static boost::shared_ptr<Source> create (Session&, const XMLNode& node, bool async = false);
 	static boost::shared_ptr<Source> createSilent (Session&, const XMLNode& node,
 	                                               framecnt_t nframes, float sample_rate);
@@ -220,14 +220,18 @@ class LIBARDOUR_API TempoMap : public PBD::StatefulDestructible
 
 	struct BBTPoint {
 		framepos_t          frame;
+		/** unrounded position, from which the map can be carried on
+		 *  without accumulating rounding errors
+		 */
+		double              exact_frame;
 		const MeterSection* meter;
 		const TempoSection* tempo;
 		uint32_t            bar;
 		uint32_t            beat;
             
-		BBTPoint (const MeterSection& m, const TempoSection& t, framepos_t f,
+		BBTPoint (const MeterSection& m, const TempoSection& t, double f,
 		          uint32_t b, uint32_t e)
-			: frame (f), meter (&m), tempo (&t), bar (b), beat (e) {}
+			: frame (llrint (f)), exact_frame (f), meter (&m), tempo (&t), bar (b), beat (e) {}
 		
 		Timecode::BBT_Time bbt() const { return Timecode::BBT_Time (bar, beat, 0); }
 		operator Timecode::BBT_Time() const { return bbt(); }
@@ -344,13 +348,49 @@ class LIBARDOUR_API TempoMap : public PBD::StatefulDestructible
 	mutable Glib::Threads::RWLock lock;
 	BBTPointList                  _map;
 
+	/** An entry in one of the indices over `metrics', which let us find
+	 *  the sections in effect at a given time with a binary search
+	 *  rather than a walk of the list.  An index may cover only the
+	 *  start of the list while the map is being changed, but is always
+	 *  complete by the time the lock is released.
+	 */
+	struct MetricIndexEntry {
+		Metrics::iterator   section;
+		const TempoSection* tempo; ///< tempo in effect from section on, or 0 if none yet
+		const MeterSection* meter; ///< meter in effect from section on, or 0 if none yet
+		/* the latest frame and BBT time (bars and beats only) of this
+		   section and any before it in the index; since these never
+		   decrease, the first entry whose reach is beyond some time is
+		   where a walk of the list would stop, even if sections beyond
+		   the end of the map have stale positions.
+		*/
+		framepos_t          reach;
+		Timecode::BBT_Time  bbt_reach;
+	};
+
+	typedef std::vector<MetricIndexEntry> MetricIndex;
+
+	MetricIndex                   _metric_index; ///< all sections
+	MetricIndex                   _tempo_index;  ///< tempo sections only
+	MetricIndex                   _meter_index;  ///< meter sections only
+
+	void truncate_metric_index (uint32_t bar);
+	void extend_metric_index ();
+	Metrics::iterator first_section_in_or_after (uint32_t bar);
+	Metrics::iterator first_section_after (const Timecode::BBT_Time&);
+	static MetricIndex::const_iterator first_beyond (const MetricIndex&, framepos_t);
+	static MetricIndex::const_iterator first_beyond (const MetricIndex&, const Timecode::BBT_Time&);
+	static MetricIndex::iterator first_in_or_after_bar (MetricIndex&, uint32_t bar);
+
 	void recompute_map (bool reassign_tempo_bbt, framepos_t end = -1);
+	void recompute_map_from (bool reassign_tempo_bbt, const Timecode::BBT_Time& where);
+	void update_tempo_bbt_from_bar_offsets (Metrics::iterator from, const MeterSection* meter);
 	void extend_map (framepos_t end);
 	void require_map_to (framepos_t pos);
 	void require_map_to (const Timecode::BBT_Time&);
 	void _extend_map (TempoSection* tempo, MeterSection* meter, 
 	                  Metrics::iterator next_metric,
-	                  Timecode::BBT_Time current, framepos_t current_frame, framepos_t end);
+	                  Timecode::BBT_Time current, double current_frame_exact, framepos_t end);
 
 	BBTPointList::const_iterator bbt_before_or_at (framepos_t);
 	BBTPointList::const_iterator bbt_before_or_at (const Timecode::BBT_Time&);
@@ -23,6 +23,7 @@
 #include <glibmm/threads.h>
 
 #include "ardour/chan_count.h"
+#include "ardour/dsp_profiler.h"
 #include "ardour/libardour_visibility.h"
 #include "ardour/types.h"
 
@@ -46,6 +47,7 @@ public:
 	gain_t*    send_gain_automation_buffer;
 	pan_t**    pan_automation_buffer;
 	uint32_t   npan_buffers;
+	DSPProfiler::Timings* dsp_timings;
 
 private:
 	void allocate_pan_automation_buffers (framecnt_t nframes, uint32_t howmany, bool force);
@@ -44,6 +44,7 @@
 #include "ardour/audioregion.h"
 #include "ardour/butler.h"
 #include "ardour/debug.h"
+#include "ardour/disk_read_ahead.h"
 #include "ardour/io.h"
 #include "ardour/playlist_factory.h"
 #include "ardour/profile.h"
@@ -65,6 +66,7 @@ using namespace PBD;
 
 Sample* AudioDiskstream::_mixdown_buffer       = 0;
 gain_t* AudioDiskstream::_gain_buffer          = 0;
+Glib::Threads::Private<AudioDiskstream::WorkingBuffers> AudioDiskstream::_thread_working_buffers;
 
 AudioDiskstream::AudioDiskstream (Session &sess, const string &name, Diskstream::Flag flag)
 	: Diskstream(sess, name, flag)
@@ -142,6 +144,26 @@ AudioDiskstream::allocate_working_buffers()
 	_gain_buffer          = new gain_t[2*1048576];
 }
 
+AudioDiskstream::WorkingBuffers::WorkingBuffers ()
+	: mixdown_buffer (new Sample[2*1048576])
+	, gain_buffer (new gain_t[2*1048576])
+{
+}
+
+AudioDiskstream::WorkingBuffers::~WorkingBuffers ()
+{
+	delete [] mixdown_buffer;
+	delete [] gain_buffer;
+}
+
+void
+AudioDiskstream::allocate_thread_working_buffers ()
+{
+	if (!_thread_working_buffers.get ()) {
+		_thread_working_buffers.set (new WorkingBuffers);
+	}
+}
+
 void
 AudioDiskstream::free_working_buffers()
 {
@@ -405,7 +427,7 @@ AudioDiskstream::prepare_record_status(framepos_t capture_start_frame)
 		boost::shared_ptr<ChannelList> c = channels.reader();
 		for (ChannelList::iterator chan = c->begin(); chan != c->end(); ++chan) {
 
-			RingBufferNPT<CaptureTransition>::rw_vector transitions;
+			SPSCRingBuffer<CaptureTransition>::rw_vector transitions;
 			(*chan)->capture_transition_buf->get_write_vector (&transitions);
 
 			if (transitions.len[0] > 0) {
@@ -607,7 +629,14 @@ AudioDiskstream::process (BufferSet& bufs, framepos_t transport_frame, pframes_t
 		/* no varispeed playback if we're recording, because the output .... TBD */
 
 		if (rec_nframes == 0 && _actual_speed != 1.0) {
-			necessary_samples = (framecnt_t) ceil ((nframes * fabs (_actual_speed))) + 2;
+			/* the quality decides how far beyond the samples consumed
+			   the interpolator reads, and the speed may still be gliding
+			   from where it was, so both must be set before the read is
+			   sized.
+			*/
+			interpolation.set_quality (Config->get_varispeed_quality ());
+			interpolation.set_target_speed (_target_speed);
+			necessary_samples = interpolation.input_needed (nframes);
 		} else {
 			necessary_samples = nframes;
 		}
@@ -669,7 +698,8 @@ AudioDiskstream::process (BufferSet& bufs, framepos_t transport_frame, pframes_t
 
 		if (rec_nframes == 0 && _actual_speed != 1.0f && _actual_speed != -1.0f) {
 
-			interpolation.set_speed (_target_speed);
+			/* glide from the last speed to the new one over this cycle */
+			interpolation.set_target_speed (_target_speed);
 
 			int channel = 0;
 			for (ChannelList::iterator chan = c->begin(); chan != c->end(); ++chan, ++channel) {
@@ -680,8 +710,13 @@ AudioDiskstream::process (BufferSet& bufs, framepos_t transport_frame, pframes_t
 				
 				chaninfo->current_playback_buffer = chaninfo->speed_buffer;
 			}
+
+			interpolation.set_speed (_target_speed);
 			
 		} else {
+			/* any later varispeed starts afresh, from normal speed */
+			interpolation.set_speed (1.0);
+			interpolation.reset ();
 			playback_distance = nframes;
 		}
 
@@ -739,12 +774,13 @@ AudioDiskstream::calculate_playback_distance (pframes_t nframes)
 	if (record_enabled()) {
 		playback_distance = nframes;
 	} else if (_actual_speed != 1.0f && _actual_speed != -1.0f) {
-		interpolation.set_speed (_target_speed);
+		interpolation.set_target_speed (_target_speed);
 		boost::shared_ptr<ChannelList> c = channels.reader();
 		int channel = 0;
 		for (ChannelList::iterator chan = c->begin(); chan != c->end(); ++chan, ++channel) {
 			playback_distance = interpolation.interpolate (channel, nframes, NULL, NULL);
 		}
+		interpolation.set_speed (_target_speed);
 	} else {
 		playback_distance = nframes;
 	}
@@ -1096,6 +1132,18 @@ AudioDiskstream::_do_refill_with_alloc (bool partial_fill)
 	return ret;
 }
 
+int
+AudioDiskstream::do_refill ()
+{
+	WorkingBuffers* wb = _thread_working_buffers.get ();
+
+	if (wb) {
+		return _do_refill (wb->mixdown_buffer, wb->gain_buffer, 0);
+	}
+
+	return _do_refill (_mixdown_buffer, _gain_buffer, 0);
+}
+
 /** Get some more data from disk and put it in our channels' playback_bufs,
  *  if there is suitable space in them.
  *
@@ -1105,12 +1153,82 @@ AudioDiskstream::_do_refill_with_alloc (bool partial_fill)
  *
  */
 
+/** @return the number of samples that _do_refill() should read from each
+ *  channel when there are @param total_space samples free in the playback
+ *  buffers.
+ */
+framecnt_t
+AudioDiskstream::refill_read_size (framecnt_t total_space) const
+{
+	/* total_space is in samples. We want to optimize read sizes in various sizes using bytes */
+
+	const size_t bits_per_sample = format_data_width (_session.config.get_native_file_data_format());
+	size_t total_bytes = total_space * bits_per_sample / 8;
+
+	/* chunk size range is 256kB to 4MB. Bigger is faster in terms of MB/sec, but bigger chunk size always takes longer
+	 */
+	size_t byte_size_for_read = max ((size_t) (256 * 1024), min ((size_t) (4 * 1048576), total_bytes));
+
+	/* find nearest (lower) multiple of 16384 */
+
+	byte_size_for_read = (byte_size_for_read / 16384) * 16384;
+
+	/* now back to samples */
+
+	return byte_size_for_read / (bits_per_sample / 8);
+}
+
+/** Queue read-ahead for the range of each channel's playlist that the next
+ *  call to do_refill() is likely to read, so that the butler can submit
+ *  the reads for all tracks in one go before doing any of them.
+ */
+void
+AudioDiskstream::prefetch (DiskReadAhead& ra)
+{
+	boost::shared_ptr<ChannelList> c = channels.reader();
+
+	if (c->empty() || (_session.state_of_the_state() & Session::Loading)) {
+		return;
+	}
+
+	framecnt_t const total_space = c->front()->playback_buf->write_space();
+
+	if (total_space < disk_read_chunk_frames) {
+		return;
+	}
+
+	bool const reversed = (_visible_speed * _session.transport_speed()) < 0.0f;
+	framecnt_t cnt = min (total_space, refill_read_size (total_space));
+	framepos_t start;
+
+	if (reversed) {
+		cnt = min (cnt, file_frame);
+		start = file_frame - cnt;
+	} else {
+		if (file_frame == max_framepos) {
+			return;
+		}
+		cnt = min (cnt, max_framepos - file_frame);
+		start = file_frame;
+	}
+
+	boost::shared_ptr<AudioPlaylist> pl = audio_playlist ();
+
+	if (!pl) {
+		return;
+	}
+
+	for (uint32_t chan_n = 0; chan_n < c->size(); ++chan_n) {
+		pl->prefetch (ra, start, cnt, chan_n);
+	}
+}
+
 int
 AudioDiskstream::_do_refill (Sample* mixdown_buffer, float* gain_buffer, framecnt_t fill_level)
 {
 	int32_t ret = 0;
 	framecnt_t to_read;
-	RingBufferNPT<Sample>::rw_vector vector;
+	SPSCRingBuffer<Sample>::rw_vector vector;
 	bool const reversed = (_visible_speed * _session.transport_speed()) < 0.0f;
 	framecnt_t total_space;
 	framecnt_t zero_fill;
@@ -1245,22 +1363,7 @@ AudioDiskstream::_do_refill (Sample* mixdown_buffer, float* gain_buffer, framecn
 
 	framepos_t file_frame_tmp = 0;
 
-	/* total_space is in samples. We want to optimize read sizes in various sizes using bytes */
-
-	const size_t bits_per_sample = format_data_width (_session.config.get_native_file_data_format());
-	size_t total_bytes = total_space * bits_per_sample / 8;
-
-	/* chunk size range is 256kB to 4MB. Bigger is faster in terms of MB/sec, but bigger chunk size always takes longer
-	 */
-	size_t byte_size_for_read = max ((size_t) (256 * 1024), min ((size_t) (4 * 1048576), total_bytes));
-
-	/* find nearest (lower) multiple of 16384 */
-
-	byte_size_for_read = (byte_size_for_read / 16384) * 16384;
-
-	/* now back to samples */
-
-	framecnt_t samples_to_read = byte_size_for_read / (bits_per_sample / 8);
+	framecnt_t samples_to_read = refill_read_size (total_space);
 	
 	//cerr << name() << " will read " << byte_size_for_read << " out of total bytes " << total_bytes << " in buffer of "
 	// << c->front()->playback_buf->bufsize() * bits_per_sample / 8 << " bps = " << bits_per_sample << endl;
@@ -1377,8 +1480,8 @@ AudioDiskstream::do_flush (RunContext /*context*/, bool force_flush)
 {
 	uint32_t to_write;
 	int32_t ret = 0;
-	RingBufferNPT<Sample>::rw_vector vector;
-	RingBufferNPT<CaptureTransition>::rw_vector transvec;
+	SPSCRingBuffer<Sample>::rw_vector vector;
+	SPSCRingBuffer<CaptureTransition>::rw_vector transvec;
 	framecnt_t total;
 
 	transvec.buf[0] = 0;
@@ -1718,7 +1821,7 @@ AudioDiskstream::transport_looped (framepos_t transport_frame)
 		if (recordable() && destructive()) {
 			for (ChannelList::iterator chan = c->begin(); chan != c->end(); ++chan) {
 
-				RingBufferNPT<CaptureTransition>::rw_vector transvec;
+				SPSCRingBuffer<CaptureTransition>::rw_vector transvec;
 				(*chan)->capture_transition_buf->get_write_vector(&transvec);
 
 				if (transvec.len[0] > 0) {
@@ -1751,7 +1854,7 @@ AudioDiskstream::finish_capture (boost::shared_ptr<ChannelList> c)
 	if (recordable() && destructive()) {
 		for (ChannelList::iterator chan = c->begin(); chan != c->end(); ++chan) {
 
-			RingBufferNPT<CaptureTransition>::rw_vector transvec;
+			SPSCRingBuffer<CaptureTransition>::rw_vector transvec;
 			(*chan)->capture_transition_buf->get_write_vector(&transvec);
 
 			if (transvec.len[0] > 0) {
@@ -2124,11 +2227,12 @@ AudioDiskstream::allocate_temporary_buffers ()
 {
 	/* make sure the wrap buffer is at least large enough to deal
 	   with the speeds up to 1.2, to allow for micro-variation
-	   when slaving to MTC, Timecode etc.
+	   when slaving to MTC, Timecode etc; and for varispeed to run
+	   up to half as fast again while it catches up after a glide.
 	*/
 
-	double const sp = max (fabs (_actual_speed), 1.2);
-	framecnt_t required_wrap_size = (framecnt_t) ceil (_session.get_block_size() * sp) + 2;
+	double const sp = max (fabs (_actual_speed) * 1.5, 1.2);
+	framecnt_t required_wrap_size = (framecnt_t) ceil (_session.get_block_size() * sp) + 2 + VarispeedInterpolation::max_lookahead ();
 
 	if (required_wrap_size > wrap_buffer_size) {
 
@@ -2541,9 +2645,9 @@ AudioDiskstream::ChannelInfo::ChannelInfo (framecnt_t playback_bufsize, framecnt
 	playback_wrap_buffer = new Sample[wrap_size];
 	capture_wrap_buffer = new Sample[wrap_size];
 
-	playback_buf = new RingBufferNPT<Sample> (playback_bufsize);
-	capture_buf = new RingBufferNPT<Sample> (capture_bufsize);
-	capture_transition_buf = new RingBufferNPT<CaptureTransition> (256);
+	playback_buf = new SPSCRingBuffer<Sample> (playback_bufsize);
+	capture_buf = new SPSCRingBuffer<Sample> (capture_bufsize);
+	capture_transition_buf = new SPSCRingBuffer<CaptureTransition> (256);
 
 	/* touch the ringbuffer buffers, which will cause
 	   them to be mapped into locked physical RAM if
@@ -2560,7 +2664,7 @@ void
 AudioDiskstream::ChannelInfo::resize_playback (framecnt_t playback_bufsize)
 {
 	delete playback_buf;
-	playback_buf = new RingBufferNPT<Sample> (playback_bufsize);
+	playback_buf = new SPSCRingBuffer<Sample> (playback_bufsize);
 	memset (playback_buf->buffer(), 0, sizeof (Sample) * playback_buf->bufsize());
 }
 
@@ -2569,7 +2673,7 @@ AudioDiskstream::ChannelInfo::resize_capture (framecnt_t capture_bufsize)
 {
 	delete capture_buf;
 
-	capture_buf = new RingBufferNPT<Sample> (capture_bufsize);
+	capture_buf = new SPSCRingBuffer<Sample> (capture_bufsize);
 	memset (capture_buf->buffer(), 0, sizeof (Sample) * capture_buf->bufsize());
 }
 
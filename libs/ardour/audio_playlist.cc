@@ -18,6 +18,7 @@
 */
 
 #include <algorithm>
+#include <map>
 
 #include <cstdlib>
 
@@ -25,6 +26,7 @@
 #include "ardour/debug.h"
 #include "ardour/audioplaylist.h"
 #include "ardour/audioregion.h"
+#include "ardour/disk_read_ahead.h"
 #include "ardour/region_sorters.h"
 #include "ardour/session.h"
 
@@ -36,6 +38,7 @@ using namespace PBD;
 
 AudioPlaylist::AudioPlaylist (Session& session, const XMLNode& node, bool hidden)
 	: Playlist (session, node, DataType::AUDIO, hidden)
+	, _read_plan_generation (0)
 {
 #ifndef NDEBUG
 	const XMLProperty* prop = node.property("type");
@@ -55,16 +58,19 @@ AudioPlaylist::AudioPlaylist (Session& session, const XMLNode& node, bool hidden
 
 AudioPlaylist::AudioPlaylist (Session& session, string name, bool hidden)
 	: Playlist (session, name, DataType::AUDIO, hidden)
+	, _read_plan_generation (0)
 {
 }
 
 AudioPlaylist::AudioPlaylist (boost::shared_ptr<const AudioPlaylist> other, string name, bool hidden)
 	: Playlist (other, name, hidden)
+	, _read_plan_generation (0)
 {
 }
 
 AudioPlaylist::AudioPlaylist (boost::shared_ptr<const AudioPlaylist> other, framepos_t start, framecnt_t cnt, string name, bool hidden)
 	: Playlist (other, start, cnt, name, hidden)
+	, _read_plan_generation (0)
 {
 	RegionReadLock rlock2 (const_cast<AudioPlaylist*> (other.get()));
 	in_set_state++;
@@ -149,14 +155,267 @@ struct ReadSorter {
     }
 };
 
-/** A segment of region that needs to be read */
-struct Segment {
-	Segment (boost::shared_ptr<AudioRegion> r, Evoral::Range<framepos_t> a) : region (r), range (a) {}
-	
-	boost::shared_ptr<AudioRegion> region; ///< the region
-	Evoral::Range<framepos_t> range;       ///< range of the region to read, in session frames
+/** A flattened account of which parts of which regions must be read, and
+ *  in what order, to play an audio playlist.
+ *
+ *  Working this out means sorting the regions by layer and subtracting
+ *  the bodies of opaque regions from everything beneath them.  Rather than
+ *  do that for every chunk that read() is asked for, it is done once for
+ *  the whole playlist, and the resulting segments are filed under a list
+ *  of non-overlapping time slices so that those needed for any range can
+ *  be found with a binary search.  The segment reads themselves still go
+ *  through AudioRegion::read_at(), which applies fades and envelopes.
+ *
+ *  Like a RegionIndex, a plan holds plain pointers to its regions, and
+ *  must only be used while the region lock is held and the playlist is
+ *  unchanged since it was built.
+ */
+class AudioPlaylist::ReadPlan
+{
+  public:
+	/** A segment of region that needs to be read */
+	struct Segment {
+		Segment (AudioRegion* r, Evoral::Range<framepos_t> a) : region (r), range (a) {}
+
+		AudioRegion* region;             ///< the region
+		Evoral::Range<framepos_t> range; ///< range of the region to read, in session frames
+	};
+
+	ReadPlan (RegionList::const_iterator begin, RegionList::const_iterator end);
+
+	/** Append the parts of the plan within @param start to @param end
+	 *  (inclusive) to @param result, in the order that they must be read.
+	 */
+	void segments_within (framepos_t start, framepos_t end, std::vector<Segment>& result) const;
+
+  private:
+	struct Slice {
+		framepos_t from;
+		size_t     first_ref; ///< index into _refs of this slice's first segment
+	};
+
+	/** all segments, in the order that they must be read */
+	std::vector<Segment> _segments;
+	/** slices, in time order; each runs up to the start of the next */
+	std::vector<Slice> _slices;
+	/** indices into _segments of the segments which cover each slice, in ascending order */
+	std::vector<uint32_t> _refs;
+
+	void add_slices ();
 };
 
+AudioPlaylist::ReadPlan::ReadPlan (RegionList::const_iterator begin, RegionList::const_iterator end)
+{
+	/* Sort the regions by descending layer and ascending position */
+	RegionList all (begin, end);
+	all.sort (ReadSorter ());
+
+	/* This will be a map of the parts of the playlist that we have
+	   handled completely (ie for which no more regions need to be read),
+	   from the start to the (inclusive) end of each, in session frames.
+	*/
+	typedef std::map<framepos_t, framepos_t> Done;
+	Done done;
+
+	/* This will be a list of the bits of regions that we need to read,
+	   topmost first.
+	*/
+	std::vector<Segment> to_do;
+
+	for (RegionList::const_iterator i = all.begin(); i != all.end(); ++i) {
+		AudioRegion* ar = dynamic_cast<AudioRegion*> (i->get ());
+
+		/* muted regions don't figure into it at all */
+		if (!ar || ar->muted() || ar->last_frame() < ar->first_frame()) {
+			continue;
+		}
+
+		/* Work out which bits of this region need to be read, by
+		   removing the bits that are already done.
+		*/
+
+		framepos_t const last = ar->last_frame ();
+		framepos_t from = ar->first_frame ();
+		size_t const first_piece = to_do.size ();
+
+		Done::iterator d = done.upper_bound (from);
+		if (d != done.begin()) {
+			--d;
+			if (d->second < from) {
+				++d;
+			}
+		}
+
+		for (; d != done.end() && d->first <= last && from <= last; ++d) {
+			if (d->first > from) {
+				to_do.push_back (Segment (ar, Evoral::Range<framepos_t> (from, d->first - 1)));
+			}
+			from = max (from, d->second + 1);
+		}
+
+		if (from <= last) {
+			to_do.push_back (Segment (ar, Evoral::Range<framepos_t> (from, last)));
+		}
+
+		if (!ar->opaque ()) {
+			continue;
+		}
+
+		/* Add the bodies (the parts between end-of-fade-in and
+		   start-of-fade-out) of the bits that we will read to the `done'
+		   list, merging them with what is already there.
+		*/
+
+		Evoral::Range<framepos_t> const body = ar->body_range ();
+
+		for (size_t j = first_piece; j < to_do.size(); ++j) {
+			Evoral::Range<framepos_t> r = to_do[j].range;
+
+			if (!(body.from < r.to && body.to > r.from)) {
+				continue;
+			}
+
+			r.from = max (r.from, body.from);
+			r.to = min (r.to, body.to);
+
+			if (r.from > r.to) {
+				/* fades overlap, so there is no body */
+				continue;
+			}
+
+			Done::iterator k = done.upper_bound (r.from);
+			if (k != done.begin()) {
+				--k;
+				if (k->second + 1 < r.from) {
+					++k;
+				}
+			}
+
+			while (k != done.end() && k->first <= r.to + 1) {
+				r.from = min (r.from, k->first);
+				r.to = max (r.to, k->second);
+				done.erase (k++);
+			}
+
+			done.insert (make_pair (r.from, r.to));
+		}
+	}
+
+	/* regions are read bottom-up, so that those above can be mixed (or
+	   written) over them.
+	*/
+	_segments.assign (to_do.rbegin(), to_do.rend());
+
+	add_slices ();
+}
+
+void
+AudioPlaylist::ReadPlan::add_slices ()
+{
+	/* Slice the timeline at every segment's start and just after its end */
+	std::vector<framepos_t> edges;
+	edges.reserve (_segments.size() * 2);
+
+	for (std::vector<Segment>::const_iterator i = _segments.begin(); i != _segments.end(); ++i) {
+		edges.push_back (i->range.from);
+		edges.push_back (i->range.to + 1);
+	}
+
+	sort (edges.begin(), edges.end());
+	edges.erase (unique (edges.begin(), edges.end()), edges.end());
+
+	/* Count the segments covering each slice, then file them */
+	std::vector<size_t> count (edges.size() + 1, 0);
+
+	for (std::vector<Segment>::const_iterator i = _segments.begin(); i != _segments.end(); ++i) {
+		size_t const a = lower_bound (edges.begin(), edges.end(), i->range.from) - edges.begin();
+		size_t const b = lower_bound (edges.begin(), edges.end(), i->range.to + 1) - edges.begin();
+		for (size_t j = a; j < b; ++j) {
+			++count[j + 1];
+		}
+	}
+
+	_slices.resize (edges.size());
+
+	for (size_t j = 0; j < edges.size(); ++j) {
+		count[j + 1] += count[j];
+		_slices[j].from = edges[j];
+		_slices[j].first_ref = count[j];
+	}
+
+	_refs.resize (count.back ());
+
+	for (uint32_t n = 0; n < _segments.size(); ++n) {
+		Segment const & s (_segments[n]);
+		size_t const a = lower_bound (edges.begin(), edges.end(), s.range.from) - edges.begin();
+		size_t const b = lower_bound (edges.begin(), edges.end(), s.range.to + 1) - edges.begin();
+		for (size_t j = a; j < b; ++j) {
+			_refs[count[j]++] = n;
+		}
+	}
+}
+
+void
+AudioPlaylist::ReadPlan::segments_within (framepos_t start, framepos_t end, std::vector<Segment>& result) const
+{
+	if (_slices.empty() || start > end) {
+		return;
+	}
+
+	/* find the slice containing `start' */
+	size_t lo = 0;
+	size_t hi = _slices.size ();
+
+	while (lo < hi) {
+		size_t const mid = (lo + hi) / 2;
+		if (_slices[mid].from <= start) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	if (lo > 0) {
+		--lo;
+	}
+
+	std::vector<uint32_t> hits;
+
+	for (size_t j = lo; j < _slices.size() && _slices[j].from <= end; ++j) {
+		size_t const last_ref = (j + 1 < _slices.size()) ? _slices[j + 1].first_ref : _refs.size();
+		hits.insert (hits.end(), _refs.begin() + _slices[j].first_ref, _refs.begin() + last_ref);
+	}
+
+	sort (hits.begin(), hits.end());
+	hits.erase (unique (hits.begin(), hits.end()), hits.end());
+
+	for (std::vector<uint32_t>::const_iterator h = hits.begin(); h != hits.end(); ++h) {
+		Segment s = _segments[*h];
+		s.range.from = max (s.range.from, start);
+		s.range.to = min (s.range.to, end);
+		result.push_back (s);
+	}
+}
+
+/** @return the read plan for the current state of the playlist, building
+ *  it first if anything has changed since it was last built.  Caller must
+ *  hold the region lock.
+ */
+boost::shared_ptr<AudioPlaylist::ReadPlan>
+AudioPlaylist::read_plan ()
+{
+	gint const generation = g_atomic_int_get (&_region_generation);
+
+	Glib::Threads::Mutex::Lock lm (_read_plan_lock);
+
+	if (!_read_plan || _read_plan_generation != generation) {
+		_read_plan.reset (new ReadPlan (regions.begin(), regions.end()));
+		_read_plan_generation = generation;
+	}
+
+	return _read_plan;
+}
+
 /** @param start Start position in session frames.
  *  @param cnt Number of frames to read.
  */
@@ -188,64 +447,11 @@ AudioPlaylist::read (Sample *buf, Sample *mixdown_buffer, float *gain_buffer, fr
 
 	Playlist::RegionReadLock rl (this);
 
-	/* Find all the regions that are involved in the bit we are reading,
-	   and sort them by descending layer and ascending position.
-	*/
-	boost::shared_ptr<RegionList> all = regions_touched_locked (start, start + cnt - 1);
-	all->sort (ReadSorter ());
-
-	/* This will be a list of the bits of our read range that we have
-	   handled completely (ie for which no more regions need to be read).
-	   It is a list of ranges in session frames.
-	*/
-	Evoral::RangeList<framepos_t> done;
-
-	/* This will be a list of the bits of regions that we need to read */
-	list<Segment> to_do;
-
-	/* Now go through the `all' list filling in `to_do' and `done' */
-	for (RegionList::iterator i = all->begin(); i != all->end(); ++i) {
-		boost::shared_ptr<AudioRegion> ar = boost::dynamic_pointer_cast<AudioRegion> (*i);
-
-		/* muted regions don't figure into it at all */
-		if ( ar->muted() )
-			continue;
-
-		/* Work out which bits of this region need to be read;
-		   first, trim to the range we are reading...
-		*/
-		Evoral::Range<framepos_t> region_range = ar->range ();
-		region_range.from = max (region_range.from, start);
-		region_range.to = min (region_range.to, start + cnt - 1);
-
-		/* ... and then remove the bits that are already done */
-
-		Evoral::RangeList<framepos_t> region_to_do = Evoral::subtract (region_range, done);
-
-		/* Make a note to read those bits, adding their bodies (the parts between end-of-fade-in
-		   and start-of-fade-out) to the `done' list.
-		*/
-
-		Evoral::RangeList<framepos_t>::List t = region_to_do.get ();
-
-		for (Evoral::RangeList<framepos_t>::List::iterator j = t.begin(); j != t.end(); ++j) {
-			Evoral::Range<framepos_t> d = *j;
-			to_do.push_back (Segment (ar, d));
-
-			if (ar->opaque ()) {
-				/* Cut this range down to just the body and mark it done */
-				Evoral::Range<framepos_t> body = ar->body_range ();
-				if (body.from < d.to && body.to > d.from) {
-					d.from = max (d.from, body.from);
-					d.to = min (d.to, body.to);
-					done.add (d);
-				}
-			}
-		}
-	}
+	/* Find the bits of regions that we need to read, bottom layer first */
+	std::vector<ReadPlan::Segment> to_do;
+	read_plan()->segments_within (start, start + cnt - 1, to_do);
 
-	/* Now go backwards through the to_do list doing the actual reads */
-	for (list<Segment>::reverse_iterator i = to_do.rbegin(); i != to_do.rend(); ++i) {
+	for (std::vector<ReadPlan::Segment>::const_iterator i = to_do.begin(); i != to_do.end(); ++i) {
 		DEBUG_TRACE (DEBUG::AudioPlayback, string_compose ("\tPlaylist %1 read %2 @ %3 for %4, channel %5, buf @ %6 offset %7\n",
 								   name(), i->region->name(), i->range.from,
 								   i->range.to - i->range.from + 1, (int) chan_n,
@@ -277,6 +483,23 @@ AudioPlaylist::dump () const
 	}
 }
 
+/** Queue read-ahead for everything that read() might need to read
+ *  from the range @param start to @param start + @param cnt on channel
+ *  @param chan_n.
+ */
+void
+AudioPlaylist::prefetch (DiskReadAhead& ra, framepos_t start, framecnt_t cnt, uint32_t chan_n)
+{
+	Playlist::RegionReadLock rl (this);
+
+	std::vector<ReadPlan::Segment> to_do;
+	read_plan()->segments_within (start, start + cnt - 1, to_do);
+
+	for (std::vector<ReadPlan::Segment>::const_iterator i = to_do.begin(); i != to_do.end(); ++i) {
+		i->region->prefetch (ra, i->range.from, i->range.to - i->range.from + 1, chan_n);
+	}
+}
+
 bool
 AudioPlaylist::destroy_region (boost::shared_ptr<Region> region)
 {
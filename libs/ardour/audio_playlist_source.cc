@@ -124,6 +124,8 @@ AudioPlaylistSource::set_state (const XMLNode& node, int version, bool with_desc
 	return 0;
 }
 
+Glib::Threads::RecMutex AudioPlaylistSource::_level_read_lock;
+
 framecnt_t
 AudioPlaylistSource::read_unlocked (Sample* dst, framepos_t start, framecnt_t cnt) const
 {
@@ -145,6 +147,8 @@ AudioPlaylistSource::read_unlocked (Sample* dst, framepos_t start, framecnt_t cn
 		to_zero = 0;
 	}
 
+	Glib::Threads::RecMutex::Lock rm (_level_read_lock);
+
 	{
 		/* Don't need to hold the lock for the actual read, and
 		   actually, we cannot, but we do want to interlock
@@ -41,6 +41,7 @@
 #include "ardour/session.h"
 #include "ardour/dB.h"
 #include "ardour/debug.h"
+#include "ardour/disk_read_ahead.h"
 #include "ardour/event_type_map.h"
 #include "ardour/playlist.h"
 #include "ardour/audiofilesource.h"
@@ -444,6 +445,21 @@ AudioRegion::read_peaks (PeakData *buf, framecnt_t npeaks, framecnt_t offset, fr
 	return npeaks;
 }
 
+bool
+AudioRegion::peak_view (PeakView& view, framecnt_t offset, framecnt_t cnt, uint32_t chan_n, double frames_per_pixel) const
+{
+	if (chan_n >= _sources.size()) {
+		return false;
+	}
+
+	if (!audio_source(chan_n)->peak_view (view, offset, cnt, frames_per_pixel)) {
+		return false;
+	}
+
+	view.scale = _scale_amplitude;
+	return true;
+}
+
 /** @param buf Buffer to write data to (existing data will be overwritten).
  *  @param pos Position to read from as an offset from the region position.
  *  @param cnt Number of frames to read.
@@ -469,6 +485,35 @@ AudioRegion::master_read_at (Sample *buf, Sample* /*mixdown_buffer*/, float* /*g
 		);
 }
 
+/** Queue read-ahead for the part of our source that read_at() would read.
+ *  @param position Position within the session.
+ *  @param cnt Number of frames.
+ *  @param chan_n Channel number.
+ */
+void
+AudioRegion::prefetch (DiskReadAhead& ra, framepos_t position, framecnt_t cnt, uint32_t chan_n) const
+{
+	framepos_t const start = max (position, _position);
+	framepos_t const end = min (position + cnt, _position + _length);
+
+	if (start >= end || n_channels() == 0) {
+		return;
+	}
+
+	if (chan_n >= n_channels()) {
+		if (!Config->get_replicate_missing_region_channels()) {
+			return;
+		}
+		chan_n %= n_channels();
+	}
+
+	boost::shared_ptr<AudioSource> src = audio_source (chan_n);
+
+	if (src && src->can_read_ahead ()) {
+		ra.queue (src, _start + (start - _position), end - start);
+	}
+}
+
 /** @param buf Buffer to mix data into.
  *  @param mixdown_buffer Scratch buffer for audio data.
  *  @param gain_buffer Scratch buffer for gain data.
@@ -75,6 +75,138 @@ bool AudioSource::_build_peakfiles = false;
 
 #define _FPP 256
 
+/* frames per peak of the levels of the peak pyramid above the base level */
+static const framecnt_t peak_level_fpp[] = { 4096, 65536 };
+static const uint32_t n_peak_levels = sizeof (peak_level_fpp) / sizeof (peak_level_fpp[0]);
+static const char peak_pyramid_magic[8] = { 'A', 'R', 'D', 'P', 'Y', 'R', 'M', 'D' };
+
+/** Written at the very end of a peakfile that has pyramid levels stored
+ *  after its level-0 data.  Peakfiles without one are just level-0 data.
+ */
+struct PeakPyramidTrailer {
+	uint64_t base_bytes;
+	uint64_t npeaks[n_peak_levels];
+	uint32_t fpp[n_peak_levels];
+	uint32_t version;
+	char     magic[8];
+};
+
+/** A whole peakfile, mapped read-only into memory.  Shared by its
+ *  AudioSource and any PeakViews that have been handed out, so that a
+ *  mapping stays alive for as long as anything is looking at it.
+ */
+class ARDOUR::PeakFileMap
+{
+  public:
+	PeakFileMap (string const & path);
+	~PeakFileMap ();
+
+	bool ok () const { return _ok; }
+	char const * data () const { return _addr; }
+	off_t length () const { return _length; }
+
+  private:
+	char* _addr;
+	off_t _length;
+	bool  _ok;
+#ifdef PLATFORM_WINDOWS
+	HANDLE _map_handle;
+#endif
+};
+
+PeakFileMap::PeakFileMap (string const & path)
+	: _addr (0)
+	, _length (0)
+	, _ok (false)
+#ifdef PLATFORM_WINDOWS
+	, _map_handle (NULL)
+#endif
+{
+	ScopedFileDescriptor sfd (g_open (path.c_str(), O_RDONLY, 0444));
+	struct stat statbuf;
+
+	if (sfd < 0 || fstat (sfd, &statbuf)) {
+		return;
+	}
+
+	if (statbuf.st_size == 0) {
+		/* nothing to map, but nothing wrong either */
+		_ok = true;
+		return;
+	}
+
+#ifdef PLATFORM_WINDOWS
+	HANDLE file_handle = (HANDLE) _get_osfhandle (int (sfd));
+
+	_map_handle = CreateFileMapping (file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (_map_handle == NULL) {
+		error << string_compose (_("map failed - could not create file mapping for peakfile %1."), path) << endmsg;
+		return;
+	}
+
+	_addr = (char*) MapViewOfFile (_map_handle, FILE_MAP_READ, 0, 0, 0);
+	if (_addr == NULL) {
+		error << string_compose (_("map failed - could not map peakfile %1."), path) << endmsg;
+		CloseHandle (_map_handle);
+		_map_handle = NULL;
+		return;
+	}
+#else
+	/* shared, so that peaks written after the file was mapped show up */
+	void* addr = mmap (0, statbuf.st_size, PROT_READ, MAP_SHARED, sfd, 0);
+	if (addr == MAP_FAILED) {
+		error << string_compose (_("map failed - could not mmap peakfile %1."), path) << endmsg;
+		return;
+	}
+	_addr = (char*) addr;
+#endif
+
+	_length = statbuf.st_size;
+	_ok = true;
+}
+
+PeakFileMap::~PeakFileMap ()
+{
+	if (!_addr) {
+		return;
+	}
+#ifdef PLATFORM_WINDOWS
+	UnmapViewOfFile (_addr);
+	CloseHandle (_map_handle);
+#else
+	munmap (_addr, _length);
+#endif
+}
+
+framecnt_t
+PeakView::read (PeakData* buf, framecnt_t n, framepos_t pos, double samples_per_visual_peak) const
+{
+	for (framecnt_t i = 0; i < n; ++i) {
+
+		double const frame = pos + (i * samples_per_visual_peak) - start;
+		framecnt_t p = max ((framecnt_t) 0, (framecnt_t) floor (frame / samples_per_peak));
+		framecnt_t const end = min (npeaks, (framecnt_t) ceil ((frame + samples_per_visual_peak) / samples_per_peak));
+
+		if (p >= npeaks) {
+			memset (&buf[i], 0, (n - i) * sizeof (PeakData));
+			return i;
+		}
+
+		PeakData::PeakDatum xmax = peaks[p].max;
+		PeakData::PeakDatum xmin = peaks[p].min;
+
+		for (++p; p < end; ++p) {
+			xmax = max (xmax, peaks[p].max);
+			xmin = min (xmin, peaks[p].min);
+		}
+
+		buf[i].max = xmax * scale;
+		buf[i].min = xmin * scale;
+	}
+
+	return n;
+}
+
 AudioSource::AudioSource (Session& s, string name)
 	: Source (s, DataType::AUDIO, name)
 	, _length (0)
@@ -88,6 +220,7 @@ AudioSource::AudioSource (Session& s, string name)
 	, _last_scale (0.0)
 	, _last_map_off (0)
 	, _last_raw_map_length (0)
+	, _peak_level_next_frame (-1)
 {
 }
 
@@ -104,6 +237,7 @@ AudioSource::AudioSource (Session& s, const XMLNode& node)
 	, _last_scale (0.0)
 	, _last_map_off (0)
 	, _last_raw_map_length (0)
+	, _peak_level_next_frame (-1)
 {
 	if (set_state (node, Stateful::loading_state_version)) {
 		throw failed_constructor();
@@ -230,6 +364,7 @@ AudioSource::rename_peakfile (string newpath)
 	}
 
 	peakpath = newpath;
+	drop_peak_map ();
 
 	return 0;
 }
@@ -281,7 +416,7 @@ AudioSource::initialize_peakfile (string audio_path)
 				DEBUG_TRACE(DEBUG::Peaks, string_compose("Error when calling stat on Peakfile %1\n", peakpath));
 
 				_peaks_built = true;
-				_peak_byte_max = statbuf.st_size;
+				_peak_byte_max = load_peak_levels (statbuf.st_size);
 
 			} else {
 
@@ -294,7 +429,7 @@ AudioSource::initialize_peakfile (string audio_path)
 					_peak_byte_max = 0;
 				} else {
 					_peaks_built = true;
-					_peak_byte_max = statbuf.st_size;
+					_peak_byte_max = load_peak_levels (statbuf.st_size);
 				}
 			}
 		}
@@ -316,6 +451,15 @@ AudioSource::read (Sample *dst, framepos_t start, framecnt_t cnt, int /*channel*
 	return read_unlocked (dst, start, cnt);
 }
 
+void
+AudioSource::read_ahead (framepos_t start, framecnt_t cnt) const
+{
+	/* don't hold _lock here: the OS may take a while over the request,
+	   and the butler would be left waiting to read the same source.
+	*/
+	read_ahead_unlocked (start, cnt);
+}
+
 framecnt_t
 AudioSource::write (Sample *dst, framecnt_t cnt)
 {
@@ -331,6 +475,45 @@ AudioSource::read_peaks (PeakData *peaks, framecnt_t npeaks, framepos_t start, f
 	return read_peaks_with_fpp (peaks, npeaks, start, cnt, samples_per_visual_peak, _FPP);
 }
 
+bool
+AudioSource::peak_view (PeakView& view, framepos_t start, framecnt_t cnt, double samples_per_visual_peak) const
+{
+	if (samples_per_visual_peak < _FPP || cnt <= 0 || !_peaks_built) {
+		/* the peaks would have to come from the audio data, or
+		   are not all there yet.
+		*/
+		return false;
+	}
+
+	Glib::Threads::Mutex::Lock lm (_lock);
+
+	PeakLevel level (_FPP, 0, _peak_byte_max / sizeof (PeakData));
+	peak_level_for (samples_per_visual_peak, level);
+
+	framecnt_t const first = start / level.fpp;
+	framecnt_t const last = min ((start + cnt + level.fpp - 1) / level.fpp, level.npeaks);
+
+	if (last <= first) {
+		return false;
+	}
+
+	off_t const end = level.offset + last * sizeof (PeakData);
+	boost::shared_ptr<PeakFileMap const> mapped = peak_map (end);
+
+	if (!mapped || mapped->length() < end) {
+		return false;
+	}
+
+	view._map = mapped;
+	view.peaks = (PeakData const *) (mapped->data() + level.offset) + first;
+	view.npeaks = last - first;
+	view.samples_per_peak = level.fpp;
+	view.start = first * level.fpp;
+	view.scale = 1.0;
+
+	return true;
+}
+
 /** @param peaks Buffer to write peak data.
  *  @param npeaks Number of peaks to write.
  */
@@ -345,21 +528,15 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, framecnt_t npeaks, framepos_t
 	PeakData::PeakDatum xmax;
 	PeakData::PeakDatum xmin;
 	int32_t to_read;
-#ifdef PLATFORM_WINDOWS
-	SYSTEM_INFO system_info;
-        GetSystemInfo (&system_info);
-	const int bufsize = system_info.dwAllocationGranularity;;
-#else
-	const int bufsize = sysconf(_SC_PAGESIZE);
-#endif
 	framecnt_t read_npeaks = npeaks;
 	framecnt_t zero_fill = 0;
 
-	GStatBuf statbuf;
-
 	expected_peaks = (cnt / (double) samples_per_file_peak);
-	if (g_stat (peakpath.c_str(), &statbuf) != 0) {
-		error << string_compose (_("Cannot open peakfile @ %1 for size check (%2)"), peakpath, strerror (errno)) << endmsg;
+
+	boost::shared_ptr<PeakFileMap const> mapped = peak_map (0);
+
+	if (!mapped) {
+		error << string_compose (_("Cannot open peakfile @ %1 for reading (%2)"), peakpath, strerror (errno)) << endmsg;
 		return -1;
 	}
 
@@ -379,26 +556,42 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, framecnt_t npeaks, framepos_t
 		
 		const off_t expected_file_size = (_length / (double) samples_per_file_peak) * sizeof (PeakData);
 		
-		if (statbuf.st_size < expected_file_size) {
-			warning << string_compose (_("peak file %1 is truncated from %2 to %3"), peakpath, expected_file_size, statbuf.st_size) << endmsg;
+		if (mapped->length() < expected_file_size) {
+			/* it may just have grown since we mapped it */
+			mapped = peak_map (expected_file_size);
+		}
+
+		if (!mapped || mapped->length() < expected_file_size) {
+			warning << string_compose (_("peak file %1 is truncated from %2 to %3"), peakpath, expected_file_size, mapped ? mapped->length() : 0) << endmsg;
 			const_cast<AudioSource*>(this)->build_peaks_from_scratch ();
-			if (g_stat (peakpath.c_str(), &statbuf) != 0) {
+			if (!(mapped = peak_map (expected_file_size))) {
 				error << string_compose (_("Cannot open peakfile @ %1 for size check (%2) after rebuild"), peakpath, strerror (errno)) << endmsg;
+				return -1;
 			}
-			if (statbuf.st_size < expected_file_size) {
+			if (mapped->length() < expected_file_size) {
 				fatal << "peak file is still truncated after rebuild" << endmsg;
 				/*NOTREACHED*/
 			}
 		}
 	}
 
-	ScopedFileDescriptor sfd (g_open (peakpath.c_str(), O_RDONLY, 0444));
+	/* if the caller is zoomed out far enough, read from a coarser level
+	   of the peak pyramid rather than decimating the base level.
+	*/
 
-	if (sfd < 0) {
-		error << string_compose (_("Cannot open peakfile @ %1 for reading (%2)"), peakpath, strerror (errno)) << endmsg;
-		return -1;
+	off_t level_offset = 0;
+	framecnt_t level_npeaks = 0; /* 0 means "as many as there are" */
+
+	if (samples_per_file_peak == _FPP) {
+		PeakLevel level (0, 0, 0);
+		if (peak_level_for (samples_per_visual_peak, level)) {
+			samples_per_file_peak = level.fpp;
+			level_offset = level.offset;
+			level_npeaks = level.npeaks;
+			expected_peaks = (cnt / (double) samples_per_file_peak);
+		}
 	}
-				  
+
 	scale = npeaks/expected_peaks;
 
 
@@ -442,69 +635,38 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, framecnt_t npeaks, framepos_t
 	}
 
 	if (scale == 1.0) {
-		off_t first_peak_byte = (start / samples_per_file_peak) * sizeof (PeakData);
-		size_t bytes_to_read = sizeof (PeakData) * read_npeaks;
-		/* open, read, close */
-
-		DEBUG_TRACE (DEBUG::Peaks, "DIRECT PEAKS\n");
-
-		off_t  map_off =  first_peak_byte;
-		off_t  read_map_off = map_off & ~(bufsize - 1);
-		off_t  map_delta = map_off - read_map_off;
-		size_t map_length = bytes_to_read + map_delta;
 
-		if (_first_run  || (_last_scale != samples_per_visual_peak) || (_last_map_off != map_off) || (_last_raw_map_length  < bytes_to_read)) {
-			peak_cache.reset (new PeakData[npeaks]);
-			char* addr;
-#ifdef PLATFORM_WINDOWS
-			HANDLE file_handle = (HANDLE) _get_osfhandle(int(sfd));
-			HANDLE map_handle;
-			LPVOID view_handle;
-			bool err_flag;
-
-			map_handle = CreateFileMapping(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
-			if (map_handle == NULL) {
-				error << string_compose (_("map failed - could not create file mapping for peakfile %1."), peakpath) << endmsg;
-				return -1;
+		if (level_npeaks) {
+			/* don't read past the end of this level */
+			framecnt_t const avail = max ((framecnt_t) 0, level_npeaks - (start / samples_per_file_peak));
+			if (read_npeaks > avail) {
+				zero_fill += read_npeaks - avail;
+				read_npeaks = avail;
 			}
+		}
 
-			view_handle = MapViewOfFile(map_handle, FILE_MAP_READ, 0, read_map_off, map_length);
-			if (view_handle == NULL) {
-				error << string_compose (_("map failed - could not map peakfile %1."), peakpath) << endmsg;
-				return -1;
-			}
+		off_t first_peak_byte = level_offset + (start / samples_per_file_peak) * sizeof (PeakData);
+		size_t bytes_to_read = sizeof (PeakData) * read_npeaks;
 
-			addr = (char*) view_handle;
+		DEBUG_TRACE (DEBUG::Peaks, "DIRECT PEAKS\n");
 
-			memcpy ((void*)peak_cache.get(), (void*)(addr + map_delta), bytes_to_read);
+		/* the stored peaks are exactly what was asked for, so copy them
+		   straight out of the mapped peakfile.
+		*/
 
-			err_flag = UnmapViewOfFile (view_handle);
-			err_flag = CloseHandle(map_handle);
-			if(!err_flag) {
-				error << string_compose (_("unmap failed - could not unmap peakfile %1."), peakpath) << endmsg;
-				return -1;
-			}
-#else
-			addr = (char*) mmap (0, map_length, PROT_READ, MAP_PRIVATE, sfd, read_map_off);
-			if (addr ==  MAP_FAILED) {
-				error << string_compose (_("map failed - could not mmap peakfile %1."), peakpath) << endmsg;
-				return -1;
-			}
+		if (!(mapped = peak_map (first_peak_byte + bytes_to_read))) {
+			error << string_compose (_("map failed - could not mmap peakfile %1."), peakpath) << endmsg;
+			return -1;
+		}
 
-			memcpy ((void*)peak_cache.get(), (void*)(addr + map_delta), bytes_to_read);
-			munmap (addr, map_length);
-#endif
-			if (zero_fill) {
-				memset (&peak_cache[read_npeaks], 0, sizeof (PeakData) * zero_fill);
-			}
+		size_t const avail = min ((off_t) bytes_to_read, max ((off_t) 0, mapped->length() - first_peak_byte));
 
-			_first_run = false;
-			_last_scale = samples_per_visual_peak;
-			_last_map_off = map_off;
-			_last_raw_map_length = bytes_to_read;
+		if (avail) {
+			memcpy ((void*)peaks, (void*)(mapped->data() + first_peak_byte), avail);
+		}
+		if (avail < npeaks * sizeof (PeakData)) {
+			memset ((char*) peaks + avail, 0, npeaks * sizeof (PeakData) - avail);
 		}
-
-		memcpy ((void*)peaks, (void*)peak_cache.get(), npeaks * sizeof(PeakData));
 
 		return 0;
 	}
@@ -523,7 +685,7 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, framecnt_t npeaks, framepos_t
 		    to avoid confusion, I'll refer to the requested peaks as visual_peaks and the peakfile peaks as stored_peaks
 		*/
 
-		const framecnt_t chunksize = (framecnt_t) expected_peaks; // we read all the peaks we need in one hit.
+		framecnt_t chunksize = (framecnt_t) expected_peaks; // we read all the peaks we need in one hit.
 
 		/* compute the rounded up frame position  */
 
@@ -538,57 +700,30 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, framecnt_t npeaks, framepos_t
 
 		current_stored_peak = min (current_stored_peak, stored_peak_before_next_visual_peak);
 
-		/* open ... close during out: handling */
+		if (level_npeaks) {
+			/* don't read past the end of this level */
+			chunksize = max ((framecnt_t) 0, min (chunksize, level_npeaks - (framecnt_t) ceil (start / (double) samples_per_file_peak)));
+		}
 
-		off_t  map_off =  (uint32_t) (ceil (start / (double) samples_per_file_peak)) * sizeof(PeakData);
-		off_t  read_map_off = map_off & ~(bufsize - 1);
-		off_t  map_delta = map_off - read_map_off;
+		off_t  map_off =  level_offset + (uint32_t) (ceil (start / (double) samples_per_file_peak)) * sizeof(PeakData);
 		size_t raw_map_length = chunksize * sizeof(PeakData);
-		size_t map_length = (chunksize * sizeof(PeakData)) + map_delta;
 
 		if (_first_run || (_last_scale != samples_per_visual_peak) || (_last_map_off != map_off) || (_last_raw_map_length < raw_map_length)) {
-			peak_cache.reset (new PeakData[npeaks]);
-			boost::scoped_array<PeakData> staging (new PeakData[chunksize]);
 
-			char* addr;
-#ifdef PLATFORM_WINDOWS
-			HANDLE file_handle =  (HANDLE) _get_osfhandle(int(sfd));
-			HANDLE map_handle;
-			LPVOID view_handle;
-			bool err_flag;
-
-			map_handle = CreateFileMapping(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
-			if (map_handle == NULL) {
-				error << string_compose (_("map failed - could not create file mapping for peakfile %1."), peakpath) << endmsg;
+			if (!(mapped = peak_map (map_off + raw_map_length))) {
+				error << string_compose (_("map failed - could not mmap peakfile %1."), peakpath) << endmsg;
 				return -1;
 			}
 
-			view_handle = MapViewOfFile(map_handle, FILE_MAP_READ, 0, read_map_off, map_length);
-			if (view_handle == NULL) {
-				error << string_compose (_("map failed - could not map peakfile %1."), peakpath) << endmsg;
-				return -1;
+			if (mapped->length() - map_off < (off_t) raw_map_length) {
+				chunksize = max ((off_t) 0, mapped->length() - map_off) / sizeof (PeakData);
 			}
 
-			addr = (char *) view_handle;
+			/* downsample straight from the mapped peakfile */
 
-			memcpy ((void*)staging.get(), (void*)(addr + map_delta), raw_map_length);
-
-			err_flag = UnmapViewOfFile (view_handle);
-			err_flag = CloseHandle(map_handle);
-			if(!err_flag) {
-				error << string_compose (_("unmap failed - could not unmap peakfile %1."), peakpath) << endmsg;
-				return -1;
-			}
-#else
-			addr = (char*) mmap (0, map_length, PROT_READ, MAP_PRIVATE, sfd, read_map_off);
-			if (addr ==  MAP_FAILED) {
-				error << string_compose (_("map failed - could not mmap peakfile %1."), peakpath) << endmsg;
-				return -1;
-			}
+			PeakData const * staging = (PeakData const *) (mapped->data() + map_off);
+			peak_cache.reset (new PeakData[npeaks]);
 
-			memcpy ((void*)staging.get(), (void*)(addr + map_delta), raw_map_length);
-			munmap (addr, map_length);
-#endif
 			while (nvisual_peaks < read_npeaks) {
 
 				xmax = -1.0;
@@ -712,7 +847,12 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, framecnt_t npeaks, framepos_t
 int
 AudioSource::build_peaks_from_scratch ()
 {
-	const framecnt_t bufsize = 65536; // 256kB per disk read for mono data is about ideal
+	/* 4MB per disk read for mono data: large enough that the per-block cost
+	   of writing the peaks (seek, write, PeakRangeReady) is lost in the
+	   noise, small enough to stay friendly when several sources are being
+	   built at once.
+	*/
+	const framecnt_t bufsize = 1048576;
 
 	DEBUG_TRACE (DEBUG::Peaks, "Building peaks from scratch\n");
 
@@ -789,6 +929,13 @@ AudioSource::done_with_peakfile_writes (bool done)
 		compute_and_write_peaks (0, 0, 0, true, false, _FPP);
 	}
 
+	if (done && _peak_level_next_frame > 0 && _peakfile_fd >= 0) {
+		write_peak_levels ();
+	}
+
+	_peak_level_builders.clear ();
+	_peak_level_next_frame = -1;
+
 	if (done) {
 		Glib::Threads::Mutex::Lock lm (_peaks_ready_lock);
 		_peaks_built = true;
@@ -827,6 +974,23 @@ AudioSource::compute_and_write_peaks (Sample* buf, framecnt_t first_frame, frame
 		}
 	}
 
+	{
+		/* whatever is stored after the base level is about to be
+		   overwritten or made stale.
+		*/
+		Glib::Threads::Mutex::Lock lm (_peak_levels_lock);
+		_peak_levels.clear ();
+	}
+
+	if (cnt && first_frame == 0 && peak_leftover_cnt == 0 && fpp == _FPP && can_truncate_peaks()) {
+		/* a new pass over the whole source: start building the pyramid */
+		_peak_level_builders.clear ();
+		for (uint32_t n = 0; n < n_peak_levels; ++n) {
+			_peak_level_builders.push_back (PeakLevelBuilder (peak_level_fpp[n]));
+		}
+		_peak_level_next_frame = 0;
+	}
+
   restart:
 	if (peak_leftover_cnt) {
 
@@ -858,6 +1022,8 @@ AudioSource::compute_and_write_peaks (Sample* buf, framecnt_t first_frame, frame
 
 			_peak_byte_max = max (_peak_byte_max, (off_t) (byte + sizeof(PeakData)));
 
+			add_to_peak_levels (&x, 1, peak_leftover_frame, peak_leftover_frame + peak_leftover_cnt);
+
 			{
 				Glib::Threads::Mutex::Lock lm (_peaks_ready_lock);
 				PeakRangeReady (peak_leftover_frame, peak_leftover_cnt); /* EMIT SIGNAL */
@@ -906,14 +1072,31 @@ AudioSource::compute_and_write_peaks (Sample* buf, framecnt_t first_frame, frame
 	current_frame = first_frame;
 	frames_done = 0;
 
-	while (to_do) {
+	/* compute all the whole peaks in one pass over the block, with
+	   nothing but find_peaks() in the loop.
+	*/
+
+	for (uint32_t const whole = to_do / fpp; peaks_computed < whole; ++peaks_computed) {
+		peakbuf[peaks_computed].max = buf[0];
+		peakbuf[peaks_computed].min = buf[0];
+
+		ARDOUR::find_peaks (buf+1, fpp-1, &peakbuf[peaks_computed].min, &peakbuf[peaks_computed].max);
+
+		buf += fpp;
+	}
+
+	frames_done = peaks_computed * fpp;
+	current_frame += frames_done;
+	to_do -= frames_done;
+
+	if (to_do) {
 
 		/* if some frames were passed in (i.e. we're not flushing leftovers)
 		   and there are less than fpp to do, save them till
 		   next time
 		*/
 
-		if (force && (to_do < fpp)) {
+		if (force) {
 			/* keep the left overs around for next time */
 
 			if (peak_leftover_size < to_do) {
@@ -925,23 +1108,17 @@ AudioSource::compute_and_write_peaks (Sample* buf, framecnt_t first_frame, frame
 			peak_leftover_cnt = to_do;
 			peak_leftover_frame = current_frame;
 
-			/* done for now */
-
-			break;
-		}
-
-		framecnt_t this_time = min (fpp, to_do);
+		} else {
 
-		peakbuf[peaks_computed].max = buf[0];
-		peakbuf[peaks_computed].min = buf[0];
+			peakbuf[peaks_computed].max = buf[0];
+			peakbuf[peaks_computed].min = buf[0];
 
-		ARDOUR::find_peaks (buf+1, this_time-1, &peakbuf[peaks_computed].min, &peakbuf[peaks_computed].max);
+			ARDOUR::find_peaks (buf+1, to_do-1, &peakbuf[peaks_computed].min, &peakbuf[peaks_computed].max);
 
-		peaks_computed++;
-		buf += this_time;
-		to_do -= this_time;
-		frames_done += this_time;
-		current_frame += this_time;
+			peaks_computed++;
+			frames_done += to_do;
+			current_frame += to_do;
+		}
 	}
 
 	first_peak_byte = (first_frame / fpp) * sizeof (PeakData);
@@ -984,6 +1161,10 @@ AudioSource::compute_and_write_peaks (Sample* buf, framecnt_t first_frame, frame
 
 	_peak_byte_max = max (_peak_byte_max, (off_t) (first_peak_byte + bytes_to_write));
 
+	if (peaks_computed) {
+		add_to_peak_levels (peakbuf.get(), peaks_computed, first_frame, current_frame);
+	}
+
 	if (frames_done) {
 		Glib::Threads::Mutex::Lock lm (_peaks_ready_lock);
 		PeakRangeReady (first_frame, frames_done); /* EMIT SIGNAL */
@@ -1010,13 +1191,307 @@ AudioSource::truncate_peakfile ()
 
 	if (end > _peak_byte_max) {
 		DEBUG_TRACE(DEBUG::Peaks, string_compose ("Truncating Peakfile  %1\n", peakpath));
-		if (ftruncate (_peakfile_fd, _peak_byte_max)) {
+		if (shrink_peakfile (_peak_byte_max)) {
 			error << string_compose (_("could not truncate peakfile %1 to %2 (error: %3)"),
 						 peakpath, _peak_byte_max, errno) << endmsg;
 		}
 	}
 }
 
+/** Cut the open peakfile down to @param length bytes.  If any of its
+ *  mappings are still in use, truncating it would leave them pointing past
+ *  the end of the file, so instead the part to keep is copied to a new
+ *  file which replaces the old one; the mappings keep the old one.
+ *  @return 0 on success.
+ */
+int
+AudioSource::shrink_peakfile (off_t length)
+{
+	Glib::Threads::Mutex::Lock lm (_peak_levels_lock);
+
+	bool const in_use = peak_map_in_use ();
+
+	if (_peak_map) {
+		_retired_peak_maps.push_back (_peak_map);
+		_peak_map.reset ();
+	}
+
+	if (!in_use) {
+		return ftruncate (_peakfile_fd, length);
+	}
+
+#ifdef PLATFORM_WINDOWS
+	/* a mapped file cannot be replaced here; leave it as it is */
+	DEBUG_TRACE (DEBUG::Peaks, string_compose ("Peakfile %1 is in use, not shrinking it\n", peakpath));
+	return -1;
+#else
+	DEBUG_TRACE (DEBUG::Peaks, string_compose ("Peakfile %1 is in use, replacing it\n", peakpath));
+
+	string const tmppath = peakpath + X_(".tmp");
+	int const fd = g_open (tmppath.c_str(), O_CREAT|O_RDWR|O_TRUNC, 0664);
+
+	if (fd < 0) {
+		return -1;
+	}
+
+	char buf[65536];
+	off_t done = 0;
+
+	while (done < length) {
+		size_t const n = min ((off_t) sizeof (buf), length - done);
+		if (::pread (_peakfile_fd, buf, n, done) != (ssize_t) n || ::write (fd, buf, n) != (ssize_t) n) {
+			::close (fd);
+			::g_unlink (tmppath.c_str());
+			return -1;
+		}
+		done += n;
+	}
+
+	if (g_rename (tmppath.c_str(), peakpath.c_str()) != 0) {
+		::close (fd);
+		::g_unlink (tmppath.c_str());
+		return -1;
+	}
+
+	/* carry on writing to the new file */
+	dup2 (fd, _peakfile_fd);
+	::close (fd);
+
+	return 0;
+#endif
+}
+
+/** Merge @param npeaks level-0 peaks, covering the frames from
+ *  @param first_frame up to (but not including) @param end_frame, into
+ *  the coarser levels being built.  If they do not follow on from the
+ *  previous ones, give up building the levels for this pass.
+ */
+void
+AudioSource::add_to_peak_levels (PeakData const * peaks, uint32_t npeaks, framepos_t first_frame, framepos_t end_frame)
+{
+	if (_peak_level_next_frame < 0) {
+		return;
+	}
+
+	if (first_frame != _peak_level_next_frame) {
+		DEBUG_TRACE (DEBUG::Peaks, string_compose ("%1: non-sequential peak write, not building peak levels\n", _name));
+		_peak_level_builders.clear ();
+		_peak_level_next_frame = -1;
+		return;
+	}
+
+	for (vector<PeakLevelBuilder>::iterator l = _peak_level_builders.begin(); l != _peak_level_builders.end(); ++l) {
+
+		framecnt_t const ratio = l->fpp / _FPP;
+
+		for (uint32_t n = 0; n < npeaks; ++n) {
+
+			if (l->count == 0) {
+				l->current = peaks[n];
+			} else {
+				l->current.min = min (l->current.min, peaks[n].min);
+				l->current.max = max (l->current.max, peaks[n].max);
+			}
+
+			if (++l->count == ratio) {
+				l->peaks.push_back (l->current);
+				l->count = 0;
+			}
+		}
+	}
+
+	_peak_level_next_frame = end_frame;
+}
+
+/** Write the levels built during this pass of peak writes, and a trailer
+ *  describing them, after the level-0 data in the peakfile.
+ */
+int
+AudioSource::write_peak_levels ()
+{
+	PeakPyramidTrailer trailer;
+	memset (&trailer, 0, sizeof (trailer));
+
+	off_t const base_bytes = ((_peak_level_next_frame + _FPP - 1) / _FPP) * sizeof (PeakData);
+	off_t offset = base_bytes;
+	vector<PeakLevel> levels;
+
+	/* get rid of any space reserved beyond the level-0 data */
+
+	if (shrink_peakfile (base_bytes) || lseek (_peakfile_fd, base_bytes, SEEK_SET) != base_bytes) {
+		return -1;
+	}
+
+	for (uint32_t n = 0; n < _peak_level_builders.size(); ++n) {
+
+		PeakLevelBuilder& l (_peak_level_builders[n]);
+
+		if (l.count) {
+			l.peaks.push_back (l.current);
+			l.count = 0;
+		}
+
+		ssize_t const bytes = l.peaks.size() * sizeof (PeakData);
+
+		if (bytes && ::write (_peakfile_fd, &l.peaks[0], bytes) != bytes) {
+			error << string_compose(_("%1: could not write peak file data (%2)"), _name, strerror (errno)) << endmsg;
+			return -1;
+		}
+
+		levels.push_back (PeakLevel (l.fpp, offset, l.peaks.size()));
+		trailer.npeaks[n] = l.peaks.size();
+		trailer.fpp[n] = l.fpp;
+		offset += bytes;
+	}
+
+	trailer.base_bytes = base_bytes;
+	trailer.version = 1;
+	memcpy (trailer.magic, peak_pyramid_magic, sizeof (trailer.magic));
+
+	if (::write (_peakfile_fd, &trailer, sizeof (trailer)) != sizeof (trailer)) {
+		error << string_compose(_("%1: could not write peak file data (%2)"), _name, strerror (errno)) << endmsg;
+		return -1;
+	}
+
+	_peak_byte_max = base_bytes;
+
+	Glib::Threads::Mutex::Lock lm (_peak_levels_lock);
+	_peak_levels = levels;
+
+	return 0;
+}
+
+/** Look for pyramid levels at the end of our peakfile, which is
+ *  @param file_size bytes long.
+ *  @return the size of the level-0 data in the peakfile.
+ */
+off_t
+AudioSource::load_peak_levels (off_t file_size)
+{
+	Glib::Threads::Mutex::Lock lm (_peak_levels_lock);
+
+	_peak_levels.clear ();
+
+	if (file_size < (off_t) sizeof (PeakPyramidTrailer)) {
+		return file_size;
+	}
+
+	ScopedFileDescriptor sfd (g_open (peakpath.c_str(), O_RDONLY, 0444));
+
+	if (sfd < 0) {
+		return file_size;
+	}
+
+	PeakPyramidTrailer trailer;
+
+	if (lseek (sfd, file_size - sizeof (trailer), SEEK_SET) < 0 ||
+	    ::read (sfd, &trailer, sizeof (trailer)) != sizeof (trailer) ||
+	    memcmp (trailer.magic, peak_pyramid_magic, sizeof (trailer.magic)) ||
+	    trailer.version != 1) {
+		/* just level-0 data */
+		return file_size;
+	}
+
+	off_t offset = trailer.base_bytes;
+	vector<PeakLevel> levels;
+
+	for (uint32_t n = 0; n < n_peak_levels; ++n) {
+		if (trailer.fpp[n] <= _FPP || trailer.fpp[n] % _FPP) {
+			return file_size;
+		}
+		levels.push_back (PeakLevel (trailer.fpp[n], offset, trailer.npeaks[n]));
+		offset += trailer.npeaks[n] * sizeof (PeakData);
+	}
+
+	if (offset + (off_t) sizeof (trailer) != file_size) {
+		/* the level-0 data has been extended over the top of the levels */
+		return file_size;
+	}
+
+	DEBUG_TRACE (DEBUG::Peaks, string_compose ("Peakfile %1 has %2 pyramid levels\n", peakpath, levels.size()));
+
+	_peak_levels = levels;
+	return trailer.base_bytes;
+}
+
+/** @return true if there is a stored peak level coarser than the base level
+ *  but with no more than @param samples_per_visual_peak frames per peak,
+ *  in which case the coarsest such level is returned in @param level.
+ */
+bool
+AudioSource::peak_level_for (double samples_per_visual_peak, PeakLevel& level) const
+{
+	Glib::Threads::Mutex::Lock lm (_peak_levels_lock);
+	bool found = false;
+
+	for (vector<PeakLevel>::const_iterator l = _peak_levels.begin(); l != _peak_levels.end(); ++l) {
+		if (l->fpp <= samples_per_visual_peak && (!found || l->fpp > level.fpp)) {
+			level = *l;
+			found = true;
+		}
+	}
+
+	return found;
+}
+
+/** @return a mapping of our peakfile that is at least @param length_needed
+ *  bytes long if the file is, remapping the file if the current mapping
+ *  is too short; or 0 if the file cannot be mapped.
+ */
+boost::shared_ptr<PeakFileMap const>
+AudioSource::peak_map (off_t length_needed) const
+{
+	Glib::Threads::Mutex::Lock lm (_peak_levels_lock);
+
+	if (_peak_map && _peak_map->length() >= length_needed) {
+		return _peak_map;
+	}
+
+	boost::shared_ptr<PeakFileMap const> m (new PeakFileMap (peakpath));
+
+	if (!m->ok()) {
+		return boost::shared_ptr<PeakFileMap const> ();
+	}
+
+	if (_peak_map) {
+		_retired_peak_maps.push_back (_peak_map);
+	}
+
+	_peak_map = m;
+	return _peak_map;
+}
+
+/** Forget our mapping of the peakfile, which must be done before it is
+ *  renamed.  PeakViews still using it keep it alive.
+ */
+void
+AudioSource::drop_peak_map ()
+{
+	Glib::Threads::Mutex::Lock lm (_peak_levels_lock);
+
+	if (_peak_map) {
+		_retired_peak_maps.push_back (_peak_map);
+		_peak_map.reset ();
+	}
+}
+
+/** @return true if anything other than this source holds a mapping of
+ *  the peakfile.  Caller must hold _peak_levels_lock.
+ */
+bool
+AudioSource::peak_map_in_use () const
+{
+	for (list<boost::weak_ptr<PeakFileMap const> >::iterator i = _retired_peak_maps.begin(); i != _retired_peak_maps.end(); ) {
+		if (i->expired ()) {
+			i = _retired_peak_maps.erase (i);
+		} else {
+			++i;
+		}
+	}
+
+	return !_retired_peak_maps.empty() || (_peak_map && _peak_map.use_count() > 1);
+}
+
 framecnt_t
 AudioSource::available_peaks (double zoom_factor) const
 {
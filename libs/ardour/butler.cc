@@ -17,6 +17,7 @@
 
 */
 
+#include <algorithm>
 #include <errno.h>
 #include <fcntl.h>
 #include <unistd.h>
@@ -27,6 +28,7 @@
 
 #include "pbd/error.h"
 #include "pbd/pthread_utils.h"
+#include "ardour/audio_diskstream.h"
 #include "ardour/debug.h"
 #include "ardour/butler.h"
 #include "ardour/io.h"
@@ -50,6 +52,15 @@ Butler::Butler(Session& s)
 	, midi_dstream_buffer_size(0)
 	, pool_trash(16)
 	, _xthread (true)
+	, _work_generation (0)
+	, _helpers_start_generation (0)
+	, _helpers_busy (0)
+	, _helpers_quit (false)
+	, _work_tracks (0)
+	, _work_is_flush (false)
+	, _work_next (0)
+	, _work_outstanding (0)
+	, _work_errors (0)
 {
 	g_atomic_int_set(&should_do_transport_work, 0);
 	SessionEvent::pool->set_trash (&pool_trash);
@@ -122,13 +133,21 @@ Butler::start_thread()
 
 	should_run = false;
 
+	/* the helpers must be running, and their number fixed, before the
+	   butler thread can post any work to them.
+	*/
+	start_helpers (std::max (1U, Config->get_butler_threads()) - 1);
+
 	if (pthread_create_and_store ("disk butler", &thread, _thread_work, this)) {
 		error << _("Session: could not create butler thread") << endmsg;
+		stop_helpers ();
 		return -1;
 	}
 
 	//pthread_detach (thread);
 	have_thread = true;
+
+	_read_ahead.start (Config->get_disk_read_ahead_threads());
     
 	// we are ready to request buffer adjustments
 	_session.adjust_capture_buffering ();
@@ -145,9 +164,218 @@ Butler::terminate_thread ()
                 DEBUG_TRACE (DEBUG::Butler, string_compose ("%1: ask butler to quit @ %2\n", DEBUG_THREAD_SELF, g_get_monotonic_time()));
 		queue_request (Request::Quit);
 		pthread_join (thread, &status);
+		stop_helpers ();
+		_read_ahead.stop ();
+	}
+}
+
+void
+Butler::start_helpers (uint32_t n)
+{
+	{
+		Glib::Threads::Mutex::Lock lm (_work_lock);
+		_helpers_quit = false;
+		_helpers_start_generation = _work_generation;
+	}
+
+	for (uint32_t i = 0; i < n; ++i) {
+		pthread_t t;
+
+		if (pthread_create_and_store ("disk butler helper", &t, _helper_thread_work, this)) {
+			error << _("Session: could not create butler helper thread") << endmsg;
+			break;
+		}
+
+		_helpers.push_back (t);
+	}
+}
+
+void
+Butler::stop_helpers ()
+{
+	{
+		Glib::Threads::Mutex::Lock lm (_work_lock);
+		_helpers_quit = true;
+		_work_cond.broadcast ();
+	}
+
+	for (std::vector<pthread_t>::iterator i = _helpers.begin(); i != _helpers.end(); ++i) {
+		void* status;
+		pthread_join (*i, &status);
+	}
+
+	_helpers.clear ();
+}
+
+void *
+Butler::_helper_thread_work (void* arg)
+{
+	SessionEvent::create_per_thread_pool ("butler helper events", 64);
+	pthread_set_name (X_("butler helper"));
+	AudioDiskstream::allocate_thread_working_buffers ();
+	return ((Butler *) arg)->helper_thread_work ();
+}
+
+void *
+Butler::helper_thread_work ()
+{
+	Glib::Threads::Mutex::Lock lm (_work_lock);
+
+	/* not _work_generation: the butler may already have posted a
+	   batch before this thread got here, and that batch counts on us.
+	*/
+	uint32_t generation = _helpers_start_generation;
+
+	while (true) {
+
+		while (generation == _work_generation && !_helpers_quit) {
+			_work_cond.wait (_work_lock);
+		}
+
+		if (_helpers_quit) {
+			break;
+		}
+
+		generation = _work_generation;
+
+		lm.release ();
+		process_work ();
+		lm.acquire ();
+
+		if (--_helpers_busy == 0) {
+			_work_done_cond.signal ();
+		}
+	}
+
+	return 0;
+}
+
+/** Refill or flush each of @param tracks, in order, using the butler thread
+ *  and any helper threads, stopping early if transport work is requested
+ *  or the butler is asked to stop.  Returns once all threads are done.
+ *  @param errors incremented by the number of tracks that failed to flush.
+ *  @return true if there is more disk work to do.
+ */
+bool
+Butler::do_disk_work (TrackList const & tracks, bool flush, uint32_t& errors)
+{
+	if (tracks.empty ()) {
+		return false;
+	}
+
+	_work_tracks = &tracks;
+	_work_is_flush = flush;
+	g_atomic_int_set (&_work_next, 0);
+	g_atomic_int_set (&_work_outstanding, 0);
+	g_atomic_int_set (&_work_errors, 0);
+
+	if (!_helpers.empty ()) {
+		Glib::Threads::Mutex::Lock lm (_work_lock);
+		_helpers_busy = _helpers.size ();
+		++_work_generation;
+		_work_cond.broadcast ();
+	}
+
+	process_work ();
+
+	if (!_helpers.empty ()) {
+		Glib::Threads::Mutex::Lock lm (_work_lock);
+		while (_helpers_busy) {
+			_work_done_cond.wait (_work_lock);
+		}
+	}
+
+	_work_tracks = 0;
+
+	errors += g_atomic_int_get (&_work_errors);
+
+	if (g_atomic_int_get (&_work_next) < (gint) tracks.size ()) {
+		/* we didn't get to all the streams */
+		return true;
+	}
+
+	return g_atomic_int_get (&_work_outstanding);
+}
+
+/** Work through the current batch of tracks; called by the butler thread
+ *  and by each helper thread.
+ */
+void
+Butler::process_work ()
+{
+	TrackList const & tracks (*_work_tracks);
+	gint const n = tracks.size ();
+
+	while (!transport_work_requested() && should_run) {
+
+		gint const i = g_atomic_int_add (&_work_next, 1);
+
+		if (i >= n) {
+			/* leave _work_next at n so that do_disk_work() knows we got to every track */
+			g_atomic_int_add (&_work_next, -1);
+			break;
+		}
+
+		boost::shared_ptr<Track> tr = tracks[i];
+
+		if (!_work_is_flush) {
+
+			DEBUG_TRACE (DEBUG::Butler, string_compose ("butler refills %1, playback load = %2\n", tr->name(), tr->playback_buffer_load()));
+			switch (tr->do_refill ()) {
+			case 0:
+				DEBUG_TRACE (DEBUG::Butler, string_compose ("\ttrack refill done %1\n", tr->name()));
+				break;
+
+			case 1:
+				DEBUG_TRACE (DEBUG::Butler, string_compose ("\ttrack refill unfinished %1\n", tr->name()));
+				g_atomic_int_set (&_work_outstanding, 1);
+				break;
+
+			default:
+				error << string_compose(_("Butler read ahead failure on dstream %1"), tr->name()) << endmsg;
+                                std::cerr << string_compose(_("Butler read ahead failure on dstream %1"), tr->name()) << std::endl;
+				break;
+			}
+
+		} else {
+
+                        gint64 before, after;
+                        int ret;
+
+			DEBUG_TRACE (DEBUG::Butler, string_compose ("butler flushes track %1 capture load %2\n", tr->name(), tr->capture_buffer_load()));
+                        before = g_get_monotonic_time ();
+                        ret = tr->do_flush (ButlerContext);
+                        after = g_get_monotonic_time ();
+			switch (ret) {
+			case 0:
+				DEBUG_TRACE (DEBUG::Butler, string_compose ("\tflush complete for %1, %2 usecs\n", tr->name(), after - before));
+				break;
+
+			case 1:
+				DEBUG_TRACE (DEBUG::Butler, string_compose ("\tflush not finished for %1, %2 usecs\n", tr->name(), after - before));
+				g_atomic_int_set (&_work_outstanding, 1);
+				break;
+
+			default:
+				g_atomic_int_inc (&_work_errors);
+				error << string_compose(_("Butler write-behind failure on dstream %1"), tr->name()) << endmsg;
+                                std::cerr << string_compose(_("Butler write-behind failure on dstream %1"), tr->name()) << std::endl;
+				/* don't stop - try to flush all streams in case they
+				   are split across disks.
+				*/
+			}
+		}
 	}
 }
 
+
+/** Sort tracks so that those with the emptiest playback buffers come first */
+struct PlaybackLoadSorter {
+	bool operator() (std::pair<float, boost::shared_ptr<Track> > const & a, std::pair<float, boost::shared_ptr<Track> > const & b) const {
+		return a.first < b.first;
+	}
+};
+
 void *
 Butler::_thread_work (void* arg)
 {
@@ -223,7 +451,11 @@ Butler::thread_work ()
 		RouteList rl_with_auditioner = *rl;
 		rl_with_auditioner.push_back (_session.the_auditioner());
 
-		for (i = rl_with_auditioner.begin(); !transport_work_requested() && should_run && i != rl_with_auditioner.end(); ++i) {
+		/* refill the tracks whose playback buffers are emptiest first */
+
+		std::vector<std::pair<float, boost::shared_ptr<Track> > > by_load;
+
+		for (i = rl_with_auditioner.begin(); i != rl_with_auditioner.end(); ++i) {
 
 			boost::shared_ptr<Track> tr = boost::dynamic_pointer_cast<Track> (*i);
 
@@ -238,27 +470,27 @@ Butler::thread_work ()
 				DEBUG_TRACE (DEBUG::Butler, string_compose ("butler skips inactive track %1\n", tr->name()));
 				continue;
 			}
-			DEBUG_TRACE (DEBUG::Butler, string_compose ("butler refills %1, playback load = %2\n", tr->name(), tr->playback_buffer_load()));
-			switch (tr->do_refill ()) {
-			case 0:
-				DEBUG_TRACE (DEBUG::Butler, string_compose ("\ttrack refill done %1\n", tr->name()));
-				break;
-				
-			case 1:
-				DEBUG_TRACE (DEBUG::Butler, string_compose ("\ttrack refill unfinished %1\n", tr->name()));
-				disk_work_outstanding = true;
-				break;
 
-			default:
-				error << string_compose(_("Butler read ahead failure on dstream %1"), (*i)->name()) << endmsg;
-                                std::cerr << string_compose(_("Butler read ahead failure on dstream %1"), (*i)->name()) << std::endl;
-				break;
-			}
+			by_load.push_back (std::make_pair (tr->playback_buffer_load(), tr));
+		}
+
+		std::stable_sort (by_load.begin(), by_load.end(), PlaybackLoadSorter ());
+
+		TrackList tracks;
 
+		for (std::vector<std::pair<float, boost::shared_ptr<Track> > >::iterator t = by_load.begin(); t != by_load.end(); ++t) {
+			tracks.push_back (t->second);
 		}
 
-		if (i != rl_with_auditioner.begin() && i != rl_with_auditioner.end()) {
-			/* we didn't get to all the streams */
+		if (_read_ahead.running ()) {
+			/* let the OS start on all the reads we are about to make */
+			for (TrackList::iterator t = tracks.begin(); t != tracks.end(); ++t) {
+				(*t)->prefetch (_read_ahead);
+			}
+			_read_ahead.submit ();
+		}
+
+		if (do_disk_work (tracks, false, err)) {
 			disk_work_outstanding = true;
 		}
 
@@ -267,43 +499,21 @@ Butler::thread_work ()
 			goto restart;
 		}
 
-		for (i = rl->begin(); !transport_work_requested() && should_run && i != rl->end(); ++i) {
-			// cerr << "write behind for " << (*i)->name () << endl;
+		/* note that we still try to flush diskstreams attached to inactive routes
+		 */
 
-			boost::shared_ptr<Track> tr = boost::dynamic_pointer_cast<Track> (*i);
+		tracks.clear ();
 
-			if (!tr) {
-				continue;
+		for (i = rl->begin(); i != rl->end(); ++i) {
+			boost::shared_ptr<Track> tr = boost::dynamic_pointer_cast<Track> (*i);
+			if (tr) {
+				tracks.push_back (tr);
 			}
+		}
 
-			/* note that we still try to flush diskstreams attached to inactive routes
-			 */
-
-                        gint64 before, after;
-                        int ret;
-
-			DEBUG_TRACE (DEBUG::Butler, string_compose ("butler flushes track %1 capture load %2\n", tr->name(), tr->capture_buffer_load()));
-                        before = g_get_monotonic_time ();
-                        ret = tr->do_flush (ButlerContext);
-                        after = g_get_monotonic_time ();
-			switch (ret) {
-			case 0:
-				DEBUG_TRACE (DEBUG::Butler, string_compose ("\tflush complete for %1, %2 usecs\n", tr->name(), after - before));
-				break;
-				
-			case 1:
-				DEBUG_TRACE (DEBUG::Butler, string_compose ("\tflush not finished for %1, %2 usecs\n", tr->name(), after - before));
-				disk_work_outstanding = true;
-				break;
-
-			default:
-				err++;
-				error << string_compose(_("Butler write-behind failure on dstream %1"), (*i)->name()) << endmsg;
-                                std::cerr << string_compose(_("Butler write-behind failure on dstream %1"), (*i)->name()) << std::endl;
-				/* don't break - try to flush all streams in case they
-				   are split across disks.
-				*/
-			}
+		if (do_disk_work (tracks, true, err)) {
+			DEBUG_TRACE (DEBUG::Butler, "not all tracks processed, will need to go back for more\n");
+			disk_work_outstanding = true;
 		}
 
 		if (err && _session.actively_recording()) {
@@ -314,12 +524,6 @@ Butler::thread_work ()
 			_session.request_stop ();
 		}
 
-		if (i != rl->begin() && i != rl->end()) {
-			/* we didn't get to all the streams */
-			DEBUG_TRACE (DEBUG::Butler, "not all tracks processed, will need to go back for more\n");
-			disk_work_outstanding = true;
-		}
-
 		if (!err && transport_work_requested()) {
 			DEBUG_TRACE (DEBUG::Butler, "transport work requested during flush, back to restart\n");
 			goto restart;
@@ -0,0 +1,190 @@
+/*
+    Copyright (C) 2015 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#include <algorithm>
+
+#include "pbd/compose.h"
+#include "pbd/error.h"
+#include "pbd/pthread_utils.h"
+
+#include "ardour/audiosource.h"
+#include "ardour/debug.h"
+#include "ardour/disk_read_ahead.h"
+
+#include "i18n.h"
+
+using namespace ARDOUR;
+using namespace PBD;
+using namespace std;
+
+/** Sort requests so that those for the same source are adjacent and in
+ *  ascending order of position, ready to be merged.
+ */
+struct DiskReadAhead::SourceSorter {
+	bool operator() (Request const & a, Request const & b) const {
+		if (a.source != b.source) {
+			return a.source < b.source;
+		}
+		return a.start < b.start;
+	}
+};
+
+/** Sort requests back into the order in which they were queued */
+struct DiskReadAhead::OrderSorter {
+	bool operator() (Request const & a, Request const & b) const {
+		return a.order < b.order;
+	}
+};
+
+DiskReadAhead::DiskReadAhead ()
+	: _quit (false)
+{
+}
+
+DiskReadAhead::~DiskReadAhead ()
+{
+	stop ();
+}
+
+int
+DiskReadAhead::start (uint32_t nthreads)
+{
+	_quit = false;
+
+	for (uint32_t n = 0; n < nthreads; ++n) {
+		pthread_t t;
+
+		if (pthread_create_and_store ("disk read-ahead", &t, _thread_work, this)) {
+			error << _("Session: could not create disk read-ahead thread") << endmsg;
+			break;
+		}
+
+		_threads.push_back (t);
+	}
+
+	return _threads.size () == nthreads ? 0 : -1;
+}
+
+void
+DiskReadAhead::stop ()
+{
+	{
+		Glib::Threads::Mutex::Lock lm (_lock);
+		_quit = true;
+		_cond.broadcast ();
+	}
+
+	for (vector<pthread_t>::iterator i = _threads.begin(); i != _threads.end(); ++i) {
+		void* status;
+		pthread_join (*i, &status);
+	}
+
+	_threads.clear ();
+	_pending.clear ();
+	_submitted.clear ();
+}
+
+void
+DiskReadAhead::queue (boost::shared_ptr<AudioSource const> src, framepos_t start, framecnt_t cnt)
+{
+	if (cnt <= 0 || !running ()) {
+		return;
+	}
+
+	Glib::Threads::Mutex::Lock lm (_lock);
+	_pending.push_back (Request (src, start, cnt, _pending.size ()));
+}
+
+void
+DiskReadAhead::submit ()
+{
+	Glib::Threads::Mutex::Lock lm (_lock);
+
+	if (_pending.empty ()) {
+		return;
+	}
+
+	/* Merge requests for overlapping or adjacent parts of the same
+	   source (e.g. several tracks playing the same region), keeping
+	   each merged request at the earliest position any of its parts
+	   was queued, so that the butler's priority order is kept.
+	*/
+
+	sort (_pending.begin(), _pending.end(), SourceSorter ());
+
+	Requests::iterator out = _pending.begin ();
+
+	for (Requests::iterator i = _pending.begin() + 1; i != _pending.end(); ++i) {
+		if (i->source == out->source && i->start <= out->start + out->cnt) {
+			out->cnt = max (out->cnt, i->start + i->cnt - out->start);
+			out->order = min (out->order, i->order);
+		} else {
+			*(++out) = *i;
+		}
+	}
+
+	_pending.erase (++out, _pending.end ());
+
+	sort (_pending.begin(), _pending.end(), OrderSorter ());
+
+	DEBUG_TRACE (DEBUG::Butler, string_compose ("submit %1 read-ahead requests\n", _pending.size()));
+
+	/* anything from the last batch that no thread has reached yet is
+	   for data the butler has already read (or no longer wants), so
+	   drop it rather than letting the queue grow behind slow disks.
+	*/
+
+	_submitted.assign (_pending.begin(), _pending.end());
+	_pending.clear ();
+
+	_cond.broadcast ();
+}
+
+void*
+DiskReadAhead::_thread_work (void* arg)
+{
+	pthread_set_name (X_("disk read-ahead"));
+	static_cast<DiskReadAhead*> (arg)->thread_work ();
+	return 0;
+}
+
+void
+DiskReadAhead::thread_work ()
+{
+	Glib::Threads::Mutex::Lock lm (_lock);
+
+	while (true) {
+
+		while (_submitted.empty () && !_quit) {
+			_cond.wait (_lock);
+		}
+
+		if (_quit) {
+			break;
+		}
+
+		Request r (_submitted.front ());
+		_submitted.pop_front ();
+
+		lm.release ();
+		r.source->read_ahead (r.start, r.cnt);
+		r.source.reset ();
+		lm.acquire ();
+	}
+}
@@ -40,6 +40,7 @@
 
 #include "ardour/debug.h"
 #include "ardour/diskstream.h"
+#include "ardour/interpolation.h"
 #include "ardour/io.h"
 #include "ardour/pannable.h"
 #include "ardour/profile.h"
@@ -223,7 +224,7 @@ Diskstream::realtime_set_speed (double sp, bool global)
 	if (new_speed != _actual_speed) {
 
 		framecnt_t required_wrap_size = (framecnt_t) ceil (_session.get_block_size() *
-                                                                  fabs (new_speed)) + 2;
+                                                                  fabs (new_speed)) + 2 + VarispeedInterpolation::max_lookahead ();
 
 		if (required_wrap_size > wrap_buffer_size) {
 			_buffer_reallocation_required = true;
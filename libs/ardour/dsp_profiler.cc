@@ -0,0 +1,191 @@
+/*
+    Copyright (C) 2015 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#include <algorithm>
+
+#include <glibmm/timer.h>
+
+#include "ardour/ardour.h"
+#include "ardour/dsp_profiler.h"
+#include "ardour/process_thread.h"
+
+using namespace ARDOUR;
+using namespace std;
+
+bool DSPProfiler::_enabled = false;
+bool DSPProfiler::_use_cycles = false;
+float DSPProfiler::_cycles_per_usec = 1;
+Glib::Threads::Mutex DSPProfiler::_lock;
+DSPProfiler::Histories DSPProfiler::_histories;
+list<DSPProfiler::Timings*> DSPProfiler::_timings;
+
+uint64_t
+DSPProfiler::fallback_now ()
+{
+	return get_microseconds ();
+}
+
+/** Work out how fast get_cycles() counts, or whether it counts at all;
+ *  on some platforms it always returns 0, in which case we use
+ *  get_microseconds() instead.
+ */
+void
+DSPProfiler::calibrate ()
+{
+	microseconds_t const t0 = get_microseconds ();
+	cycles_t const c0 = get_cycles ();
+
+	Glib::usleep (20000);
+
+	microseconds_t const t1 = get_microseconds ();
+	cycles_t const c1 = get_cycles ();
+
+	if (c1 > c0 && t1 > t0) {
+		_use_cycles = true;
+		_cycles_per_usec = (float) (c1 - c0) / (float) (t1 - t0);
+	} else {
+		_use_cycles = false;
+		_cycles_per_usec = 1;
+	}
+}
+
+void
+DSPProfiler::set_enabled (bool yn)
+{
+	Glib::Threads::Mutex::Lock lm (_lock);
+
+	if (yn == _enabled) {
+		return;
+	}
+
+	if (yn) {
+		calibrate ();
+	}
+
+	_enabled = yn;
+}
+
+/** Called once by each ThreadBuffers, outside of any process thread.
+ *  @return a ring buffer for one process thread to write its measurements into.
+ */
+DSPProfiler::Timings*
+DSPProfiler::add_timings ()
+{
+	Glib::Threads::Mutex::Lock lm (_lock);
+	Timings* t = new Timings (8192);
+	_timings.push_back (t);
+	return t;
+}
+
+void
+DSPProfiler::record (void const* object, cycles_t start)
+{
+	Timing t;
+
+	t.object = object;
+	t.cycles = now () - start;
+
+	Timings* timings = ProcessThread::dsp_timings ();
+
+	if (timings) {
+		timings->write (&t, 1);
+	}
+}
+
+/** Move measurements from the process threads' ring buffers into the
+ *  histories.  Caller must hold _lock.
+ */
+void
+DSPProfiler::collect ()
+{
+	for (list<Timings*>::iterator i = _timings.begin(); i != _timings.end(); ++i) {
+
+		Timing t;
+
+		while ((*i)->read (&t, 1) == 1) {
+
+			History& h (_histories[t.object]);
+			float const usecs = t.cycles / _cycles_per_usec;
+
+			if (h.usecs.size() < window_size) {
+				h.usecs.push_back (usecs);
+			} else {
+				h.usecs[h.next] = usecs;
+				h.next = (h.next + 1) % window_size;
+			}
+		}
+	}
+}
+
+/** Fill in @param s with a summary of the recent measurements of @param object.
+ *  @return false if there are none.
+ */
+bool
+DSPProfiler::stats (void const* object, Stats& s)
+{
+	Glib::Threads::Mutex::Lock lm (_lock);
+
+	collect ();
+
+	Histories::const_iterator h = _histories.find (object);
+
+	if (h == _histories.end() || h->second.usecs.empty()) {
+		s = Stats ();
+		return false;
+	}
+
+	vector<float> sorted (h->second.usecs);
+	sort (sorted.begin(), sorted.end());
+
+	float sum = 0;
+	for (vector<float>::const_iterator i = sorted.begin(); i != sorted.end(); ++i) {
+		sum += *i;
+	}
+
+	size_t const n = sorted.size ();
+
+	s.count = n;
+	s.min = sorted.front ();
+	s.max = sorted.back ();
+	s.avg = sum / n;
+	s.p95 = sorted[min (n - 1, (n * 95) / 100)];
+	s.p99 = sorted[min (n - 1, (n * 99) / 100)];
+
+	return true;
+}
+
+/** Drop all measurements of @param object, which is about to be destroyed */
+void
+DSPProfiler::forget (void const* object)
+{
+	Glib::Threads::Mutex::Lock lm (_lock);
+
+	collect ();
+	_histories.erase (object);
+}
+
+/** Drop all measurements */
+void
+DSPProfiler::reset ()
+{
+	Glib::Threads::Mutex::Lock lm (_lock);
+
+	collect ();
+	_histories.clear ();
+}
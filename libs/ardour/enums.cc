@@ -74,6 +74,7 @@ setup_enum_writer ()
 	AFLPosition _AFLPosition;
 	RemoteModel _RemoteModel;
 	DenormalModel _DenormalModel;
+	VarispeedQuality _VarispeedQuality;
 	LayerModel _LayerModel;
 	InsertMergePolicy _InsertMergePolicy;
 	ListenPosition _ListenPosition;
@@ -292,6 +293,12 @@ setup_enum_writer ()
 	REGISTER_ENUM (DenormalFTZDAZ);
 	REGISTER (_DenormalModel);
 
+	REGISTER_ENUM (VarispeedLinear);
+	REGISTER_ENUM (VarispeedCubic);
+	REGISTER_ENUM (VarispeedSinc16);
+	REGISTER_ENUM (VarispeedSinc64);
+	REGISTER (_VarispeedQuality);
+
 	REGISTER_ENUM (UserOrdered);
 	REGISTER_ENUM (MixerOrdered);
 	REGISTER (_RemoteModel);
@@ -936,6 +943,19 @@ std::ostream& operator<<(std::ostream& o, const DenormalModel& var)
 	std::string s = enum_2_string (var);
 	return o << s;
 }
+std::istream& operator>>(std::istream& o, VarispeedQuality& var)
+{
+	std::string s;
+	o >> s;
+	var = (VarispeedQuality) string_2_enum (s, var);
+	return o;
+}
+
+std::ostream& operator<<(std::ostream& o, const VarispeedQuality& var)
+{
+	std::string s = enum_2_string (var);
+	return o << s;
+}
 std::istream& operator>>(std::istream& o, WaveformScale& var)
 {
 	std::string s;
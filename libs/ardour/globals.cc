@@ -135,6 +135,8 @@ apply_gain_to_buffer_t  ARDOUR::apply_gain_to_buffer = 0;
 mix_buffers_with_gain_t ARDOUR::mix_buffers_with_gain = 0;
 mix_buffers_no_gain_t   ARDOUR::mix_buffers_no_gain = 0;
 copy_vector_t			ARDOUR::copy_vector = 0;
+apply_gain_vector_to_buffer_t  ARDOUR::apply_gain_vector_to_buffer = 0;
+mix_buffers_with_gain_vector_t ARDOUR::mix_buffers_with_gain_vector = 0;
 
 PBD::Signal1<void,std::string> ARDOUR::BootMessage;
 PBD::Signal3<void,std::string,std::string,bool> ARDOUR::PluginScanMessage;
@@ -164,7 +166,39 @@ setup_hardware_optimization (bool try_optimization)
 
 #if defined (ARCH_X86) && defined (BUILD_SSE_OPTIMIZATIONS)
 
-		if (fpu.has_avx()) {
+		if (fpu.has_avx512f()) {
+
+			info << "Using AVX-512 optimized routines" << endmsg;
+
+			// AVX-512 SET
+			compute_peak          = x86_avx512f_compute_peak;
+			find_peaks            = x86_avx512f_find_peaks;
+			apply_gain_to_buffer  = x86_avx512f_apply_gain_to_buffer;
+			mix_buffers_with_gain = x86_avx512f_mix_buffers_with_gain;
+			mix_buffers_no_gain   = x86_avx512f_mix_buffers_no_gain;
+			copy_vector           = x86_avx512f_copy_vector;
+			apply_gain_vector_to_buffer  = x86_avx512f_apply_gain_vector_to_buffer;
+			mix_buffers_with_gain_vector = x86_avx512f_mix_buffers_with_gain_vector;
+
+			generic_mix_functions = false;
+
+		} else if (fpu.has_avx2() && fpu.has_fma()) {
+
+			info << "Using AVX2/FMA optimized routines" << endmsg;
+
+			// AVX SET, with fused multiply-add for the mixes
+			compute_peak          = x86_sse_avx_compute_peak;
+			find_peaks            = x86_sse_avx_find_peaks;
+			apply_gain_to_buffer  = x86_sse_avx_apply_gain_to_buffer;
+			mix_buffers_with_gain = x86_fma_mix_buffers_with_gain;
+			mix_buffers_no_gain   = x86_sse_avx_mix_buffers_no_gain;
+			copy_vector           = x86_sse_avx_copy_vector;
+			apply_gain_vector_to_buffer  = x86_sse_avx_apply_gain_vector_to_buffer;
+			mix_buffers_with_gain_vector = x86_fma_mix_buffers_with_gain_vector;
+
+			generic_mix_functions = false;
+
+		} else if (fpu.has_avx()) {
 
 			info << "Using AVX optimized routines" << endmsg;
 
@@ -175,6 +209,8 @@ setup_hardware_optimization (bool try_optimization)
 			mix_buffers_with_gain = x86_sse_avx_mix_buffers_with_gain;
 			mix_buffers_no_gain   = x86_sse_avx_mix_buffers_no_gain;
 			copy_vector           = x86_sse_avx_copy_vector;
+			apply_gain_vector_to_buffer  = x86_sse_avx_apply_gain_vector_to_buffer;
+			mix_buffers_with_gain_vector = x86_sse_avx_mix_buffers_with_gain_vector;
 
 			generic_mix_functions = false;
 
@@ -189,6 +225,8 @@ setup_hardware_optimization (bool try_optimization)
 			mix_buffers_with_gain = x86_sse_mix_buffers_with_gain;
 			mix_buffers_no_gain   = x86_sse_mix_buffers_no_gain;
 			copy_vector           = default_copy_vector;
+			apply_gain_vector_to_buffer  = x86_sse_apply_gain_vector_to_buffer;
+			mix_buffers_with_gain_vector = x86_sse_mix_buffers_with_gain_vector;
 
 			generic_mix_functions = false;
 
@@ -207,6 +245,8 @@ setup_hardware_optimization (bool try_optimization)
 			mix_buffers_with_gain  = veclib_mix_buffers_with_gain;
 			mix_buffers_no_gain    = veclib_mix_buffers_no_gain;
 			copy_vector            = default_copy_vector;
+			apply_gain_vector_to_buffer  = veclib_apply_gain_vector_to_buffer;
+			mix_buffers_with_gain_vector = veclib_mix_buffers_with_gain_vector;
 
 			generic_mix_functions = false;
 
@@ -227,6 +267,8 @@ setup_hardware_optimization (bool try_optimization)
 		mix_buffers_with_gain = default_mix_buffers_with_gain;
 		mix_buffers_no_gain   = default_mix_buffers_no_gain;
 		copy_vector           = default_copy_vector;
+		apply_gain_vector_to_buffer  = default_apply_gain_vector_to_buffer;
+		mix_buffers_with_gain_vector = default_mix_buffers_with_gain_vector;
 
 		info << "No H/W specific optimizations in use" << endmsg;
 	}
@@ -19,11 +19,13 @@
 */
 #include <stdio.h>
 #include <cmath>
+#include <algorithm>
 
 #include "pbd/compose.h"
 #include "pbd/debug_rt_alloc.h"
 #include "pbd/pthread_utils.h"
 
+#include "ardour/ardour.h"
 #include "ardour/debug.h"
 #include "ardour/graph.h"
 #include "ardour/types.h"
@@ -31,6 +33,7 @@
 #include "ardour/route.h"
 #include "ardour/process_thread.h"
 #include "ardour/audioengine.h"
+#include "ardour/rc_configuration.h"
 
 #include "i18n.h"
 
@@ -51,6 +54,24 @@ int alloc_allowed ()
 }
 #endif
 
+/* Workers are owned by the Graph, not by the thread */
+static void
+release_worker (void*)
+{
+}
+
+Glib::Threads::Private<Graph::Worker> Graph::_worker (release_worker);
+
+Graph::Worker::Worker (std::string const & name)
+	: deque (1024)
+	, subtasks_done (name.c_str(), 0)
+	, steals (0)
+	, failed_steals (0)
+	, overflows (0)
+	, idle_usecs (0)
+{
+}
+
 Graph::Graph (Session & session)
         : SessionHandleRef (session)
         , _threads_active (false)
@@ -58,6 +79,11 @@ Graph::Graph (Session & session)
 	, _callback_start_sem ("graph_start", 0)
 	, _callback_done_sem ("graph_done", 0)
 	, _cleanup_sem ("graph_cleanup", 0)
+	, _work_stealing (false)
+	, _next_worker (0)
+	, _overflow_size (0)
+	, _cycle_start (0)
+	, _cycle_stats_index (0)
 {
         pthread_mutex_init( &_trigger_mutex, NULL);
 
@@ -65,6 +91,8 @@ Graph::Graph (Session & session)
 	   memory in the RT thread.
 	*/
 	_trigger_queue.reserve (8192);
+	_subtask_queue.reserve (1024);
+	_subtask_count = 0;
 
         _execution_tokens = 0;
 
@@ -77,6 +105,7 @@ Graph::Graph (Session & session)
 	ARDOUR::AudioEngine::instance()->Running.connect_same_thread (engine_connections, boost::bind (&Graph::reset_thread_list, this));
 	ARDOUR::AudioEngine::instance()->Stopped.connect_same_thread (engine_connections, boost::bind (&Graph::engine_stopped, this));
 	ARDOUR::AudioEngine::instance()->Halted.connect_same_thread (engine_connections, boost::bind (&Graph::engine_stopped, this));
+	Config->ParameterChanged.connect_same_thread (engine_connections, boost::bind (&Graph::parameter_changed, this, _1));
 
         reset_thread_list ();
 
@@ -86,6 +115,33 @@ Graph::Graph (Session & session)
 #endif
 }
 
+Graph::~Graph ()
+{
+	for (vector<Worker*>::iterator i = _workers.begin(); i != _workers.end(); ++i) {
+		delete *i;
+	}
+}
+
+void
+Graph::parameter_changed (std::string const & p)
+{
+	if (p != "work-stealing-graph") {
+		return;
+	}
+
+	if (_work_stealing == Config->get_work_stealing_graph() || AudioEngine::instance()->process_thread_count() == 0) {
+		/* nothing to do, or the change will be picked up when the engine starts */
+		return;
+	}
+
+	{
+		Glib::Threads::Mutex::Lock lm (_session.engine().process_lock());
+		drop_threads ();
+	}
+
+	reset_thread_list ();
+}
+
 void
 Graph::engine_stopped ()
 {
@@ -117,6 +173,26 @@ Graph::reset_thread_list ()
                 drop_threads ();
         }
 
+	/* the scheduler can only be changed while no process threads are running */
+
+	_work_stealing = Config->get_work_stealing_graph ();
+
+	for (vector<Worker*>::iterator i = _workers.begin(); i != _workers.end(); ++i) {
+		delete *i;
+	}
+	_workers.clear ();
+
+	/* every thread has a Worker, so that we can tell our threads from
+	   others, though only the work-stealing scheduler uses its deque.
+	*/
+	for (uint32_t i = 0; i < num_threads; ++i) {
+		_workers.push_back (new Worker (string_compose ("graph_subtasks_%1", i)));
+	}
+
+	_next_worker = 0;
+	_overflow_size = 0;
+	_trigger_queue.clear ();
+
 	if (AudioEngine::instance()->create_process_thread (boost::bind (&Graph::main_thread, this)) != 0) {
 		throw failed_constructor ();
 	}
@@ -140,6 +216,9 @@ Graph::session_going_away()
         _init_trigger_list[0].clear();
         _init_trigger_list[1].clear();
         _trigger_queue.clear();
+        _overflow_size = 0;
+        _subtask_queue.clear();
+        _subtask_count = 0;
 }
 
 void
@@ -208,13 +287,33 @@ Graph::prep()
                 (*i)->prep( chain);
                 _graph_empty = false;
         }
+
+	/* Update node priorities from their measured costs. _nodes_rt is in
+	   topological order, so walking it backwards visits every node after
+	   all of the nodes that it feeds.
+	*/
+	for (node_list_t::reverse_iterator r = _nodes_rt[chain].rbegin(); r != _nodes_rt[chain].rend(); ++r) {
+		(*r)->update_priority (chain);
+	}
         _finished_refcount = _init_finished_refcount[chain];
 
+	if (_work_stealing) {
+		_cycle_start = get_microseconds ();
+
+		/* Push the initial nodes onto the calling thread's deque,
+		   waking up other threads to steal them as we go.
+		*/
+		for (i=_init_trigger_list[chain].begin(); i!=_init_trigger_list[chain].end(); i++) {
+			trigger (i->get ());
+		}
+		return;
+	}
+
 	/* Trigger the initial nodes for processing, which are the ones at the `input' end */
 	pthread_mutex_lock (&_trigger_mutex);
         for (i=_init_trigger_list[chain].begin(); i!=_init_trigger_list[chain].end(); i++) {
 		/* don't use ::trigger here, as we have already locked the mutex */
-                _trigger_queue.push_back (i->get ());
+                push_trigger_queue (i->get ());
         }
 	pthread_mutex_unlock (&_trigger_mutex);
 }
@@ -222,8 +321,36 @@ Graph::prep()
 void
 Graph::trigger (GraphNode* n)
 {
+	if (_work_stealing) {
+		Worker* w = _worker.get ();
+
+		if (w && w->deque.push (n)) {
+			/* The calling thread will run one node itself when it
+			   is done; wake up a sleeping thread for any others.
+			*/
+			if (w->deque.read_space () > 1) {
+				wake_one ();
+			}
+			return;
+		}
+
+		/* deque full, or not called from a process thread */
+
+		if (w) {
+			g_atomic_int_inc (&w->overflows);
+		}
+
+		pthread_mutex_lock (&_trigger_mutex);
+		push_trigger_queue (n);
+		g_atomic_int_inc (&_overflow_size);
+		pthread_mutex_unlock (&_trigger_mutex);
+
+		wake_one ();
+		return;
+	}
+
 	pthread_mutex_lock (&_trigger_mutex);
-        _trigger_queue.push_back (n);
+        push_trigger_queue (n);
 	pthread_mutex_unlock (&_trigger_mutex);
 }
 
@@ -249,6 +376,10 @@ Graph::restart_cycle()
         // we are through. wakeup our caller.
 
   again:
+	if (_work_stealing) {
+		publish_cycle_stats ();
+	}
+
         _callback_done_sem.signal ();
 
         /* Block until the a process callback triggers us */
@@ -350,18 +481,25 @@ Graph::run_one()
 {
         GraphNode* to_run;
 
+	if (_work_stealing) {
+		return run_one_stealing ();
+	}
+
+        GraphSubTask* subtask;
+
         pthread_mutex_lock (&_trigger_mutex);
-        if (_trigger_queue.size()) {
-                to_run = _trigger_queue.back();
-                _trigger_queue.pop_back();
-        } else {
-                to_run = 0;
-        }
+
+	/* subtasks first, since the thread that queued them is waiting */
+        if ((subtask = pop_subtask ()) != 0) {
+		to_run = 0;
+	} else {
+		to_run = pop_trigger_queue ();
+	}
 
 	/* the number of threads that are asleep */
 	int et = _execution_tokens;
-	/* the number of nodes that need to be run */
-	int ts = _trigger_queue.size();
+	/* the number of nodes and subtasks that need to be run */
+	int ts = _trigger_queue.size() + _subtask_queue.size();
 
 	/* hence how many threads to wake up */
         int wakeup = min (et, ts);
@@ -374,7 +512,7 @@ Graph::run_one()
                 _execution_sem.signal ();
         }
 
-        while (to_run == 0) {
+        while (to_run == 0 && subtask == 0) {
                 _execution_tokens += 1;
                 pthread_mutex_unlock (&_trigger_mutex);
                 DEBUG_TRACE (DEBUG::ProcessThreads, string_compose ("%1 goes to sleep\n", pthread_name()));
@@ -384,21 +522,272 @@ Graph::run_one()
                 }
                 DEBUG_TRACE (DEBUG::ProcessThreads, string_compose ("%1 is awake\n", pthread_name()));
                 pthread_mutex_lock (&_trigger_mutex);
-                if (_trigger_queue.size()) {
-                        to_run = _trigger_queue.back();
-                        _trigger_queue.pop_back();
-                }
+                if ((subtask = pop_subtask ()) == 0) {
+			to_run = pop_trigger_queue ();
+		}
         }
         pthread_mutex_unlock (&_trigger_mutex);
 
-        to_run->process();
-        to_run->finish (_current_chain);
+	if (subtask) {
+		run_subtask (subtask);
+		return false;
+	}
+
+        run_node (to_run);
 
         DEBUG_TRACE(DEBUG::ProcessThreads, string_compose ("%1 has finished run_one()\n", pthread_name()));
 
         return false;
 }
 
+/** Orders _trigger_queue as a max-heap on node priority.  Priorities are
+ *  only updated in prep(), when the queue is empty, so the heap stays valid.
+ */
+struct TriggerQueueOrder {
+	bool operator() (GraphNode const * a, GraphNode const * b) const {
+		return a->priority () < b->priority ();
+	}
+};
+
+/** Add a node to the trigger queue.
+ *  Caller must hold _trigger_mutex.
+ */
+void
+Graph::push_trigger_queue (GraphNode* n)
+{
+	_trigger_queue.push_back (n);
+	push_heap (_trigger_queue.begin(), _trigger_queue.end(), TriggerQueueOrder ());
+}
+
+/** Remove the queued node with the highest priority, ie the one on the
+ *  most expensive path to the output end of the graph.
+ *  Caller must hold _trigger_mutex.
+ *  @return the node, or 0 if the queue is empty.
+ */
+GraphNode*
+Graph::pop_trigger_queue ()
+{
+	if (_trigger_queue.empty ()) {
+		return 0;
+	}
+
+	pop_heap (_trigger_queue.begin(), _trigger_queue.end(), TriggerQueueOrder ());
+
+	GraphNode* n = _trigger_queue.back ();
+	_trigger_queue.pop_back ();
+
+	return n;
+}
+
+/** Run a node, measuring how long it takes, and then tell the nodes
+ *  that it feeds that it is done.
+ */
+void
+Graph::run_node (GraphNode* n)
+{
+	microseconds_t const then = get_microseconds ();
+
+	n->process ();
+
+	if (!_process_silent) {
+		/* silent cycles are not representative of a node's cost */
+		n->update_cost (get_microseconds () - then);
+	}
+
+	n->finish (_current_chain);
+}
+
+/** Wake up one sleeping process thread, if there is one */
+void
+Graph::wake_one ()
+{
+	gint et;
+
+	while ((et = g_atomic_int_get (&_execution_tokens)) > 0) {
+		if (g_atomic_int_compare_and_exchange (&_execution_tokens, et, et - 1)) {
+			_execution_sem.signal ();
+			break;
+		}
+	}
+}
+
+/** Try to find a node for the calling thread's Worker @param w to run,
+ *  other than one from its own deque.
+ *  @return the node, or 0 if none could be found.
+ */
+GraphNode*
+Graph::steal (Worker* w)
+{
+	while (g_atomic_int_get (&_subtask_count) > 0) {
+		/* help out with somebody's subtasks before taking new nodes */
+		GraphSubTask* subtask;
+
+		pthread_mutex_lock (&_trigger_mutex);
+		subtask = pop_subtask ();
+		pthread_mutex_unlock (&_trigger_mutex);
+
+		if (!subtask) {
+			break;
+		}
+
+		run_subtask (subtask);
+	}
+
+	uint32_t const n = _workers.size ();
+	uint32_t self = 0;
+
+	while (_workers[self] != w) {
+		++self;
+	}
+
+	for (uint32_t k = 1; k < n; ++k) {
+		Worker* victim = _workers[(self + k) % n];
+
+		if (victim->deque.empty ()) {
+			continue;
+		}
+
+		GraphNode* node = victim->deque.steal ();
+
+		if (node) {
+			g_atomic_int_inc (&w->steals);
+			return node;
+		}
+
+		g_atomic_int_inc (&w->failed_steals);
+	}
+
+	if (g_atomic_int_get (&_overflow_size) > 0) {
+		GraphNode* node = 0;
+
+		pthread_mutex_lock (&_trigger_mutex);
+		if ((node = pop_trigger_queue ()) != 0) {
+			g_atomic_int_add (&_overflow_size, -1);
+		}
+		pthread_mutex_unlock (&_trigger_mutex);
+
+		return node;
+	}
+
+	return 0;
+}
+
+/** Work-stealing version of run_one(); each thread runs nodes from its
+ *  own deque first, then tries to steal from the other threads, and
+ *  finally goes to sleep until somebody has surplus work.
+ *  @return true to quit, false to carry on.
+ */
+bool
+Graph::run_one_stealing ()
+{
+	Worker* w = _worker.get ();
+	GraphNode* to_run = w->deque.pop ();
+
+	if (!to_run) {
+		to_run = steal (w);
+	}
+
+	while (!to_run) {
+
+		microseconds_t const idle_start = get_microseconds ();
+
+		/* Announce that we are going to sleep, then look once more
+		   so that a node pushed before the announcement is not missed.
+		*/
+		g_atomic_int_inc (&_execution_tokens);
+
+		to_run = steal (w);
+
+		if (to_run) {
+			/* take our token back, unless another thread has already
+			   used it to wake somebody; that thread will just find
+			   nothing to do and go back to sleep.
+			*/
+			gint et;
+			while ((et = g_atomic_int_get (&_execution_tokens)) > 0) {
+				if (g_atomic_int_compare_and_exchange (&_execution_tokens, et, et - 1)) {
+					break;
+				}
+			}
+		} else {
+			DEBUG_TRACE (DEBUG::ProcessThreads, string_compose ("%1 goes to sleep\n", pthread_name()));
+			_execution_sem.wait ();
+			if (!_threads_active) {
+				return true;
+			}
+			DEBUG_TRACE (DEBUG::ProcessThreads, string_compose ("%1 is awake\n", pthread_name()));
+
+			to_run = w->deque.pop ();
+			if (!to_run) {
+				to_run = steal (w);
+			}
+		}
+
+		/* only count idle time that falls within the current cycle */
+		microseconds_t const now = get_microseconds ();
+		microseconds_t const cycle_start = _cycle_start;
+		g_atomic_int_add (&w->idle_usecs, (gint) (now - max (idle_start, min (cycle_start, now))));
+	}
+
+	run_node (to_run);
+
+	DEBUG_TRACE(DEBUG::ProcessThreads, string_compose ("%1 has finished run_one_stealing()\n", pthread_name()));
+
+	return false;
+}
+
+/** Give the calling process thread its own Worker */
+void
+Graph::claim_worker ()
+{
+	gint const n = g_atomic_int_add (&_next_worker, 1);
+	assert (n < (gint) _workers.size ());
+	_worker.set (_workers[n]);
+}
+
+/** Collect the per-thread scheduler statistics for the cycle that has
+ *  just finished.  Called from the thread that completed the cycle.
+ */
+void
+Graph::publish_cycle_stats ()
+{
+	int const next = !g_atomic_int_get (&_cycle_stats_index);
+	CycleStats& cs (_cycle_stats[next]);
+
+	cs = CycleStats ();
+
+	for (vector<Worker*>::iterator i = _workers.begin(); i != _workers.end(); ++i) {
+		gint v;
+
+		v = g_atomic_int_get (&(*i)->steals);
+		g_atomic_int_add (&(*i)->steals, -v);
+		cs.steals += v;
+
+		v = g_atomic_int_get (&(*i)->failed_steals);
+		g_atomic_int_add (&(*i)->failed_steals, -v);
+		cs.failed_steals += v;
+
+		v = g_atomic_int_get (&(*i)->overflows);
+		g_atomic_int_add (&(*i)->overflows, -v);
+		cs.overflows += v;
+
+		v = g_atomic_int_get (&(*i)->idle_usecs);
+		g_atomic_int_add (&(*i)->idle_usecs, -v);
+		cs.idle_usecs += v;
+	}
+
+	g_atomic_int_set (&_cycle_stats_index, next);
+
+	DEBUG_TRACE (DEBUG::ProcessThreads, string_compose ("cycle done: %1 steals, %2 failed steals, %3 overflows, %4 usecs idle\n",
+	                                                    cs.steals, cs.failed_steals, cs.overflows, cs.idle_usecs));
+}
+
+Graph::CycleStats
+Graph::cycle_stats () const
+{
+	return _cycle_stats[g_atomic_int_get (&_cycle_stats_index)];
+}
+
 void
 Graph::helper_thread()
 {
@@ -406,6 +795,8 @@ Graph::helper_thread()
 	ProcessThread* pt = new ProcessThread ();
 	resume_rt_malloc_checks ();
 
+	claim_worker ();
+
         pt->get_buffers();
 
         while(1) {
@@ -425,6 +816,8 @@ Graph::main_thread()
 	ProcessThread* pt = new ProcessThread ();
 	resume_rt_malloc_checks ();
 
+	claim_worker ();
+
         pt->get_buffers();
 
   again:
@@ -594,3 +987,116 @@ Graph::in_process_thread () const
 {
 	return AudioEngine::instance()->in_process_thread ();
 }
+
+/** @return true if the calling thread is one of this graph's process threads */
+bool
+Graph::in_graph_thread () const
+{
+	Worker* w = _worker.get ();
+	return w && find (_workers.begin(), _workers.end(), w) != _workers.end();
+}
+
+/** Caller must hold _trigger_mutex.
+ *  @return a queued subtask, or 0 if there are none.
+ */
+GraphSubTask*
+Graph::pop_subtask ()
+{
+	if (_subtask_queue.empty ()) {
+		return 0;
+	}
+
+	GraphSubTask* t = _subtask_queue.back ();
+	_subtask_queue.pop_back ();
+	g_atomic_int_add (&_subtask_count, -1);
+
+	return t;
+}
+
+void
+Graph::run_subtask (GraphSubTask* t)
+{
+	DEBUG_TRACE (DEBUG::ProcessThreads, string_compose ("%1 runs a subtask\n", pthread_name()));
+
+	/* the batch's owner may return as soon as it is told that the
+	   batch is finished, so t must not be touched after this.
+	*/
+	gint* pending = t->_pending;
+	PBD::ProcessSemaphore* done = t->_done;
+	t->run ();
+	if (g_atomic_int_dec_and_test (pending)) {
+		done->signal ();
+	}
+}
+
+/** Run some independent pieces of the current node's work, sharing them
+ *  out amongst any idle graph threads, and return when they are all done.
+ *  Must be called from one of the graph's threads while it is processing
+ *  a node.  The calling thread runs the first task itself, helps with
+ *  any others that no thread has picked up, and then sleeps until the
+ *  rest are finished.
+ */
+void
+Graph::process_subtasks (GraphSubTask** tasks, uint32_t n_tasks)
+{
+	if (n_tasks == 0) {
+		return;
+	}
+
+	Worker* w = _worker.get ();
+	assert (w);
+
+	gint pending = n_tasks;
+
+	for (uint32_t i = 0; i < n_tasks; ++i) {
+		tasks[i]->_pending = &pending;
+		tasks[i]->_done = &w->subtasks_done;
+	}
+
+	pthread_mutex_lock (&_trigger_mutex);
+
+	for (uint32_t i = 1; i < n_tasks; ++i) {
+		_subtask_queue.push_back (tasks[i]);
+	}
+	g_atomic_int_add (&_subtask_count, n_tasks - 1);
+
+	if (!_work_stealing) {
+		int wakeup = min ((int) _execution_tokens, (int) n_tasks - 1);
+		_execution_tokens -= wakeup;
+		for (int i = 0; i < wakeup; i++) {
+			_execution_sem.signal ();
+		}
+	}
+
+	pthread_mutex_unlock (&_trigger_mutex);
+
+	if (_work_stealing) {
+		for (uint32_t i = 1; i < n_tasks; ++i) {
+			wake_one ();
+		}
+	}
+
+	run_subtask (tasks[0]);
+
+	/* help with whatever has not yet been picked up */
+
+	while (g_atomic_int_get (&pending) > 0 && g_atomic_int_get (&_subtask_count) > 0) {
+		GraphSubTask* t;
+
+		pthread_mutex_lock (&_trigger_mutex);
+		t = pop_subtask ();
+		pthread_mutex_unlock (&_trigger_mutex);
+
+		if (t) {
+			run_subtask (t);
+		}
+	}
+
+	/* the remainder are already running on other threads; sleep until
+	   the last of them is done.  Whichever thread finishes the batch
+	   signals exactly once, even if that is this one, so this never
+	   leaves a stale count on the semaphore.
+	*/
+
+	w->subtasks_done.wait ();
+}
@@ -18,6 +18,8 @@
 
 */
 
+#include <algorithm>
+
 #include "ardour/graph.h"
 #include "ardour/graphnode.h"
 #include "ardour/route.h"
@@ -26,6 +28,8 @@ using namespace ARDOUR;
 
 GraphNode::GraphNode (boost::shared_ptr<Graph> graph)
         : _graph(graph)
+        , _cost (0)
+        , _priority (0)
 {
 }
 
@@ -54,18 +58,55 @@ GraphNode::dec_ref()
 	}
 }
 
+/** Fold the time taken by one run of process() into our cost estimate */
+void
+GraphNode::update_cost (microseconds_t usecs)
+{
+	_cost += 0.05f * ((float) usecs - _cost);
+}
+
+/** Recompute our priority from our cost and those of the nodes that
+ *  we feed.  Those nodes must have been updated first.
+ */
+void
+GraphNode::update_priority (int chain)
+{
+	float downstream = 0;
+
+        for (node_set_t::iterator i = _activation_set[chain].begin(); i != _activation_set[chain].end(); ++i) {
+		downstream = std::max (downstream, (*i)->_priority);
+	}
+
+	_priority = _cost + downstream;
+}
+
 void
 GraphNode::finish (int chain)
 {
         node_set_t::iterator i;
         bool feeds_somebody = false;
+	GraphNode* critical = 0;
 
-	/* Tell the nodes that we feed that we've finished */
+	/* Tell the nodes that we feed that we've finished, leaving the
+	   one on the critical path until last so that it ends up at
+	   the front of the queue if it is ready to run.
+	*/
         for (i=_activation_set[chain].begin(); i!=_activation_set[chain].end(); i++) {
-                (*i)->dec_ref();
+		if (!critical) {
+			critical = i->get ();
+		} else if ((*i)->_priority > critical->_priority) {
+			critical->dec_ref ();
+			critical = i->get ();
+		} else {
+			(*i)->dec_ref();
+		}
                 feeds_somebody = true;
         }
 
+	if (critical) {
+		critical->dec_ref ();
+	}
+
         if (!feeds_somebody) {
 		/* This node does not feed anybody, so decrement the graph's finished count */
                 _graph->dec_ref();
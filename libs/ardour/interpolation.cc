@@ -19,6 +19,7 @@
 
 #include <stdint.h>
 #include <cstdio>
+#include <algorithm>
 
 #include "ardour/interpolation.h"
 #include "ardour/midi_buffer.h"
@@ -154,6 +155,329 @@ CubicInterpolation::interpolate (int channel, framecnt_t nframes, Sample *input,
 	return i;
 }
 
+/* The windowed-sinc kernels are tabulated at kernel_phases + 1 fractional
+   positions between one input sample and the next, each row holding one
+   weight per tap; weights for positions in between are interpolated
+   linearly from the rows either side.
+*/
+static int const kernel_phases = 256;
+
+/** Zeroth-order modified Bessel function of the first kind, for the Kaiser window */
+static double
+bessel_i0 (double x)
+{
+	double sum = 1.0;
+	double term = 1.0;
+
+	for (int k = 1; k < 32; ++k) {
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+	}
+
+	return sum;
+}
+
+static void
+build_sinc_kernel (std::vector<float>& kernel, int taps, double beta)
+{
+	int const half = taps / 2;
+
+	kernel.resize ((kernel_phases + 1) * taps);
+
+	for (int p = 0; p <= kernel_phases; ++p) {
+
+		double const frac = (double) p / kernel_phases;
+		std::vector<double> w (taps);
+		double sum = 0;
+
+		for (int i = 0; i < taps; ++i) {
+
+			/* distance from the interpolated point of the input sample for tap i */
+			double const u = (i - half + 1) - frac;
+
+			if (u == 0) {
+				w[i] = 1.0;
+			} else if (u == floor (u)) {
+				/* sinc is zero at whole samples, so that at a whole-sample
+				   position the input passes straight through.
+				*/
+				w[i] = 0.0;
+			} else {
+				double const x = u / half;
+				double const window = bessel_i0 (beta * sqrt (std::max (0.0, 1.0 - x * x))) / bessel_i0 (beta);
+				w[i] = window * sin (M_PI * u) / (M_PI * u);
+			}
+
+			sum += w[i];
+		}
+
+		/* unity gain at DC for every phase */
+		for (int i = 0; i < taps; ++i) {
+			kernel[p * taps + i] = w[i] / sum;
+		}
+	}
+}
+
+/** @return the windowed-sinc kernel table for @param taps (16 or 64), building it
+ *  the first time it is asked for.
+ */
+float const *
+VarispeedInterpolation::sinc_kernel (int taps)
+{
+	static std::vector<float> kernel_16;
+	static std::vector<float> kernel_64;
+
+	if (taps == 16) {
+		if (kernel_16.empty ()) {
+			build_sinc_kernel (kernel_16, 16, 6.0);
+		}
+		return &kernel_16[0];
+	}
+
+	if (kernel_64.empty ()) {
+		build_sinc_kernel (kernel_64, 64, 10.0);
+	}
+	return &kernel_64[0];
+}
+
+VarispeedInterpolation::VarispeedInterpolation ()
+	: _quality (VarispeedCubic)
+	, _taps (4)
+	, _kernel (0)
+{
+	/* build the tables now, so that set_quality() is safe in a process thread */
+	sinc_kernel (16);
+	sinc_kernel (64);
+}
+
+void
+VarispeedInterpolation::set_quality (VarispeedQuality q)
+{
+	_quality = q;
+
+	switch (q) {
+	case VarispeedLinear:
+		_taps = 2;
+		_kernel = 0;
+		break;
+	case VarispeedCubic:
+		_taps = 4;
+		_kernel = 0;
+		break;
+	case VarispeedSinc16:
+		_taps = 16;
+		_kernel = sinc_kernel (16);
+		break;
+	case VarispeedSinc64:
+		_taps = 64;
+		_kernel = sinc_kernel (64);
+		break;
+	}
+}
+
+void
+VarispeedInterpolation::add_channel_to (int input_buffer_size, int output_buffer_size)
+{
+	Interpolation::add_channel_to (input_buffer_size, output_buffer_size);
+
+	Channel c;
+	c.primed = false;
+	c.owed = 0;
+	_channels.push_back (c);
+}
+
+void
+VarispeedInterpolation::remove_channel_from ()
+{
+	Interpolation::remove_channel_from ();
+	_channels.pop_back ();
+}
+
+void
+VarispeedInterpolation::reset ()
+{
+	Interpolation::reset ();
+
+	for (std::vector<Channel>::iterator i = _channels.begin(); i != _channels.end(); ++i) {
+		i->primed = false;
+		i->owed = 0;
+	}
+}
+
+/** @return the speed to add to the next block of @param nframes on
+ *  @param chan to make up what earlier glides left owing.
+ */
+double
+VarispeedInterpolation::catch_up_speed (Channel const & chan, framecnt_t nframes) const
+{
+	if (nframes == 0) {
+		return 0;
+	}
+
+	double const limit = 0.5 * std::min (_speed, _target_speed);
+	return std::max (-limit, std::min (limit, chan.owed / nframes));
+}
+
+framecnt_t
+VarispeedInterpolation::input_needed (framecnt_t nframes) const
+{
+	double const catch_up = _channels.empty() ? 0 : catch_up_speed (_channels.front(), nframes);
+	double const fastest = std::max (_speed, _target_speed) + catch_up;
+	return (framecnt_t) ceil (nframes * fastest) + 2 + lookahead ();
+}
+
+static inline float
+dot (Sample const * x, float const * w, int n)
+{
+	/* with -ffast-math the compiler vectorises this */
+	float sum = 0;
+	for (int i = 0; i < n; ++i) {
+		sum += x[i] * w[i];
+	}
+	return sum;
+}
+
+framecnt_t
+VarispeedInterpolation::interpolate (int channel, framecnt_t nframes, Sample* input, Sample* output)
+{
+	/* The speed glides linearly from _speed at the start of the block to
+	   _target_speed at its end, so it never leaves the range between them
+	   and the read position never turns back.  That moves a different
+	   distance from the session, which runs at _target_speed throughout,
+	   so the difference is owed, and made up by running later blocks a
+	   little faster or slower: by no more than half the slower of the two
+	   speeds, for the same reason.
+	
+	   Output sample k is taken from input position
+	
+	       phase + k * (v0 + k * (v1 - v0) / (2 * nframes))
+	
+	   where v0 and v1 are the speeds at each end including any catching up.
+	   This is computed afresh for each k, rather than accumulated, so that
+	   rounding errors do not build up and every channel, and every call
+	   without buffers, agrees on the distance moved.
+	*/
+
+	Channel& chan (_channels[channel]);
+	Sample* const edge = chan.edge;
+
+	double const start = phase[channel];
+	double const catch_up = catch_up_speed (chan, nframes);
+	double const v0 = _speed + catch_up;
+	double const v1 = _target_speed + catch_up;
+	double const accel = nframes ? (v1 - v0) / (2.0 * nframes) : 0;
+	double const moved = nframes * (v0 + v1) / 2.0;
+	double const distance = start + moved;
+	framecnt_t const consumed = (framecnt_t) floor (distance);
+
+	chan.owed += nframes * _target_speed - moved;
+
+	if (!input || !output) {
+		/* keep in step with the calls which do have buffers; we don't
+		   know what was skipped, so the next block follows silence.
+		*/
+		for (int i = 0; i < max_taps; ++i) {
+			edge[i] = 0;
+		}
+		chan.primed = true;
+		phase[channel] = distance - consumed;
+		return consumed;
+	}
+
+	int const taps = _taps;
+	int const half = taps / 2;
+
+	if (!chan.primed) {
+		/* nothing came before this block: pretend it was more of the same */
+		for (int i = 0; i < max_taps; ++i) {
+			edge[i] = input[0];
+		}
+		chan.primed = true;
+	}
+
+	/* Outputs whose taps reach back before input[0] read from the edge
+	   buffer instead, which has the history followed by the start of
+	   this block; those can use no more than max_taps of it.
+	*/
+
+	framecnt_t const available = consumed + half + 1;
+
+	for (int i = 0; i < max_taps; ++i) {
+		edge[max_taps + i] = (i < available) ? input[i] : 0;
+	}
+
+	/* Work in chunks: first find where each output comes from, then
+	   interpolate them all with a loop that does nothing else.
+	*/
+
+	int const chunk_size = 64;
+	Sample const * from[chunk_size];
+	float frac[chunk_size];
+
+	for (framecnt_t done = 0; done < nframes; done += chunk_size) {
+
+		int const n = std::min ((framecnt_t) chunk_size, nframes - done);
+
+		for (int k = 0; k < n; ++k) {
+			double const kk = done + k;
+			double const p = start + kk * (v0 + kk * accel);
+			framecnt_t const i = (framecnt_t) floor (p);
+			framecnt_t const first = i - half + 1;
+
+			frac[k] = p - i;
+			from[k] = (first >= 0) ? input + first : edge + max_taps + first;
+		}
+
+		Sample* const out = output + done;
+
+		switch (_quality) {
+		case VarispeedLinear:
+			for (int k = 0; k < n; ++k) {
+				Sample const * x = from[k];
+				out[k] = x[0] + frac[k] * (x[1] - x[0]);
+			}
+			break;
+
+		case VarispeedCubic:
+			/* Catmull-Rom, as in CubicInterpolation */
+			for (int k = 0; k < n; ++k) {
+				Sample const * x = from[k];
+				float const f = frac[k];
+				out[k] = x[1] + 0.5f * f * (x[2] - x[0] +
+				         f * (4.0f * x[2] + 2.0f * x[0] - 5.0f * x[1] - x[3] +
+				         f * (3.0f * (x[1] - x[2]) - x[0] + x[3])));
+			}
+			break;
+
+		case VarispeedSinc16:
+		case VarispeedSinc64:
+			for (int k = 0; k < n; ++k) {
+				float const pf = frac[k] * kernel_phases;
+				int const row = std::min ((int) pf, kernel_phases - 1);
+				float const g = pf - row;
+				float const * w = _kernel + row * taps;
+				float const a = dot (from[k], w, taps);
+				float const b = dot (from[k], w + taps, taps);
+				out[k] = a + g * (b - a);
+			}
+			break;
+		}
+	}
+
+	/* keep the last max_taps samples consumed for the next block, some of
+	   which may be from the history if we did not get far.
+	*/
+
+	for (int i = 0; i < max_taps; ++i) {
+		framecnt_t const j = consumed - max_taps + i;
+		edge[i] = (j >= 0) ? input[j] : edge[max_taps + j];
+	}
+
+	phase[channel] = distance - consumed;
+
+	return consumed;
+}
+
 framecnt_t
 CubicMidiInterpolation::distance (framecnt_t nframes, bool roll)
 {
@@ -238,16 +238,16 @@ MidiRingBuffer<T>::dump(ostream& str)
 	Evoral::EventType ev_type;
 	uint32_t          ev_size;
 
-	RingBufferNPT<uint8_t>::rw_vector vec;
-	RingBufferNPT<uint8_t>::get_read_vector (&vec);
+	SPSCRingBuffer<uint8_t>::rw_vector vec;
+	SPSCRingBuffer<uint8_t>::get_read_vector (&vec);
 
 	if (vec.len[0] == 0) {
 		return;
 	}
 
 	str << this << ": Dump size = " << vec.len[0] + vec.len[1]
-	    << " r@ " << RingBufferNPT<uint8_t>::get_read_ptr()
-	    << " w@" << RingBufferNPT<uint8_t>::get_write_ptr() << endl;
+	    << " r@ " << SPSCRingBuffer<uint8_t>::get_read_ptr()
+	    << " w@" << SPSCRingBuffer<uint8_t>::get_write_ptr() << endl;
 
 
 	uint8_t *buf = new uint8_t[vec.len[0] + vec.len[1]];
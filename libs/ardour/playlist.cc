@@ -33,6 +33,7 @@
 #include "ardour/session.h"
 #include "ardour/region.h"
 #include "ardour/region_factory.h"
+#include "ardour/region_index.h"
 #include "ardour/region_sorters.h"
 #include "ardour/playlist_factory.h"
 #include "ardour/playlist_source.h"
@@ -301,6 +302,8 @@ Playlist::init (bool hide)
 
 	g_atomic_int_set (&block_notifications, 0);
 	g_atomic_int_set (&ignore_state_changes, 0);
+	g_atomic_int_set (&_region_generation, 0);
+	_region_index_generation = 0;
 	pending_contents_change = false;
 	pending_layering = false;
 	first_set_state = true;
@@ -318,6 +321,13 @@ Playlist::init (bool hide)
 	subcnt = 0;
 	_frozen = false;
 	_capture_insertion_underway = false;
+	_batch_depth = 0;
+	_batch_needs_sort = false;
+	_relayer_start = max_framepos;
+	_relayer_end = 0;
+	_relayer_all = true;
+	_relayer_renumber = false;
+	_relayer_model = Config->get_layer_model ();
 	_combine_ops = 0;
 	_end_space = 0;
 
@@ -400,6 +410,8 @@ void
 Playlist::begin_undo ()
 {
 	in_undo = true;
+	/* undo sets layers and layering indices directly, so don't trust them */
+	_relayer_all = true;
 	freeze ();
 }
 
@@ -425,6 +437,49 @@ Playlist::thaw (bool from_undo)
 	release_notifications (from_undo);
 }
 
+void
+Playlist::begin_batch ()
+{
+	if (_batch_depth++ == 0) {
+		clear_changes ();
+		clear_owned_changes ();
+	}
+
+	freeze ();
+}
+
+void
+Playlist::commit_batch (vector<Command*>* cmds)
+{
+	assert (_batch_depth > 0);
+
+	if (--_batch_depth > 0) {
+		thaw ();
+		return;
+	}
+
+	{
+		RegionWriteLock rlock (this, false);
+
+		if (_batch_needs_sort) {
+			regions.sort (RegionSortByPosition ());
+			_batch_needs_sort = false;
+		}
+
+		apply_batch_layering ();
+	}
+
+	/* this relayers and emits signals for the whole batch */
+	thaw ();
+
+	if (cmds) {
+		rdiff (*cmds);
+		if (changed ()) {
+			cmds->push_back (new StatefulDiffCommand (shared_from_this ()));
+		}
+	}
+}
+
 
 void
 Playlist::delay_notifications ()
@@ -591,21 +646,12 @@ Playlist::flush_notifications (bool from_undo)
 	// RegionSortByLayer cmp;
 	// pending_bounds.sort (cmp);
 
-	list<Evoral::Range<framepos_t> > crossfade_ranges;
-
-	for (RegionList::iterator r = pending_bounds.begin(); r != pending_bounds.end(); ++r) {
-		crossfade_ranges.push_back ((*r)->last_range ());
-		crossfade_ranges.push_back ((*r)->range ());
-	}
-
 	for (s = pending_removes.begin(); s != pending_removes.end(); ++s) {
-		crossfade_ranges.push_back ((*s)->range ());
 		remove_dependents (*s);
 		RegionRemoved (boost::weak_ptr<Region> (*s)); /* EMIT SIGNAL */
 	}
 	
 	for (s = pending_adds.begin(); s != pending_adds.end(); ++s) {
-		crossfade_ranges.push_back ((*s)->range ());
 		/* don't emit RegionAdded signal until relayering is done,
 		   so that the region is fully setup by the time
 		   anyone hears that its been added
@@ -630,12 +676,7 @@ Playlist::flush_notifications (bool from_undo)
 		relayer ();
 	}
 	
-	coalesce_and_check_crossfades (crossfade_ranges);
-	
 	if (!pending_range_moves.empty ()) {
-		/* We don't need to check crossfades for these as pending_bounds has
-		   already covered it.
-		*/
 		RangesMoved (pending_range_moves, from_undo);
 	}
 	
@@ -749,8 +790,16 @@ Playlist::flush_notifications (bool from_undo)
 
 	 region->set_position (position);
 
-	 regions.insert (upper_bound (regions.begin(), regions.end(), region, cmp), region);
+	 if (_batch_depth) {
+		 /* sorted on commit */
+		 regions.push_back (region);
+		 _batch_needs_sort = true;
+	 } else {
+		 regions.insert (upper_bound (regions.begin(), regions.end(), region, cmp), region);
+	 }
 	 all_regions.insert (region);
+	 invalidate_region_caches ();
+	 note_relayer_region (region);
 
 	 possibly_splice_unlocked (position, region->length(), region);
 
@@ -811,6 +860,11 @@ Playlist::flush_notifications (bool from_undo)
 			 framecnt_t distance = (*i)->length();
 
 			 regions.erase (i);
+			 invalidate_region_caches ();
+
+			 note_relayer_region (region);
+			 _layered_extents.erase (region.get ());
+			 _relayer_renumber = true;
 
 			 possibly_splice_unlocked (pos, -distance);
 
@@ -1533,7 +1587,13 @@ Playlist::region_bounds_changed (const PropertyChange& what_changed, boost::shar
 		 return;
 	 }
 
-	 if (what_changed.contains (Properties::position)) {
+	 if (what_changed.contains (Properties::position) && _batch_depth) {
+
+		 /* the list will be sorted when the batch is committed */
+		 _batch_needs_sort = true;
+		 invalidate_region_caches ();
+
+	 } else if (what_changed.contains (Properties::position)) {
 
 		 /* remove it from the list then add it back in
 		    the right place again.
@@ -1553,6 +1613,7 @@ Playlist::region_bounds_changed (const PropertyChange& what_changed, boost::shar
 
 		 regions.erase (i);
 		 regions.insert (upper_bound (regions.begin(), regions.end(), region, cmp), region);
+		 invalidate_region_caches ();
 	 }
 
 	 if (what_changed.contains (Properties::position) || what_changed.contains (Properties::length)) {
@@ -1576,10 +1637,6 @@ Playlist::region_bounds_changed (const PropertyChange& what_changed, boost::shar
 		 } else {
 			 notify_contents_changed ();
 			 relayer ();
-			 list<Evoral::Range<framepos_t> > xf;
-			 xf.push_back (Evoral::Range<framepos_t> (region->last_range()));
-			 xf.push_back (Evoral::Range<framepos_t> (region->range()));
-			 coalesce_and_check_crossfades (xf);
 		 }
 	 }
  }
@@ -1593,6 +1650,11 @@ Playlist::region_bounds_changed (const PropertyChange& what_changed, boost::shar
 		 return;
 	 }
 
+	 if (what_changed.contains (Properties::position) || what_changed.contains (Properties::length)) {
+		 /* whatever else happens, the region's old and new extents will need relayering */
+		 note_relayer_region (region);
+	 }
+
 	 /* this makes a virtual call to the right kind of playlist ... */
 
 	 region_changed (what_changed, region);
@@ -1606,6 +1668,8 @@ Playlist::region_bounds_changed (const PropertyChange& what_changed, boost::shar
 	 PropertyChange pos_and_length;
 	 bool save = false;
 
+	 invalidate_region_caches ();
+
 	 if (in_set_state || in_flush) {
 		 return false;
 	 }
@@ -1653,6 +1717,8 @@ Playlist::region_bounds_changed (const PropertyChange& what_changed, boost::shar
 	 RegionWriteLock rl (this);
 	 regions.clear ();
 	 all_regions.clear ();
+	 _layered_extents.clear ();
+	 _relayer_all = true;
  }
 
  void
@@ -1680,6 +1746,8 @@ Playlist::region_bounds_changed (const PropertyChange& what_changed, boost::shar
 		 }
 
 		 regions.clear ();
+		 _layered_extents.clear ();
+		 _relayer_all = true;
 
 		 for (set<boost::shared_ptr<Region> >::iterator s = pending_removes.begin(); s != pending_removes.end(); ++s) {
 			 remove_dependents (*s);
@@ -1714,15 +1782,7 @@ Playlist::regions_at (framepos_t frame)
  Playlist::count_regions_at (framepos_t frame) const
  {
 	 RegionReadLock rlock (const_cast<Playlist*>(this));
-	 uint32_t cnt = 0;
-
-	 for (RegionList::const_iterator i = regions.begin(); i != regions.end(); ++i) {
-		 if ((*i)->covers (frame)) {
-			 cnt++;
-		 }
-	 }
-
-	 return cnt;
+	 return region_index()->count_at (frame);
  }
 
  boost::shared_ptr<Region>
@@ -1778,13 +1838,7 @@ Playlist::find_regions_at (framepos_t frame)
 	/* Caller must hold lock */
 	
 	boost::shared_ptr<RegionList> rlist (new RegionList);
-	
-	for (RegionList::iterator i = regions.begin(); i != regions.end(); ++i) {
-		if ((*i)->covers (frame)) {
-			rlist->push_back (*i);
-		}
-	}
-	
+	region_index()->at (frame, *rlist);
 	return rlist;
 }
 
@@ -1793,13 +1847,7 @@ Playlist::regions_with_start_within (Evoral::Range<framepos_t> range)
 {
 	RegionReadLock rlock (this);
 	boost::shared_ptr<RegionList> rlist (new RegionList);
-
-	for (RegionList::iterator i = regions.begin(); i != regions.end(); ++i) {
-		if ((*i)->first_frame() >= range.from && (*i)->first_frame() <= range.to) {
-			rlist->push_back (*i);
-		}
-	}
-
+	region_index()->with_start_within (range.from, range.to, *rlist);
 	return rlist;
 }
 
@@ -1808,13 +1856,7 @@ Playlist::regions_with_end_within (Evoral::Range<framepos_t> range)
 {
 	RegionReadLock rlock (this);
 	boost::shared_ptr<RegionList> rlist (new RegionList);
-
-	for (RegionList::iterator i = regions.begin(); i != regions.end(); ++i) {
-		if ((*i)->last_frame() >= range.from && (*i)->last_frame() <= range.to) {
-			rlist->push_back (*i);
-		}
-	}
-
+	region_index()->with_end_within (range.from, range.to, *rlist);
 	return rlist;
 }
 
@@ -1832,14 +1874,10 @@ Playlist::regions_touched (framepos_t start, framepos_t end)
 boost::shared_ptr<RegionList>
 Playlist::regions_touched_locked (framepos_t start, framepos_t end)
 {
+	/* Caller must hold lock */
+
 	boost::shared_ptr<RegionList> rlist (new RegionList);
-	
-	for (RegionList::iterator i = regions.begin(); i != regions.end(); ++i) {
-		if ((*i)->coverage (start, end) != Evoral::OverlapNone) {
-			rlist->push_back (*i);
-		}
-	}
-	
+	region_index()->touched (start, end, *rlist);
 	return rlist;
 }
 
@@ -1907,6 +1945,14 @@ boost::shared_ptr<Region>
 Playlist::find_next_region (framepos_t frame, RegionPoint point, int dir)
 {
 	RegionReadLock rlock (this);
+
+	if (point == Start) {
+		boost::shared_ptr<RegionIndex> index = region_index ();
+		if (index->in_position_order ()) {
+			return index->next_start (frame, dir == 1);
+		}
+	}
+
 	boost::shared_ptr<Region> ret;
 	framepos_t closest = max_framepos;
 	
@@ -2032,6 +2078,25 @@ Playlist::find_next_region (framepos_t frame, RegionPoint point, int dir)
  }
 
 
+ /** @return an index of the current region list, rebuilding it first if
+  *  the list or any region in it has changed since it was last built.
+  *  Caller must hold the region lock.
+  */
+ boost::shared_ptr<RegionIndex>
+ Playlist::region_index () const
+ {
+	 gint const generation = g_atomic_int_get (&_region_generation);
+
+	 Glib::Threads::Mutex::Lock lm (_region_index_lock);
+
+	 if (!_region_index || _region_index_generation != generation) {
+		 _region_index.reset (new RegionIndex (regions.begin(), regions.end()));
+		 _region_index_generation = generation;
+	 }
+
+	 return _region_index;
+ }
+
  /***********************************************************************/
 
 
@@ -2179,6 +2244,9 @@ Playlist::find_next_region (framepos_t frame, RegionPoint point, int dir)
 	in_set_state--;
 	first_set_state = false;
 
+	/* layers came from the XML; the next relayer() must look at all of them */
+	_relayer_all = true;
+
 	return ret;
 }
 
@@ -2335,6 +2403,16 @@ struct RelayerSort {
 void
 Playlist::set_layer (boost::shared_ptr<Region> region, double new_layer)
 {
+	if (_batch_depth && new_layer == DBL_MAX) {
+		/* adding regions puts each on top; rather than re-sort the whole
+		   list for each one, do them all at once when the batch is committed.
+		*/
+		_batch_top_regions.push_back (region);
+		return;
+	}
+
+	apply_batch_layering ();
+
 	/* Remove the layer we are setting from our region list, and sort it
 	*  using the layer indeces.
 	*/
@@ -2354,6 +2432,52 @@ Playlist::set_layer (boost::shared_ptr<Region> region, double new_layer)
 	
 	copy.insert (i, region);
 
+	setup_layering_indices (copy);
+	note_relayer_region (region);
+}
+
+/** Put the regions in _batch_top_regions on top of the others, in the
+ *  order in which they were asked for; the result is as if set_layer (r,
+ *  DBL_MAX) had been called for each in turn.
+ */
+void
+Playlist::apply_batch_layering ()
+{
+	if (_batch_top_regions.empty ()) {
+		return;
+	}
+
+	set<boost::shared_ptr<Region> > const top (_batch_top_regions.begin(), _batch_top_regions.end());
+	set<boost::shared_ptr<Region> > present;
+
+	RegionList copy;
+
+	for (RegionList::const_iterator i = regions.begin(); i != regions.end(); ++i) {
+		present.insert (*i);
+		if (top.find (*i) == top.end()) {
+			copy.push_back (*i);
+		}
+	}
+
+	copy.sort (RelayerSort ());
+
+	/* a region asked for more than once ends up where it was last put;
+	   regions removed since they were asked for are left out.
+	*/
+
+	RegionList on_top;
+	set<boost::shared_ptr<Region> > seen;
+
+	for (RegionList::reverse_iterator i = _batch_top_regions.rbegin(); i != _batch_top_regions.rend(); ++i) {
+		if (present.find (*i) != present.end() && seen.insert (*i).second) {
+			on_top.push_front (*i);
+			note_relayer_region (*i);
+		}
+	}
+
+	copy.splice (copy.end(), on_top);
+	_batch_top_regions.clear ();
+
 	setup_layering_indices (copy);
 }
 
@@ -2367,6 +2491,35 @@ Playlist::setup_layering_indices (RegionList const & regions)
 	}
 }
 
+/** Note that the layers of regions touching @param a to @param b
+ *  (inclusive, in either order) may need recomputing at the next relayer().
+ */
+void
+Playlist::note_relayer_range (framepos_t a, framepos_t b)
+{
+	_relayer_start = min (_relayer_start, min (a, b));
+	_relayer_end = max (_relayer_end, max (a, b));
+}
+
+/** Note that @param region has been added, removed, moved, trimmed or
+ *  re-ordered, so that both where it is now and where it was when its
+ *  layer was last computed need relayering.
+ */
+void
+Playlist::note_relayer_region (boost::shared_ptr<Region> region)
+{
+	/* Region::last_range() is no use here; it only reflects the most recent
+	   change, and may be stale if only the length changed.
+	*/
+	std::map<Region const *, std::pair<framepos_t, framepos_t> >::const_iterator i = _layered_extents.find (region.get ());
+
+	if (i != _layered_extents.end ()) {
+		note_relayer_range (i->second.first, i->second.second);
+	}
+
+	note_relayer_range (region->first_frame (), region->last_frame ());
+}
+
 struct LaterHigherSort {
 	bool operator () (boost::shared_ptr<Region> a, boost::shared_ptr<Region> b) {
 		return a->position() < b->position();
@@ -2385,6 +2538,63 @@ Playlist::relayer ()
 		return;
 	}
 
+	apply_batch_layering ();
+
+	LayerModel const model = Config->get_layer_model ();
+	bool const all = _relayer_all || model != _relayer_model;
+
+	/* A region's layer depends only on the regions which overlap it, and so
+	   on through their overlaps; so the only regions whose layers can have
+	   changed are those joined to the noted span by some chain of overlapping
+	   regions.  Widen the span until no region touching it reaches outside
+	   it, and relayer just the regions within.  Regions elsewhere keep the
+	   layers they were given last time.
+	*/
+
+	RegionList copy;
+
+	if (all) {
+		copy = regions.rlist ();
+		_layered_extents.clear ();
+	} else if (_relayer_start <= _relayer_end) {
+
+		boost::shared_ptr<RegionIndex> index = region_index ();
+
+		framepos_t from = _relayer_start;
+		framepos_t to = _relayer_end;
+
+		RegionList fringe;
+		index->touched (from, to, fringe);
+
+		while (!fringe.empty ()) {
+
+			framepos_t wider_from = from;
+			framepos_t wider_to = to;
+
+			for (RegionList::const_iterator i = fringe.begin(); i != fringe.end(); ++i) {
+				wider_from = min (wider_from, (*i)->first_frame ());
+				wider_to = max (wider_to, (*i)->last_frame ());
+			}
+
+			/* only the newly-covered ends can hold regions we have not seen */
+
+			fringe.clear ();
+
+			if (wider_from < from) {
+				index->touched (wider_from, from - 1, fringe);
+			}
+
+			if (wider_to > to) {
+				index->touched (to + 1, wider_to, fringe);
+			}
+
+			from = wider_from;
+			to = wider_to;
+		}
+
+		index->touched (from, to, copy);
+	}
+
 	/* Build up a new list of regions on each layer, stored in a set of lists
 	   each of which represent some period of time on some layer.  The idea
 	   is to avoid having to search the entire region list to establish whether
@@ -2393,10 +2603,10 @@ Playlist::relayer ()
 	/* how many pieces to divide this playlist's time up into */
 	int const divisions = 512;
 
-	/* find the start and end positions of the regions on this playlist */
+	/* find the start and end positions of the regions we are relayering */
 	framepos_t start = INT64_MAX;
 	framepos_t end = 0;
-	for (RegionList::const_iterator i = regions.begin(); i != regions.end(); ++i) {
+	for (RegionList::const_iterator i = copy.begin(); i != copy.end(); ++i) {
 		start = min (start, (*i)->position());
 		end = max (end, (*i)->position() + (*i)->length());
 	}
@@ -2408,8 +2618,7 @@ Playlist::relayer ()
 	layers.push_back (vector<RegionList> (divisions));
 
 	/* Sort our regions into layering index order (for manual layering) or position order (for later is higher)*/
-	RegionList copy = regions.rlist();
-	switch (Config->get_layer_model()) {
+	switch (model) {
 		case LaterHigher:
 			copy.sort (LaterHigherSort ());
 			break;
@@ -2484,8 +2693,12 @@ Playlist::relayer ()
 		}
 
 		(*i)->set_layer (j);
+		_layered_extents[i->get ()] = make_pair ((*i)->first_frame (), (*i)->last_frame ());
 	}
 
+	/* set_layer() sends no change signal */
+	invalidate_region_caches ();
+
 	/* It's a little tricky to know when we could avoid calling this; e.g. if we are
 	   relayering because we just removed the only region on the top layer, nothing will
 	   appear to have changed, but the StreamView must still sort itself out.  We could
@@ -2496,9 +2709,27 @@ Playlist::relayer ()
 
 	/* This relayer() may have been called as a result of a region removal, in which
 	   case we need to setup layering indices to account for the one that has just
-	   gone away.
+	   gone away.  With later-is-higher they must also follow any moves.
 	*/
-	setup_layering_indices (copy);
+	if (all) {
+		setup_layering_indices (copy);
+	} else if (model == LaterHigher) {
+		RegionList by_position = regions.rlist ();
+		if (!region_index()->in_position_order ()) {
+			by_position.sort (LaterHigherSort ());
+		}
+		setup_layering_indices (by_position);
+	} else if (_relayer_renumber) {
+		RegionList by_index = regions.rlist ();
+		by_index.sort (RelayerSort ());
+		setup_layering_indices (by_index);
+	}
+
+	_relayer_start = max_framepos;
+	_relayer_end = 0;
+	_relayer_all = false;
+	_relayer_renumber = false;
+	_relayer_model = model;
 }
 
 void
@@ -3219,37 +3450,6 @@ Playlist::set_orig_track_id (const PBD::ID& id)
 	_orig_track_id = id;
 }
 
-/** Take a list of ranges, coalesce any that can be coalesced, then call
- *  check_crossfades for each one.
- */
-void
-Playlist::coalesce_and_check_crossfades (list<Evoral::Range<framepos_t> > ranges)
-{
-	/* XXX: it's a shame that this coalesce algorithm also exists in
-	   TimeSelection::consolidate().
-	*/
-
-	/* XXX: xfade: this is implemented in Evoral::RangeList */
-
-restart:
-	for (list<Evoral::Range<framepos_t> >::iterator i = ranges.begin(); i != ranges.end(); ++i) {
-		for (list<Evoral::Range<framepos_t> >::iterator j = ranges.begin(); j != ranges.end(); ++j) {
-
-			if (i == j) {
-				continue;
-			}
-
-			// XXX i->from can be > i->to - is this right? coverage() will return OverlapNone in this case
-			if (Evoral::coverage (i->from, i->to, j->from, j->to) != Evoral::OverlapNone) {
-				i->from = min (i->from, j->from);
-				i->to = max (i->to, j->to);
-				ranges.erase (j);
-				goto restart;
-			}
-		}
-	}
-}
-
 void
 Playlist::set_capture_insertion_in_progress (bool yn)
 {
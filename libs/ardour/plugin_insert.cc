@@ -32,6 +32,7 @@
 #include "ardour/buffer_set.h"
 #include "ardour/debug.h"
 #include "ardour/event_type_map.h"
+#include "ardour/graph.h"
 #include "ardour/ladspa_plugin.h"
 #include "ardour/plugin.h"
 #include "ardour/plugin_insert.h"
@@ -52,6 +53,7 @@
 #include "ardour/audio_unit.h"
 #endif
 
+#include "ardour/rc_configuration.h"
 #include "ardour/session.h"
 #include "ardour/types.h"
 
@@ -112,8 +114,76 @@ PluginInsert::set_count (uint32_t num)
 	return true;
 }
 
+/** Runs one instance of a replicated plugin; see PluginInsert::connect_and_run() */
+class PluginInsert::ReplicaTask : public GraphSubTask
+{
+  public:
+	ReplicaTask (boost::shared_ptr<Plugin> p)
+		: plugin (p)
+		, bufs (0)
+		, nframes (0)
+		, offset (0)
+	{}
+
+	void run () {
+		plugin->connect_and_run (*bufs, in_map, out_map, nframes, offset);
+	}
+
+	boost::shared_ptr<Plugin> plugin;
+	ChanMapping in_map;
+	ChanMapping out_map;
+	BufferSet* bufs;
+	pframes_t nframes;
+	framecnt_t offset;
+};
+
 PluginInsert::~PluginInsert ()
 {
+	drop_replica_tasks ();
+}
+
+void
+PluginInsert::drop_replica_tasks ()
+{
+	for (std::vector<ReplicaTask*>::iterator i = _replica_tasks.begin(); i != _replica_tasks.end(); ++i) {
+		delete *i;
+	}
+	_replica_tasks.clear ();
+	_replica_subtasks.clear ();
+}
+
+/** (Re)create our ReplicaTasks to match _plugins; called from configure_io(),
+ *  so never concurrently with connect_and_run().
+ */
+void
+PluginInsert::setup_replica_tasks ()
+{
+	drop_replica_tasks ();
+
+	if (_plugins.size() < 2) {
+		return;
+	}
+
+	for (Plugins::iterator i = _plugins.begin(); i != _plugins.end(); ++i) {
+		ReplicaTask* t = new ReplicaTask (*i);
+		_replica_tasks.push_back (t);
+		_replica_subtasks.push_back (t);
+	}
+}
+
+/** @return true if our plugin instances should be shared out amongst the
+ *  process graph's threads for this cycle.
+ */
+bool
+PluginInsert::run_replicas_in_parallel () const
+{
+	if (_replica_tasks.size() < 2 || !Config->get_parallel_plugin_replicas()) {
+		return false;
+	}
+
+	Graph* graph = _session.process_graph ();
+
+	return graph && graph->in_graph_thread ();
 }
 
 void
@@ -402,11 +472,34 @@ PluginInsert::connect_and_run (BufferSet& bufs, pframes_t nframes, framecnt_t of
 
 	}
 
-	for (Plugins::iterator i = _plugins.begin(); i != _plugins.end(); ++i) {
-		(*i)->connect_and_run(bufs, in_map, out_map, nframes, offset);
-		for (DataType::iterator t = DataType::begin(); t != DataType::end(); ++t) {
-			in_map.offset_to(*t, natural_input_streams().get(*t));
-			out_map.offset_to(*t, natural_output_streams().get(*t));
+	if (run_replicas_in_parallel ()) {
+
+		/* Replicated instances each work on their own channels, so
+		   they can run at the same time on different threads.
+		*/
+
+		for (std::vector<ReplicaTask*>::iterator i = _replica_tasks.begin(); i != _replica_tasks.end(); ++i) {
+			(*i)->in_map = in_map;
+			(*i)->out_map = out_map;
+			(*i)->bufs = &bufs;
+			(*i)->nframes = nframes;
+			(*i)->offset = offset;
+			for (DataType::iterator t = DataType::begin(); t != DataType::end(); ++t) {
+				in_map.offset_to(*t, natural_input_streams().get(*t));
+				out_map.offset_to(*t, natural_output_streams().get(*t));
+			}
+		}
+
+		_session.process_graph()->process_subtasks (&_replica_subtasks[0], _replica_subtasks.size());
+
+	} else {
+
+		for (Plugins::iterator i = _plugins.begin(); i != _plugins.end(); ++i) {
+			(*i)->connect_and_run(bufs, in_map, out_map, nframes, offset);
+			for (DataType::iterator t = DataType::begin(); t != DataType::end(); ++t) {
+				in_map.offset_to(*t, natural_input_streams().get(*t));
+				out_map.offset_to(*t, natural_output_streams().get(*t));
+			}
 		}
 	}
 
@@ -721,6 +814,8 @@ PluginInsert::configure_io (ChanCount in, ChanCount out)
 		return false;
 	}
 
+	setup_replica_tasks ();
+
 	if (  (old_match.method != _match.method && (old_match.method == Split || _match.method == Split))
 			|| old_in != in
 			|| old_out != out
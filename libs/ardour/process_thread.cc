@@ -200,3 +200,15 @@ ProcessThread::pan_automation_buffer()
         assert (p);
         return p;
 }
+
+DSPProfiler::Timings*
+ProcessThread::dsp_timings ()
+{
+	ThreadBuffers* tb = _private_thread_buffers.get();
+
+	if (!tb) {
+		return 0;
+	}
+
+	return tb->dsp_timings;
+}
@@ -27,6 +27,7 @@
 
 #include "ardour/automatable.h"
 #include "ardour/chan_count.h"
+#include "ardour/dsp_profiler.h"
 #include "ardour/processor.h"
 #include "ardour/types.h"
 
@@ -68,6 +69,11 @@ Processor::Processor(Session& session, const string& name)
 {
 }
 
+Processor::~Processor ()
+{
+	DSPProfiler::forget (this);
+}
+
 Processor::Processor (const Processor& other)
 	: Evoral::ControlSet (other)
 	, SessionObject (other.session(), other.name())
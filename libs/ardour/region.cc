@@ -1316,6 +1316,16 @@ Region::send_change (const PropertyChange& what_changed)
 
 	Stateful::send_change (what_changed);
 
+	{
+		/* our playlist's caches must notice this now, even if the
+		   change itself is not being announced until we thaw.
+		*/
+		boost::shared_ptr<Playlist> pl (_playlist.lock ());
+		if (pl) {
+			pl->invalidate_region_caches ();
+		}
+	}
+
 	if (!Stateful::property_changes_suspended()) {
 
 		/* Try and send a shared_pointer unless this is part of the constructor.
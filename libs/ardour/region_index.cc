@@ -0,0 +1,313 @@
+/*
+    Copyright (C) 2015 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#include <algorithm>
+
+#include "ardour/region.h"
+#include "ardour/region_index.h"
+
+using namespace std;
+using namespace ARDOUR;
+
+/* The tree is implicit in the sorted vector: leaves sit at even indices,
+   and a node at level k sits at an index whose lowest k bits are all set,
+   with its children x = 2^(k-1) either side of it.  This is the layout
+   used by Heng Li's cgranges.
+*/
+
+RegionIndex::RegionIndex (RegionList::const_iterator begin, RegionList::const_iterator end)
+	: _max_level (-1)
+	, _in_position_order (true)
+{
+	uint32_t n = 0;
+
+	for (RegionList::const_iterator i = begin; i != end; ++i, ++n) {
+		Entry e;
+		e.start = (*i)->first_frame ();
+		e.end = (*i)->last_frame ();
+		e.max_end = e.end;
+		e.order = n;
+		e.region = i->get ();
+
+		if (!_entries.empty() && e.start < _entries.back().start) {
+			_in_position_order = false;
+		}
+
+		_entries.push_back (e);
+	}
+
+	if (!_in_position_order) {
+		sort (_entries.begin(), _entries.end(), EntrySorter ());
+	}
+
+	build_tree ();
+}
+
+void
+RegionIndex::build_tree ()
+{
+	size_t const n = _entries.size ();
+
+	if (n == 0) {
+		return;
+	}
+
+	size_t last_i = 0;
+	framepos_t last = 0;
+
+	for (size_t i = 0; i < n; i += 2) {
+		last_i = i;
+		last = _entries[i].max_end = _entries[i].end;
+	}
+
+	int k;
+
+	for (k = 1; ((size_t) 1 << k) <= n; ++k) {
+
+		size_t const x = (size_t) 1 << (k - 1);
+		size_t const step = x << 2;
+
+		for (size_t i = (x << 1) - 1; i < n; i += step) {
+			framepos_t const el = _entries[i - x].max_end;
+			framepos_t const er = (i + x < n) ? _entries[i + x].max_end : last;
+			_entries[i].max_end = max (_entries[i].end, max (el, er));
+		}
+
+		/* move last_i up to its parent; the parent may lie beyond the
+		   end of the vector, in which case `last' carries its value.
+		*/
+
+		last_i = ((last_i >> k) & 1) ? last_i - x : last_i + x;
+
+		if (last_i < n && _entries[last_i].max_end > last) {
+			last = _entries[last_i].max_end;
+		}
+	}
+
+	_max_level = k - 1;
+}
+
+/** Collect the indices of all entries overlapping @param start to
+ *  @param end (inclusive) in @param hits, in sort order.
+ */
+void
+RegionIndex::overlapping (framepos_t start, framepos_t end, std::vector<size_t>& hits) const
+{
+	if (_entries.empty() || start > end) {
+		return;
+	}
+
+	struct Node {
+		int    level;
+		size_t index;
+		bool   left_done;
+	};
+
+	size_t const n = _entries.size ();
+	Node stack[64];
+	int t = 0;
+
+	stack[t].level = _max_level;
+	stack[t].index = ((size_t) 1 << _max_level) - 1;
+	stack[t].left_done = false;
+	++t;
+
+	while (t) {
+
+		Node const z = stack[--t];
+
+		if (z.level <= 3) {
+
+			/* small subtree: scan it */
+
+			size_t const i0 = (z.index >> z.level) << z.level;
+			size_t const i1 = min (i0 + ((size_t) 1 << (z.level + 1)) - 1, n);
+
+			for (size_t i = i0; i < i1 && _entries[i].start <= end; ++i) {
+				Entry const & e (_entries[i]);
+				/* zero-length regions have end < start, and never overlap */
+				if (start <= e.end && e.start <= e.end) {
+					hits.push_back (i);
+				}
+			}
+
+		} else if (!z.left_done) {
+
+			size_t const y = z.index - ((size_t) 1 << (z.level - 1));
+
+			stack[t] = z;
+			stack[t].left_done = true;
+			++t;
+
+			if (y >= n || _entries[y].max_end >= start) {
+				stack[t].level = z.level - 1;
+				stack[t].index = y;
+				stack[t].left_done = false;
+				++t;
+			}
+
+		} else if (z.index < n && _entries[z.index].start <= end) {
+
+			Entry const & e (_entries[z.index]);
+
+			if (start <= e.end && e.start <= e.end) {
+				hits.push_back (z.index);
+			}
+
+			stack[t].level = z.level - 1;
+			stack[t].index = z.index + ((size_t) 1 << (z.level - 1));
+			stack[t].left_done = false;
+			++t;
+		}
+	}
+}
+
+/** Append the regions of the entries in @param hits to @param result,
+ *  in list order.
+ */
+void
+RegionIndex::append (std::vector<size_t>& hits, RegionList& result) const
+{
+	if (_in_position_order) {
+		/* sort order is list order */
+		sort (hits.begin(), hits.end());
+		for (std::vector<size_t>::const_iterator i = hits.begin(); i != hits.end(); ++i) {
+			result.push_back (_entries[*i].region->shared_from_this ());
+		}
+		return;
+	}
+
+	std::vector<std::pair<uint32_t, size_t> > by_order;
+	by_order.reserve (hits.size ());
+
+	for (std::vector<size_t>::const_iterator i = hits.begin(); i != hits.end(); ++i) {
+		by_order.push_back (make_pair (_entries[*i].order, *i));
+	}
+
+	sort (by_order.begin(), by_order.end());
+
+	for (std::vector<std::pair<uint32_t, size_t> >::const_iterator i = by_order.begin(); i != by_order.end(); ++i) {
+		result.push_back (_entries[i->second].region->shared_from_this ());
+	}
+}
+
+void
+RegionIndex::at (framepos_t frame, RegionList& result) const
+{
+	touched (frame, frame, result);
+}
+
+uint32_t
+RegionIndex::count_at (framepos_t frame) const
+{
+	std::vector<size_t> hits;
+	overlapping (frame, frame, hits);
+	return hits.size ();
+}
+
+void
+RegionIndex::touched (framepos_t start, framepos_t end, RegionList& result) const
+{
+	std::vector<size_t> hits;
+	overlapping (start, end, hits);
+	append (hits, result);
+}
+
+void
+RegionIndex::with_start_within (framepos_t start, framepos_t end, RegionList& result) const
+{
+	Entry key;
+	key.start = start;
+	key.order = 0;
+
+	std::vector<size_t> hits;
+
+	for (std::vector<Entry>::const_iterator i = lower_bound (_entries.begin(), _entries.end(), key, EntrySorter ());
+	     i != _entries.end() && i->start <= end; ++i) {
+		hits.push_back (i - _entries.begin());
+	}
+
+	append (hits, result);
+}
+
+void
+RegionIndex::with_end_within (framepos_t start, framepos_t end, RegionList& result) const
+{
+	/* a region which ends within the range must also start before its
+	   end, so it is among those which touch it; zero-length ones aside.
+	*/
+
+	std::vector<size_t> hits;
+
+	if (start <= end) {
+
+		std::vector<size_t> touching;
+		overlapping (start, end, touching);
+
+		for (std::vector<size_t>::const_iterator i = touching.begin(); i != touching.end(); ++i) {
+			if (_entries[*i].end <= end) {
+				hits.push_back (*i);
+			}
+		}
+
+		/* zero-length regions are never found by overlapping(); their
+		   last frame is one before their first, so look for them among
+		   those starting just inside or just after the range.
+		*/
+
+		Entry key;
+		key.start = start + 1;
+		key.order = 0;
+
+		for (std::vector<Entry>::const_iterator i = lower_bound (_entries.begin(), _entries.end(), key, EntrySorter ());
+		     i != _entries.end() && i->start <= end + 1; ++i) {
+			if (i->end < i->start && i->end >= start && i->end <= end) {
+				hits.push_back (i - _entries.begin());
+			}
+		}
+	}
+
+	append (hits, result);
+}
+
+boost::shared_ptr<Region>
+RegionIndex::next_start (framepos_t frame, bool forwards) const
+{
+	Entry key;
+	key.order = 0;
+
+	if (forwards) {
+		key.start = frame + 1;
+		std::vector<Entry>::const_iterator i = lower_bound (_entries.begin(), _entries.end(), key, EntrySorter ());
+		if (i == _entries.end()) {
+			return boost::shared_ptr<Region> ();
+		}
+		return i->region->shared_from_this ();
+	}
+
+	key.start = frame;
+	std::vector<Entry>::const_iterator i = lower_bound (_entries.begin(), _entries.end(), key, EntrySorter ());
+
+	if (i == _entries.begin()) {
+		return boost::shared_ptr<Region> ();
+	}
+
+	key.start = (i - 1)->start;
+	return lower_bound (_entries.begin(), _entries.end(), key, EntrySorter ())->region->shared_from_this ();
+}
@@ -50,6 +50,7 @@
 #include "ardour/internal_send.h"
 #include "ardour/meter.h"
 #include "ardour/delayline.h"
+#include "ardour/dsp_profiler.h"
 #include "ardour/midi_buffer.h"
 #include "ardour/midi_port.h"
 #include "ardour/monitor_processor.h"
@@ -227,6 +228,8 @@ Route::~Route ()
 {
 	DEBUG_TRACE (DEBUG::Destruction, string_compose ("route %1 destructor\n", _name));
 
+	DSPProfiler::forget (this);
+
 	/* do this early so that we don't get incoming signals as we are going through destruction
 	 */
 
@@ -576,6 +579,8 @@ Route::process_output_buffers (BufferSet& bufs,
 
 	framecnt_t latency = 0;
 
+	DSPTimer route_timer (this);
+
 	for (ProcessorList::const_iterator i = _processors.begin(); i != _processors.end(); ++i) {
 
 		if (meter_already_run && boost::dynamic_pointer_cast<PeakMeter> (*i)) {
@@ -605,7 +610,10 @@ Route::process_output_buffers (BufferSet& bufs,
 			boost::dynamic_pointer_cast<Send>(*i)->set_delay_in(_signal_latency - latency);
 		}
 
-		(*i)->run (bufs, start_frame - latency, end_frame - latency, nframes, *i != _processors.back());
+		{
+			DSPTimer processor_timer (i->get ());
+			(*i)->run (bufs, start_frame - latency, end_frame - latency, nframes, *i != _processors.back());
+		}
 		bufs.set_count ((*i)->output_streams());
 
 		if ((*i)->active ()) {
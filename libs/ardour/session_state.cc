@@ -86,6 +86,7 @@
 #include "ardour/butler.h"
 #include "ardour/control_protocol_manager.h"
 #include "ardour/directory_names.h"
+#include "ardour/dsp_profiler.h"
 #include "ardour/filename_extensions.h"
 #include "ardour/graph.h"
 #include "ardour/location.h"
@@ -3665,6 +3666,8 @@ Session::config_changed (std::string p, bool ours)
 		ltc_tx_parse_offset();
 	} else if (p == "auto-return-target-list") {
 		follow_playhead_priority ();
+	} else if (p == "dsp-profiling") {
+		DSPProfiler::set_enabled (Config->get_dsp_profiling ());
 	}
 
 	set_dirty ();
@@ -62,6 +62,9 @@ SndFileSource::SndFileSource (Session& s, const XMLNode& node)
 	, AudioFileSource (s, node)
 	, _sndfile (0)
 	, _broadcast_info (0)
+	, _fd (-1)
+	, _frame_bytes (0)
+	, _header_bytes (0)
 	, _capture_start (false)
 	, _capture_end (false)
 	, file_pos (0)
@@ -86,6 +89,9 @@ SndFileSource::SndFileSource (Session& s, const string& path, int chn, Flag flag
 	, AudioFileSource (s, path, Flag (flags & ~(Writable|Removable|RemovableIfEmpty|RemoveAtDestroy)))
 	, _sndfile (0)
 	, _broadcast_info (0)
+	, _fd (-1)
+	, _frame_bytes (0)
+	, _header_bytes (0)
 	, _capture_start (false)
 	, _capture_end (false)
 	, file_pos (0)
@@ -112,6 +118,9 @@ SndFileSource::SndFileSource (Session& s, const string& path, const string& orig
 	, AudioFileSource (s, path, origin, flags, sfmt, hf)
 	, _sndfile (0)
 	, _broadcast_info (0)
+	, _fd (-1)
+	, _frame_bytes (0)
+	, _header_bytes (0)
 	, _capture_start (false)
 	, _capture_end (false)
 	, file_pos (0)
@@ -198,6 +207,9 @@ SndFileSource::SndFileSource (Session& s, const string& path, int chn)
 	, AudioFileSource (s, path, Flag (0))
 	, _sndfile (0)
 	, _broadcast_info (0)
+	, _fd (-1)
+	, _frame_bytes (0)
+	, _header_bytes (0)
 	, _capture_start (false)
 	, _capture_end (false)
 	, file_pos (0)
@@ -238,6 +250,7 @@ SndFileSource::close ()
 	if (_sndfile) {
 		sf_close (_sndfile);
 		_sndfile = 0;
+		_fd = -1;
 	}
 }
 
@@ -296,6 +309,41 @@ SndFileSource::open ()
 
 	_length = _info.frames;
 
+	_fd = fd;
+	_frame_bytes = 0;
+	_header_bytes = 0;
+
+	switch (_info.format & SF_FORMAT_SUBMASK) {
+	case SF_FORMAT_PCM_S8:
+	case SF_FORMAT_PCM_U8:
+		_frame_bytes = 1;
+		break;
+	case SF_FORMAT_PCM_16:
+		_frame_bytes = 2;
+		break;
+	case SF_FORMAT_PCM_24:
+		_frame_bytes = 3;
+		break;
+	case SF_FORMAT_PCM_32:
+	case SF_FORMAT_FLOAT:
+		_frame_bytes = 4;
+		break;
+	case SF_FORMAT_DOUBLE:
+		_frame_bytes = 8;
+		break;
+	default:
+		/* compressed; we can't tell where any given frame is */
+		break;
+	}
+
+	if (_frame_bytes) {
+		struct stat statbuf;
+		_frame_bytes *= _info.channels;
+		if (fstat (fd, &statbuf) == 0) {
+			_header_bytes = max ((off_t) 0, (off_t) (statbuf.st_size - _info.frames * _frame_bytes));
+		}
+	}
+
 	if (!_broadcast_info) {
 		_broadcast_info = new BroadcastInfo;
 	}
@@ -452,6 +500,65 @@ SndFileSource::read_unlocked (Sample *dst, framepos_t start, framecnt_t cnt) con
 	return nread;
 }
 
+bool
+SndFileSource::can_read_ahead () const
+{
+#if defined(POSIX_FADV_WILLNEED) || defined(F_RDADVISE)
+	return !writable();
+#else
+	return false;
+#endif
+}
+
+void
+SndFileSource::read_ahead_unlocked (framepos_t start, framecnt_t cnt) const
+{
+	int fd;
+	framecnt_t length;
+	off_t frame_bytes;
+	off_t header_bytes;
+
+	{
+		Glib::Threads::Mutex::Lock lm (_lock);
+
+		if (!_sndfile) {
+			return;
+		}
+
+		fd = _fd;
+		length = _length;
+		frame_bytes = _frame_bytes;
+		header_bytes = _header_bytes;
+	}
+
+	/* if the file is closed after this, the advice goes to a stale (or
+	   reused) descriptor, which is harmless.
+	*/
+
+	if (fd < 0 || frame_bytes == 0 || start >= length) {
+		return;
+	}
+
+	cnt = min (cnt, length - start);
+
+	/* we don't know exactly where the sample data starts, so cover
+	   everything from where it would be with no header to where it
+	   would be if all the non-sample bytes came first.
+	*/
+
+	off_t const offset = (off_t) start * frame_bytes;
+	off_t const len = (off_t) cnt * frame_bytes + header_bytes;
+
+#if defined(POSIX_FADV_WILLNEED)
+	posix_fadvise (fd, offset, len, POSIX_FADV_WILLNEED);
+#elif defined(F_RDADVISE)
+	struct radvisory ra;
+	ra.ra_offset = offset;
+	ra.ra_count = len;
+	fcntl (fd, F_RDADVISE, &ra);
+#endif
+}
+
 framecnt_t
 SndFileSource::write_unlocked (Sample *data, framecnt_t cnt)
 {
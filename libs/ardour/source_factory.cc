@@ -22,7 +22,10 @@
 #include "libardour-config.h"
 #endif
 
+#include <algorithm>
+
 #include "pbd/boost_debug.h"
+#include "pbd/cpus.h"
 #include "pbd/error.h"
 #include "pbd/convert.h"
 #include "pbd/pthread_utils.h"
@@ -50,10 +53,17 @@ using namespace std;
 using namespace PBD;
 
 PBD::Signal1<void,boost::shared_ptr<Source> > SourceFactory::SourceCreated;
+PBD::Signal2<void,uint32_t,uint32_t> SourceFactory::PeakBuildProgress;
 Glib::Threads::Cond SourceFactory::PeaksToBuild;
 Glib::Threads::Mutex SourceFactory::peak_building_lock;
 std::list<boost::weak_ptr<AudioSource> > SourceFactory::files_with_peaks;
 
+/* sources queued for peak building since the queue was last empty, and
+   how many of those have been dealt with; protected by peak_building_lock.
+*/
+static uint32_t peaks_queued = 0;
+static uint32_t peaks_done = 0;
+
 static void
 peak_thread_work ()
 {
@@ -61,33 +71,54 @@ peak_thread_work ()
 
 	while (true) {
 
-		SourceFactory::peak_building_lock.lock ();
+		boost::shared_ptr<AudioSource> as;
+
+		{
+			Glib::Threads::Mutex::Lock lm (SourceFactory::peak_building_lock);
+
+			while (SourceFactory::files_with_peaks.empty()) {
+				SourceFactory::PeaksToBuild.wait (SourceFactory::peak_building_lock);
+			}
 
-	  wait:
-		if (SourceFactory::files_with_peaks.empty()) {
-			SourceFactory::PeaksToBuild.wait (SourceFactory::peak_building_lock);
+			as = SourceFactory::files_with_peaks.front().lock();
+			SourceFactory::files_with_peaks.pop_front ();
 		}
 
-		if (SourceFactory::files_with_peaks.empty()) {
-			goto wait;
+		if (as) {
+			as->setup_peakfile ();
+			as.reset ();
 		}
 
-		boost::shared_ptr<AudioSource> as (SourceFactory::files_with_peaks.front().lock());
-		SourceFactory::files_with_peaks.pop_front ();
-		SourceFactory::peak_building_lock.unlock ();
+		uint32_t done;
+		uint32_t total;
 
-		if (!as) {
-			continue;
+		{
+			Glib::Threads::Mutex::Lock lm (SourceFactory::peak_building_lock);
+
+			done = ++peaks_done;
+			total = peaks_queued;
+
+			if (done == total) {
+				/* all done: start counting again next time */
+				peaks_done = 0;
+				peaks_queued = 0;
+			}
 		}
 
-		as->setup_peakfile ();
+		SourceFactory::PeakBuildProgress (done, total); /* EMIT SIGNAL */
 	}
 }
 
 void
 SourceFactory::init ()
 {
-	for (int n = 0; n < 2; ++n) {
+	/* each thread builds one source's peaks at a time, so use them all
+	   when a session with many missing peakfiles is loaded.
+	*/
+
+	uint32_t const n_threads = max (2U, hardware_concurrency ());
+
+	for (uint32_t n = 0; n < n_threads; ++n) {
 		Glib::Threads::Thread::create (sigc::ptr_fun (::peak_thread_work));
 	}
 }
@@ -103,7 +134,8 @@ SourceFactory::setup_peakfile (boost::shared_ptr<Source> s, bool async)
 
 			Glib::Threads::Mutex::Lock lm (peak_building_lock);
 			files_with_peaks.push_back (boost::weak_ptr<AudioSource> (as));
-			PeaksToBuild.broadcast ();
+			++peaks_queued;
+			PeaksToBuild.signal ();
 
 		} else {
 
@@ -0,0 +1,220 @@
+/*
+    Copyright (C) 2015 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+/* AVX-512 versions of the mix functions; this file is compiled with
+   -mavx512f, and must only be called once FPU::has_avx512f() says so.
+
+   Each loop works on 16 samples at a time and finishes off with a single
+   masked operation, rather than a scalar loop.  The mixes use fused
+   multiply-adds (every AVX-512 CPU has FMA), so like the FMA versions they
+   are not bit-identical to the others.
+*/
+
+#include <immintrin.h>
+#include <stdint.h>
+
+#include "ardour/mix.h"
+
+/** @return a mask selecting the first @param n (< 16) lanes */
+static inline __mmask16
+tail_mask (uint32_t n)
+{
+	return (__mmask16) ((1U << n) - 1);
+}
+
+float
+x86_avx512f_compute_peak (const float * buf, uint32_t nsamples, float current)
+{
+	const __m512 abs_mask = _mm512_castsi512_ps (_mm512_set1_epi32 (0x7fffffff));
+	__m512 vmax = _mm512_set1_ps (current);
+
+	while (nsamples >= 16) {
+		__m512 const x = _mm512_castsi512_ps (_mm512_and_epi32 (_mm512_castps_si512 (_mm512_loadu_ps (buf)), _mm512_castps_si512 (abs_mask)));
+		vmax = _mm512_max_ps (vmax, x);
+		buf += 16;
+		nsamples -= 16;
+	}
+
+	if (nsamples) {
+		/* lanes not loaded are zero, which cannot exceed an absolute value */
+		__m512 const x = _mm512_castsi512_ps (_mm512_and_epi32 (_mm512_castps_si512 (_mm512_maskz_loadu_ps (tail_mask (nsamples), buf)), _mm512_castps_si512 (abs_mask)));
+		vmax = _mm512_max_ps (vmax, x);
+	}
+
+	float tmp[16];
+	_mm512_storeu_ps (tmp, vmax);
+	_mm256_zeroupper ();
+
+	for (int i = 0; i < 16; ++i) {
+		current = current > tmp[i] ? current : tmp[i];
+	}
+
+	return current;
+}
+
+void
+x86_avx512f_find_peaks (const float * buf, uint32_t nframes, float *min, float *max)
+{
+	__m512 vmin = _mm512_set1_ps (*min);
+	__m512 vmax = _mm512_set1_ps (*max);
+
+	while (nframes >= 16) {
+		__m512 const x = _mm512_loadu_ps (buf);
+		vmin = _mm512_min_ps (vmin, x);
+		vmax = _mm512_max_ps (vmax, x);
+		buf += 16;
+		nframes -= 16;
+	}
+
+	if (nframes) {
+		__mmask16 const m = tail_mask (nframes);
+		__m512 const x = _mm512_maskz_loadu_ps (m, buf);
+		vmin = _mm512_mask_min_ps (vmin, m, vmin, x);
+		vmax = _mm512_mask_max_ps (vmax, m, vmax, x);
+	}
+
+	float tmin[16];
+	float tmax[16];
+	_mm512_storeu_ps (tmin, vmin);
+	_mm512_storeu_ps (tmax, vmax);
+	_mm256_zeroupper ();
+
+	float a = *max;
+	float b = *min;
+
+	for (int i = 0; i < 16; ++i) {
+		a = a > tmax[i] ? a : tmax[i];
+		b = b < tmin[i] ? b : tmin[i];
+	}
+
+	*max = a;
+	*min = b;
+}
+
+void
+x86_avx512f_apply_gain_to_buffer (float * buf, uint32_t nframes, float gain)
+{
+	__m512 const g = _mm512_set1_ps (gain);
+
+	while (nframes >= 16) {
+		_mm512_storeu_ps (buf, _mm512_mul_ps (_mm512_loadu_ps (buf), g));
+		buf += 16;
+		nframes -= 16;
+	}
+
+	if (nframes) {
+		__mmask16 const m = tail_mask (nframes);
+		_mm512_mask_storeu_ps (buf, m, _mm512_mul_ps (_mm512_maskz_loadu_ps (m, buf), g));
+	}
+
+	_mm256_zeroupper ();
+}
+
+void
+x86_avx512f_mix_buffers_with_gain (float * dst, const float * src, uint32_t nframes, float gain)
+{
+	__m512 const g = _mm512_set1_ps (gain);
+
+	while (nframes >= 16) {
+		_mm512_storeu_ps (dst, _mm512_fmadd_ps (_mm512_loadu_ps (src), g, _mm512_loadu_ps (dst)));
+		dst += 16;
+		src += 16;
+		nframes -= 16;
+	}
+
+	if (nframes) {
+		__mmask16 const m = tail_mask (nframes);
+		_mm512_mask_storeu_ps (dst, m, _mm512_fmadd_ps (_mm512_maskz_loadu_ps (m, src), g, _mm512_maskz_loadu_ps (m, dst)));
+	}
+
+	_mm256_zeroupper ();
+}
+
+void
+x86_avx512f_mix_buffers_no_gain (float * dst, const float * src, uint32_t nframes)
+{
+	while (nframes >= 16) {
+		_mm512_storeu_ps (dst, _mm512_add_ps (_mm512_loadu_ps (dst), _mm512_loadu_ps (src)));
+		dst += 16;
+		src += 16;
+		nframes -= 16;
+	}
+
+	if (nframes) {
+		__mmask16 const m = tail_mask (nframes);
+		_mm512_mask_storeu_ps (dst, m, _mm512_add_ps (_mm512_maskz_loadu_ps (m, dst), _mm512_maskz_loadu_ps (m, src)));
+	}
+
+	_mm256_zeroupper ();
+}
+
+void
+x86_avx512f_copy_vector (float * dst, const float * src, uint32_t nframes)
+{
+	while (nframes >= 16) {
+		_mm512_storeu_ps (dst, _mm512_loadu_ps (src));
+		dst += 16;
+		src += 16;
+		nframes -= 16;
+	}
+
+	if (nframes) {
+		__mmask16 const m = tail_mask (nframes);
+		_mm512_mask_storeu_ps (dst, m, _mm512_maskz_loadu_ps (m, src));
+	}
+
+	_mm256_zeroupper ();
+}
+
+void
+x86_avx512f_apply_gain_vector_to_buffer (float * buf, const float * gain, uint32_t nframes)
+{
+	while (nframes >= 16) {
+		_mm512_storeu_ps (buf, _mm512_mul_ps (_mm512_loadu_ps (buf), _mm512_loadu_ps (gain)));
+		buf += 16;
+		gain += 16;
+		nframes -= 16;
+	}
+
+	if (nframes) {
+		__mmask16 const m = tail_mask (nframes);
+		_mm512_mask_storeu_ps (buf, m, _mm512_mul_ps (_mm512_maskz_loadu_ps (m, buf), _mm512_maskz_loadu_ps (m, gain)));
+	}
+
+	_mm256_zeroupper ();
+}
+
+void
+x86_avx512f_mix_buffers_with_gain_vector (float * dst, const float * src, const float * gain, uint32_t nframes)
+{
+	while (nframes >= 16) {
+		_mm512_storeu_ps (dst, _mm512_fmadd_ps (_mm512_loadu_ps (src), _mm512_loadu_ps (gain), _mm512_loadu_ps (dst)));
+		dst += 16;
+		src += 16;
+		gain += 16;
+		nframes -= 16;
+	}
+
+	if (nframes) {
+		__mmask16 const m = tail_mask (nframes);
+		_mm512_mask_storeu_ps (dst, m, _mm512_fmadd_ps (_mm512_maskz_loadu_ps (m, src), _mm512_maskz_loadu_ps (m, gain), _mm512_maskz_loadu_ps (m, dst)));
+	}
+
+	_mm256_zeroupper ();
+}
@@ -17,40 +17,190 @@
 
 */
 
+#include <immintrin.h>
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
+
 #include "ardour/mix.h"
 
+/* AVX intrinsics versions of the mix functions; this file is compiled
+   with -mavx, and must only be called once FPU::has_avx() says so.  All
+   loads and stores are unaligned: on AVX hardware they cost the same as
+   aligned ones when the data is aligned, and they are correct when it is
+   not.
+*/
+
 float
 x86_sse_avx_compute_peak (const float * buf, uint32_t nsamples, float current)
 {
-	return default_compute_peak (buf, nsamples, current);
+	const __m256 abs_mask = _mm256_castsi256_ps (_mm256_set1_epi32 (0x7fffffff));
+	__m256 vmax = _mm256_set1_ps (current);
+
+	while (nsamples >= 8) {
+		vmax = _mm256_max_ps (vmax, _mm256_and_ps (_mm256_loadu_ps (buf), abs_mask));
+		buf += 8;
+		nsamples -= 8;
+	}
+
+	float tmp[8];
+	_mm256_storeu_ps (tmp, vmax);
+	_mm256_zeroupper ();
+
+	for (int i = 0; i < 8; ++i) {
+		current = std::max (current, tmp[i]);
+	}
+
+	while (nsamples > 0) {
+		current = std::max (current, fabsf (*buf));
+		++buf;
+		--nsamples;
+	}
+
+	return current;
+}
+
+void
+x86_sse_avx_find_peaks (const float * buf, uint32_t nframes, float *min, float *max)
+{
+	__m256 vmin = _mm256_set1_ps (*min);
+	__m256 vmax = _mm256_set1_ps (*max);
+
+	while (nframes >= 8) {
+		__m256 const x = _mm256_loadu_ps (buf);
+		vmin = _mm256_min_ps (vmin, x);
+		vmax = _mm256_max_ps (vmax, x);
+		buf += 8;
+		nframes -= 8;
+	}
+
+	float tmin[8];
+	float tmax[8];
+	_mm256_storeu_ps (tmin, vmin);
+	_mm256_storeu_ps (tmax, vmax);
+	_mm256_zeroupper ();
+
+	float a = *max;
+	float b = *min;
+
+	for (int i = 0; i < 8; ++i) {
+		a = std::max (a, tmax[i]);
+		b = std::min (b, tmin[i]);
+	}
+
+	while (nframes > 0) {
+		a = std::max (*buf, a);
+		b = std::min (*buf, b);
+		++buf;
+		--nframes;
+	}
+
+	*max = a;
+	*min = b;
 }
 
 void
 x86_sse_avx_apply_gain_to_buffer (float * buf, uint32_t nframes, float gain)
 {
-	default_apply_gain_to_buffer (buf, nframes, gain);
+	__m256 const g = _mm256_set1_ps (gain);
+
+	while (nframes >= 16) {
+		_mm256_storeu_ps (buf,     _mm256_mul_ps (_mm256_loadu_ps (buf),     g));
+		_mm256_storeu_ps (buf + 8, _mm256_mul_ps (_mm256_loadu_ps (buf + 8), g));
+		buf += 16;
+		nframes -= 16;
+	}
+
+	if (nframes >= 8) {
+		_mm256_storeu_ps (buf, _mm256_mul_ps (_mm256_loadu_ps (buf), g));
+		buf += 8;
+		nframes -= 8;
+	}
+
+	_mm256_zeroupper ();
+
+	while (nframes > 0) {
+		*buf++ *= gain;
+		--nframes;
+	}
 }
 
 void
 x86_sse_avx_mix_buffers_with_gain (float * dst, const float * src, uint32_t nframes, float gain)
 {
-	default_mix_buffers_with_gain (dst, src, nframes, gain);
+	__m256 const g = _mm256_set1_ps (gain);
+
+	while (nframes >= 16) {
+		_mm256_storeu_ps (dst,     _mm256_add_ps (_mm256_loadu_ps (dst),     _mm256_mul_ps (_mm256_loadu_ps (src),     g)));
+		_mm256_storeu_ps (dst + 8, _mm256_add_ps (_mm256_loadu_ps (dst + 8), _mm256_mul_ps (_mm256_loadu_ps (src + 8), g)));
+		dst += 16;
+		src += 16;
+		nframes -= 16;
+	}
+
+	if (nframes >= 8) {
+		_mm256_storeu_ps (dst, _mm256_add_ps (_mm256_loadu_ps (dst), _mm256_mul_ps (_mm256_loadu_ps (src), g)));
+		dst += 8;
+		src += 8;
+		nframes -= 8;
+	}
+
+	_mm256_zeroupper ();
+
+	while (nframes > 0) {
+		*dst++ += *src++ * gain;
+		--nframes;
+	}
 }
 
 void
 x86_sse_avx_mix_buffers_no_gain (float * dst, const float * src, uint32_t nframes)
 {
-	default_mix_buffers_no_gain (dst, src, nframes);
+	while (nframes >= 16) {
+		_mm256_storeu_ps (dst,     _mm256_add_ps (_mm256_loadu_ps (dst),     _mm256_loadu_ps (src)));
+		_mm256_storeu_ps (dst + 8, _mm256_add_ps (_mm256_loadu_ps (dst + 8), _mm256_loadu_ps (src + 8)));
+		dst += 16;
+		src += 16;
+		nframes -= 16;
+	}
+
+	if (nframes >= 8) {
+		_mm256_storeu_ps (dst, _mm256_add_ps (_mm256_loadu_ps (dst), _mm256_loadu_ps (src)));
+		dst += 8;
+		src += 8;
+		nframes -= 8;
+	}
+
+	_mm256_zeroupper ();
+
+	while (nframes > 0) {
+		*dst++ += *src++;
+		--nframes;
+	}
 }
 
 void
 x86_sse_avx_copy_vector (float * dst, const float * src, uint32_t nframes)
 {
-	default_copy_vector (dst, src, nframes);
-}
+	while (nframes >= 16) {
+		_mm256_storeu_ps (dst,     _mm256_loadu_ps (src));
+		_mm256_storeu_ps (dst + 8, _mm256_loadu_ps (src + 8));
+		dst += 16;
+		src += 16;
+		nframes -= 16;
+	}
 
-void
-x86_sse_avx_find_peaks (const float * buf, uint32_t nsamples, float *min, float *max)
-{
-	default_find_peaks (buf, nsamples, min, max);
+	if (nframes >= 8) {
+		_mm256_storeu_ps (dst, _mm256_loadu_ps (src));
+		dst += 8;
+		src += 8;
+		nframes -= 8;
+	}
+
+	_mm256_zeroupper ();
+
+	while (nframes > 0) {
+		*dst++ = *src++;
+		--nframes;
+	}
 }
@@ -0,0 +1,81 @@
+/*
+    Copyright (C) 2015 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+/* AVX versions of the per-sample gain functions; this file is compiled
+   with -mavx, and must only be called once FPU::has_avx() says so.
+*/
+
+#include <immintrin.h>
+#include <stdint.h>
+
+void
+x86_sse_avx_apply_gain_vector_to_buffer (float* buf, const float* gain, uint32_t nframes)
+{
+	while (nframes >= 16) {
+		_mm256_storeu_ps (buf,     _mm256_mul_ps (_mm256_loadu_ps (buf),     _mm256_loadu_ps (gain)));
+		_mm256_storeu_ps (buf + 8, _mm256_mul_ps (_mm256_loadu_ps (buf + 8), _mm256_loadu_ps (gain + 8)));
+		buf += 16;
+		gain += 16;
+		nframes -= 16;
+	}
+
+	if (nframes >= 8) {
+		_mm256_storeu_ps (buf, _mm256_mul_ps (_mm256_loadu_ps (buf), _mm256_loadu_ps (gain)));
+		buf += 8;
+		gain += 8;
+		nframes -= 8;
+	}
+
+	// avoid the penalty for mixing AVX and SSE code in the caller
+	_mm256_zeroupper ();
+
+	while (nframes > 0) {
+		*buf++ *= *gain++;
+		nframes--;
+	}
+}
+
+void
+x86_sse_avx_mix_buffers_with_gain_vector (float* dst, const float* src, const float* gain, uint32_t nframes)
+{
+	// multiply then add, rounding each, exactly as the scalar version does
+	while (nframes >= 16) {
+		_mm256_storeu_ps (dst,     _mm256_add_ps (_mm256_loadu_ps (dst),     _mm256_mul_ps (_mm256_loadu_ps (src),     _mm256_loadu_ps (gain))));
+		_mm256_storeu_ps (dst + 8, _mm256_add_ps (_mm256_loadu_ps (dst + 8), _mm256_mul_ps (_mm256_loadu_ps (src + 8), _mm256_loadu_ps (gain + 8))));
+		dst += 16;
+		src += 16;
+		gain += 16;
+		nframes -= 16;
+	}
+
+	if (nframes >= 8) {
+		_mm256_storeu_ps (dst, _mm256_add_ps (_mm256_loadu_ps (dst), _mm256_mul_ps (_mm256_loadu_ps (src), _mm256_loadu_ps (gain))));
+		dst += 8;
+		src += 8;
+		gain += 8;
+		nframes -= 8;
+	}
+
+	_mm256_zeroupper ();
+
+	while (nframes > 0) {
+		*dst++ += *src++ * *gain++;
+		nframes--;
+	}
+}
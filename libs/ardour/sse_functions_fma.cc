@@ -0,0 +1,88 @@
+/*
+    Copyright (C) 2015 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+/* AVX2 + FMA versions of the functions that can use a fused
+   multiply-add; this file is compiled with -mavx2 -mfma, and must only be
+   called once FPU::has_avx2() and FPU::has_fma() say so.
+
+   A fused multiply-add rounds once rather than twice, so these do not give
+   bit-identical results to the other versions; they are slightly more
+   accurate.
+*/
+
+#include <immintrin.h>
+#include <stdint.h>
+
+#include "ardour/mix.h"
+
+void
+x86_fma_mix_buffers_with_gain (float * dst, const float * src, uint32_t nframes, float gain)
+{
+	__m256 const g = _mm256_set1_ps (gain);
+
+	while (nframes >= 16) {
+		_mm256_storeu_ps (dst,     _mm256_fmadd_ps (_mm256_loadu_ps (src),     g, _mm256_loadu_ps (dst)));
+		_mm256_storeu_ps (dst + 8, _mm256_fmadd_ps (_mm256_loadu_ps (src + 8), g, _mm256_loadu_ps (dst + 8)));
+		dst += 16;
+		src += 16;
+		nframes -= 16;
+	}
+
+	if (nframes >= 8) {
+		_mm256_storeu_ps (dst, _mm256_fmadd_ps (_mm256_loadu_ps (src), g, _mm256_loadu_ps (dst)));
+		dst += 8;
+		src += 8;
+		nframes -= 8;
+	}
+
+	_mm256_zeroupper ();
+
+	while (nframes > 0) {
+		*dst++ += *src++ * gain;
+		--nframes;
+	}
+}
+
+void
+x86_fma_mix_buffers_with_gain_vector (float * dst, const float * src, const float * gain, uint32_t nframes)
+{
+	while (nframes >= 16) {
+		_mm256_storeu_ps (dst,     _mm256_fmadd_ps (_mm256_loadu_ps (src),     _mm256_loadu_ps (gain),     _mm256_loadu_ps (dst)));
+		_mm256_storeu_ps (dst + 8, _mm256_fmadd_ps (_mm256_loadu_ps (src + 8), _mm256_loadu_ps (gain + 8), _mm256_loadu_ps (dst + 8)));
+		dst += 16;
+		src += 16;
+		gain += 16;
+		nframes -= 16;
+	}
+
+	if (nframes >= 8) {
+		_mm256_storeu_ps (dst, _mm256_fmadd_ps (_mm256_loadu_ps (src), _mm256_loadu_ps (gain), _mm256_loadu_ps (dst)));
+		dst += 8;
+		src += 8;
+		gain += 8;
+		nframes -= 8;
+	}
+
+	_mm256_zeroupper ();
+
+	while (nframes > 0) {
+		*dst++ += *src++ * *gain++;
+		--nframes;
+	}
+}
@@ -19,6 +19,7 @@
 */
 
 #include <xmmintrin.h>
+#include <stdint.h>
 #include "ardour/types.h"
 
 void
@@ -115,5 +116,39 @@ x86_sse_find_peaks(const ARDOUR::Sample* buf, ARDOUR::pframes_t nframes, float *
 	_mm_store_ss(max, work);
 }
 
+void
+x86_sse_apply_gain_vector_to_buffer (float* buf, const float* gain, uint32_t nframes)
+{
+	// unaligned loads: these buffers are often offset into a larger one
+	while (nframes >= 8) {
+		_mm_storeu_ps (buf,     _mm_mul_ps (_mm_loadu_ps (buf),     _mm_loadu_ps (gain)));
+		_mm_storeu_ps (buf + 4, _mm_mul_ps (_mm_loadu_ps (buf + 4), _mm_loadu_ps (gain + 4)));
+		buf += 8;
+		gain += 8;
+		nframes -= 8;
+	}
 
+	while (nframes > 0) {
+		*buf++ *= *gain++;
+		nframes--;
+	}
+}
 
+void
+x86_sse_mix_buffers_with_gain_vector (float* dst, const float* src, const float* gain, uint32_t nframes)
+{
+	// multiply then add, rounding each, exactly as the scalar version does
+	while (nframes >= 8) {
+		_mm_storeu_ps (dst,     _mm_add_ps (_mm_loadu_ps (dst),     _mm_mul_ps (_mm_loadu_ps (src),     _mm_loadu_ps (gain))));
+		_mm_storeu_ps (dst + 4, _mm_add_ps (_mm_loadu_ps (dst + 4), _mm_mul_ps (_mm_loadu_ps (src + 4), _mm_loadu_ps (gain + 4))));
+		dst += 8;
+		src += 8;
+		gain += 8;
+		nframes -= 8;
+	}
+
+	while (nframes > 0) {
+		*dst++ += *src++ * *gain++;
+		nframes--;
+	}
+}
@@ -275,6 +275,12 @@ struct MetricSectionSorter {
     }
 };
 
+struct bbtcmp {
+    bool operator() (const BBT_Time& a, const BBT_Time& b) {
+	    return a < b;
+    }
+};
+
 TempoMap::TempoMap (framecnt_t fr)
 {
 	_frame_rate = fr;
@@ -294,6 +300,8 @@ TempoMap::TempoMap (framecnt_t fr)
 
 	metrics.push_back (t);
 	metrics.push_back (m);
+
+	extend_metric_index ();
 }
 
 TempoMap::~TempoMap ()
@@ -304,12 +312,15 @@ void
 TempoMap::remove_tempo (const TempoSection& tempo, bool complete_operation)
 {
 	bool removed = false;
+	BBT_Time const where (tempo.start());
 
 	{
 		Glib::Threads::RWLock::WriterLock lm (lock);
 		if ((removed = remove_tempo_locked (tempo))) {
 			if (complete_operation) {
-				recompute_map (true);
+				recompute_map_from (true, where);
+			} else {
+				extend_metric_index ();
 			}
 		}
 	}
@@ -328,6 +339,7 @@ TempoMap::remove_tempo_locked (const TempoSection& tempo)
 		if (dynamic_cast<TempoSection*> (*i) != 0) {
 			if (tempo.frame() == (*i)->frame()) {
 				if ((*i)->movable()) {
+					truncate_metric_index ((*i)->start().bars);
 					metrics.erase (i);
 					return true;
 				}
@@ -342,12 +354,15 @@ void
 TempoMap::remove_meter (const MeterSection& tempo, bool complete_operation)
 {
 	bool removed = false;
+	BBT_Time const where (tempo.start());
 
 	{
 		Glib::Threads::RWLock::WriterLock lm (lock);
 		if ((removed = remove_meter_locked (tempo))) {
 			if (complete_operation) {
-				recompute_map (true);
+				recompute_map_from (true, where);
+			} else {
+				extend_metric_index ();
 			}
 		}
 	}
@@ -366,6 +381,7 @@ TempoMap::remove_meter_locked (const MeterSection& tempo)
 		if (dynamic_cast<MeterSection*> (*i) != 0) {
 			if (tempo.frame() == (*i)->frame()) {
 				if ((*i)->movable()) {
+					truncate_metric_index ((*i)->start().bars);
 					metrics.erase (i);
 					return true;
 				}
@@ -413,9 +429,18 @@ TempoMap::do_insert (MetricSection* section)
 	   the new one. Note that this means that if we find a matching,
 	   existing section, we can break out of the loop since we're
 	   guaranteed that there is only one such match.
+
+	   Nothing before the new section's bar can be affected, so start
+	   looking there, and stop once we are past it.
 	*/
 
-	for (Metrics::iterator i = metrics.begin(); i != metrics.end(); ++i) {
+	truncate_metric_index (section->start().bars);
+
+	for (Metrics::iterator i = first_section_in_or_after (section->start().bars); i != metrics.end(); ++i) {
+
+		if ((*i)->start().bars > section->start().bars) {
+			break;
+		}
 
 		bool const iter_is_tempo = dynamic_cast<TempoSection*> (*i) != 0;
 		bool const insert_is_tempo = dynamic_cast<TempoSection*> (section) != 0;
@@ -477,7 +502,7 @@ TempoMap::do_insert (MetricSection* section)
 
 		Metrics::iterator i;
 
-		for (i = metrics.begin(); i != metrics.end(); ++i) {
+		for (i = first_section_in_or_after (section->start().bars); i != metrics.end(); ++i) {
 			if ((*i)->start() > section->start()) {
 				break;
 			}
@@ -495,8 +520,10 @@ TempoMap::replace_tempo (const TempoSection& ts, const Tempo& tempo, const BBT_T
 		TempoSection& first (first_tempo());
 		
 		if (ts.start() != first.start()) {
+			BBT_Time const old_start (ts.start());
 			remove_tempo_locked (ts);
-			add_tempo_locked (tempo, where, true);
+			add_tempo_locked (tempo, where, false);
+			recompute_map_from (false, min (old_start, where));
 		} else {
 			{
 				/* cannot move the first tempo section */
@@ -541,18 +568,14 @@ TempoMap::add_tempo_locked (const Tempo& tempo, BBT_Time where, bool recompute)
 	   
 	   now see if we can find better candidates.
 	*/
-	
-	for (Metrics::const_iterator i = metrics.begin(); i != metrics.end(); ++i) {
-		
-		const MeterSection* m;
-		
-		if (where < (*i)->start()) {
-			break;
-		}
-		
-		if ((m = dynamic_cast<const MeterSection*>(*i)) != 0) {
-			meter = m;
-		}
+
+	extend_metric_index ();
+
+	MetricIndex::const_iterator i = first_beyond (_meter_index, where);
+
+	if (i != _meter_index.begin()) {
+		--i;
+		meter = i->meter;
 	}
 	
 	ts->update_bar_offset_from_bbt (*meter);
@@ -562,7 +585,7 @@ TempoMap::add_tempo_locked (const Tempo& tempo, BBT_Time where, bool recompute)
 	do_insert (ts);
 
 	if (recompute) {
-		recompute_map (false);
+		recompute_map_from (false, where);
 	}
 }	
 
@@ -574,8 +597,17 @@ TempoMap::replace_meter (const MeterSection& ms, const Meter& meter, const BBT_T
 		MeterSection& first (first_meter());
 		
 		if (ms.start() != first.start()) {
+			BBT_Time const old_start (ms.start());
+			BBT_Time new_start (where);
 			remove_meter_locked (ms);
-			add_meter_locked (meter, where, true);
+			add_meter_locked (meter, where, false);
+			/* add_meter_locked() moves the meter to the start of a bar */
+			if (new_start.beats != 1) {
+				new_start.bars++;
+			}
+			new_start.beats = 1;
+			new_start.ticks = 0;
+			recompute_map_from (true, min (old_start, new_start));
 		} else {
 			/* cannot move the first meter section */
 			*static_cast<Meter*>(&first) = meter;
@@ -625,7 +657,7 @@ TempoMap::add_meter_locked (const Meter& meter, BBT_Time where, bool recompute)
 	do_insert (new MeterSection (where, meter.divisions_per_bar(), meter.note_divisor()));
 
 	if (recompute) {
-		recompute_map (true);
+		recompute_map_from (true, where);
 	}
 		
 }
@@ -653,46 +685,34 @@ void
 TempoMap::change_existing_tempo_at (framepos_t where, double beats_per_minute, double note_type)
 {
 	Tempo newtempo (beats_per_minute, note_type);
+	TempoSection* prev = 0;
 
-	TempoSection* prev;
-	TempoSection* first;
-	Metrics::iterator i;
+	{
+		Glib::Threads::RWLock::WriterLock lm (lock);
 
-	/* find the TempoSection immediately preceding "where"
-	 */
+		/* find the TempoSection immediately preceding "where"
+		 */
 
-	for (first = 0, i = metrics.begin(), prev = 0; i != metrics.end(); ++i) {
+		MetricIndex::const_iterator i = first_beyond (_metric_index, where);
 
-		if ((*i)->frame() > where) {
-			break;
+		if (i != _metric_index.begin()) {
+			--i;
+			/* we are allowed to change the sections we index */
+			prev = const_cast<TempoSection*> (i->tempo);
 		}
 
-		TempoSection* t;
+		/* reset */
 
-		if ((t = dynamic_cast<TempoSection*>(*i)) != 0) {
-			if (!first) {
-				first = t;
-			}
-			prev = t;
+		if (prev) {
+			/* cannot move the first tempo section */
+			*((Tempo*)prev) = newtempo;
+			recompute_map_from (false, prev->start());
 		}
 	}
 
 	if (!prev) {
-		if (!first) {
-			error << string_compose (_("no tempo sections defined in tempo map - cannot change tempo @ %1"), where) << endmsg;
-			return;
-		}
-
-		prev = first;
-	}
-
-	/* reset */
-
-	{
-		Glib::Threads::RWLock::WriterLock lm (lock);
-		/* cannot move the first tempo section */
-		*((Tempo*)prev) = newtempo;
-		recompute_map (false);
+		error << string_compose (_("no tempo sections defined in tempo map - cannot change tempo @ %1"), where) << endmsg;
+		return;
 	}
 
 	PropertyChanged (PropertyChange ());
@@ -769,6 +789,17 @@ TempoMap::first_tempo ()
 void
 TempoMap::require_map_to (framepos_t pos)
 {
+	{
+		/* the map is almost always long enough already, and checking
+		   that does not need to stop anyone else reading it.
+		*/
+		Glib::Threads::RWLock::ReaderLock lm (lock);
+
+		if (!_map.empty() && _map.back().frame >= pos) {
+			return;
+		}
+	}
+
 	Glib::Threads::RWLock::WriterLock lm (lock);
 
 	if (_map.empty() || _map.back().frame < pos) {
@@ -779,6 +810,14 @@ TempoMap::require_map_to (framepos_t pos)
 void
 TempoMap::require_map_to (const BBT_Time& bbt)
 {
+	{
+		Glib::Threads::RWLock::ReaderLock lm (lock);
+
+		if (!_map.empty() && _map.back().bar >= (bbt.bars + 1)) {
+			return;
+		}
+	}
+
 	Glib::Threads::RWLock::WriterLock lm (lock);
 
 	/* since we have no idea where BBT is if its off the map, see the last
@@ -858,51 +897,326 @@ TempoMap::recompute_map (bool reassign_tempo_bbt, framepos_t end)
 	current.ticks = 0;
 
 	if (reassign_tempo_bbt) {
+		update_tempo_bbt_from_bar_offsets (metrics.begin(), meter);
+	}
 
-		MeterSection* rmeter = meter;
+	DEBUG_TRACE (DEBUG::TempoMath, string_compose ("start with meter = %1 tempo = %2\n", *((Meter*)meter), *((Tempo*)tempo)));
 
-		DEBUG_TRACE (DEBUG::TempoMath, "\tUpdating tempo marks BBT time from bar offset\n");
+	next_metric = metrics.begin();
+	++next_metric; // skip meter (or tempo)
+	++next_metric; // skip tempo (or meter)
 
-		for (Metrics::iterator i = metrics.begin(); i != metrics.end(); ++i) {
+	_map.clear ();
+
+	DEBUG_TRACE (DEBUG::TempoMath, string_compose ("Add first bar at 1|1 @ %2\n", current.bars, current_frame));
+	_map.push_back (BBTPoint (*meter, *tempo, current_frame, 1, 1));
 
-			TempoSection* ts;
-			MeterSection* ms;
+	if (end != 0) {
+		/* (end == 0 is a silly call from Session::process() during startup) */
+		_extend_map (tempo, meter, next_metric, current, current_frame, end);
+	}
+
+	/* every section may have moved */
+
+	truncate_metric_index (0);
+	extend_metric_index ();
+}
+
+/** Recompute the map after a change to the metric sections at or after
+ *  @param where, keeping the part of it before the change.
+ */
+void
+TempoMap::recompute_map_from (bool reassign_tempo_bbt, const BBT_Time& where)
+{
+	/* CALLER MUST HOLD WRITE LOCK */
+
+	if (reassign_tempo_bbt) {
+
+		/* tempo sections before where's bar use the same meter as
+		   before, so only those from there on can move (and then
+		   only within their bars).
+		*/
+
+		truncate_metric_index (where.bars);
+
+		const MeterSection* meter = (_meter_index.empty() ? &first_meter() : _meter_index.back().meter);
+
+		update_tempo_bbt_from_bar_offsets (first_section_in_or_after (where.bars), meter);
+	}
+
+	/* nothing before the bar containing `where' can be affected by the
+	   change, so restart the map from the last bar line before that
+	   bar.
+	*/
+
+	bbtcmp cmp;
+	BBTPointList::iterator restart = lower_bound (_map.begin(), _map.end(), BBT_Time (where.bars, 1, 0), cmp);
+
+	while (restart != _map.begin()) {
+		--restart;
+		if ((*restart).is_bar()) {
+			break;
+		}
+	}
+
+	if (restart == _map.begin()) {
+		recompute_map (false);
+		return;
+	}
+
+	DEBUG_TRACE (DEBUG::TempoMath, string_compose ("recomputing tempo map from %1|1 for a change at %2\n", (*restart).bar, where));
+
+	/* sections from the restart point on will be given new frames */
+
+	truncate_metric_index ((*restart).bar);
+
+	TempoSection* tempo = const_cast<TempoSection*> ((*restart).tempo);
+	MeterSection* meter = const_cast<MeterSection*> ((*restart).meter);
+	BBT_Time const current ((*restart).bar, 1, 0);
+	/* carry on from the unrounded position, as a full recompute would */
+	double const current_frame = (*restart).exact_frame;
+
+	/* the sections in effect at the restart point have already been
+	   applied; carry on from the first one after them.
+	*/
+
+	Metrics::iterator next_metric = first_section_after (max (tempo->start(), meter->start()));
+
+	_map.erase (restart + 1, _map.end());
+
+	_extend_map (tempo, meter, next_metric, current, current_frame, max_framepos);
+
+	extend_metric_index ();
+}
+
+/** Reassign the BBT time of each tempo section from @param from on from its
+ *  bar offset, using the meter in effect at it, which is @param meter
+ *  until we pass another.
+ */
+void
+TempoMap::update_tempo_bbt_from_bar_offsets (Metrics::iterator from, const MeterSection* meter)
+{
+	/* CALLER MUST HOLD WRITE LOCK */
+
+	DEBUG_TRACE (DEBUG::TempoMath, "\tUpdating tempo marks BBT time from bar offset\n");
+
+	for (Metrics::iterator i = from; i != metrics.end(); ++i) {
+
+		TempoSection* ts;
+		MeterSection* ms;
 	
-			if ((ts = dynamic_cast<TempoSection*>(*i)) != 0) {
+		if ((ts = dynamic_cast<TempoSection*>(*i)) != 0) {
 
-				/* reassign the BBT time of this tempo section
-				 * based on its bar offset position.
-				 */
+			/* reassign the BBT time of this tempo section
+			 * based on its bar offset position.
+			 */
+
+			ts->update_bbt_time_from_bar_offset (*meter);
+
+		} else if ((ms = dynamic_cast<MeterSection*>(*i)) != 0) {
+			meter = ms;
+		} else {
+			fatal << _("programming error: unhandled MetricSection type") << endmsg;
+			abort(); /*NOTREACHED*/
+		}
+	}
+}
+
+/** Remove the index entries for sections in bar @param bar or later,
+ *  before they are changed.
+ */
+void
+TempoMap::truncate_metric_index (uint32_t bar)
+{
+	/* CALLER MUST HOLD WRITE LOCK */
+
+	_metric_index.erase (first_in_or_after_bar (_metric_index, bar), _metric_index.end());
+	_tempo_index.erase (first_in_or_after_bar (_tempo_index, bar), _tempo_index.end());
+	_meter_index.erase (first_in_or_after_bar (_meter_index, bar), _meter_index.end());
+}
+
+/** Add index entries for all the sections after the last one indexed */
+void
+TempoMap::extend_metric_index ()
+{
+	/* CALLER MUST HOLD WRITE LOCK */
+
+	Metrics::iterator i;
+	MetricIndexEntry e;
+
+	if (_metric_index.empty()) {
+		i = metrics.begin();
+		e.tempo = 0;
+		e.meter = 0;
+	} else {
+		e = _metric_index.back();
+		i = e.section;
+		++i;
+	}
+
+	for (; i != metrics.end(); ++i) {
 
-				ts->update_bbt_time_from_bar_offset (*rmeter);
+		const TempoSection* ts;
+		const MeterSection* ms = 0;
+		BBT_Time const start ((*i)->start().bars, (*i)->start().beats, 0);
 
-			} else if ((ms = dynamic_cast<MeterSection*>(*i)) != 0) {
-				rmeter = ms;
+		if (_metric_index.empty()) {
+			e.reach = (*i)->frame();
+			e.bbt_reach = start;
+		} else {
+			e.reach = max (e.reach, (*i)->frame());
+			e.bbt_reach = max (e.bbt_reach, start);
+		}
+
+		e.section = i;
+
+		if ((ts = dynamic_cast<const TempoSection*> (*i)) != 0) {
+			e.tempo = ts;
+		} else if ((ms = dynamic_cast<const MeterSection*> (*i)) != 0) {
+			e.meter = ms;
+		}
+
+		_metric_index.push_back (e);
+
+		/* the single-type indices each need their own reach, which
+		   only takes sections of their own type into account.
+		*/
+
+		MetricIndex* own = (ts ? &_tempo_index : (ms ? &_meter_index : 0));
+
+		if (own) {
+			MetricIndexEntry oe (e);
+
+			if (!own->empty()) {
+				oe.reach = max (own->back().reach, (*i)->frame());
+				oe.bbt_reach = max (own->back().bbt_reach, start);
 			} else {
-				fatal << _("programming error: unhandled MetricSection type") << endmsg;
-				abort(); /*NOTREACHED*/
+				oe.reach = (*i)->frame();
+				oe.bbt_reach = start;
 			}
+
+			own->push_back (oe);
 		}
 	}
+}
 
-	DEBUG_TRACE (DEBUG::TempoMath, string_compose ("start with meter = %1 tempo = %2\n", *((Meter*)meter), *((Tempo*)tempo)));
+/** @return the first section in bar @param bar or later */
+Metrics::iterator
+TempoMap::first_section_in_or_after (uint32_t bar)
+{
+	/* CALLER MUST HOLD WRITE LOCK */
 
-	next_metric = metrics.begin();
-	++next_metric; // skip meter (or tempo)
-	++next_metric; // skip tempo (or meter)
+	MetricIndex::iterator e = first_in_or_after_bar (_metric_index, bar);
 
-	_map.clear ();
+	if (e != _metric_index.end()) {
+		return e->section;
+	}
 
-	DEBUG_TRACE (DEBUG::TempoMath, string_compose ("Add first bar at 1|1 @ %2\n", current.bars, current_frame));
-	_map.push_back (BBTPoint (*meter, *tempo,(framepos_t) llrint(current_frame), 1, 1));
+	/* the index may not cover the end of the list, so look through the
+	   rest of it.
+	*/
 
-	if (end == 0) {
-		/* silly call from Session::process() during startup
-		 */
-		return;
+	Metrics::iterator i;
+
+	if (_metric_index.empty()) {
+		i = metrics.begin();
+	} else {
+		i = _metric_index.back().section;
+		++i;
+	}
+
+	while (i != metrics.end() && (*i)->start().bars < bar) {
+		++i;
 	}
 
-	_extend_map (tempo, meter, next_metric, current, current_frame, end);
+	return i;
+}
+
+/** @return the first section which starts after @param start */
+Metrics::iterator
+TempoMap::first_section_after (const BBT_Time& start)
+{
+	/* CALLER MUST HOLD WRITE LOCK */
+
+	Metrics::iterator i = first_section_in_or_after (start.bars);
+
+	while (i != metrics.end() && !((*i)->start() > start)) {
+		++i;
+	}
+
+	return i;
+}
+
+/** @return the first entry in @param index at which a walk of the sections
+ *  looking for those in effect at @param frame would stop, or the end of
+ *  the index.
+ */
+TempoMap::MetricIndex::const_iterator
+TempoMap::first_beyond (const MetricIndex& index, framepos_t frame)
+{
+	MetricIndex::const_iterator first = index.begin();
+	MetricIndex::size_type n = index.size();
+
+	while (n > 0) {
+		MetricIndex::size_type const half = n / 2;
+		MetricIndex::const_iterator const mid = first + half;
+
+		if (mid->reach <= frame) {
+			first = mid + 1;
+			n -= half + 1;
+		} else {
+			n = half;
+		}
+	}
+
+	return first;
+}
+
+/** As above, but for @param bbt, whose ticks are ignored */
+TempoMap::MetricIndex::const_iterator
+TempoMap::first_beyond (const MetricIndex& index, const BBT_Time& bbt)
+{
+	BBT_Time const key (bbt.bars, bbt.beats, 0);
+	MetricIndex::const_iterator first = index.begin();
+	MetricIndex::size_type n = index.size();
+
+	while (n > 0) {
+		MetricIndex::size_type const half = n / 2;
+		MetricIndex::const_iterator const mid = first + half;
+
+		if (mid->bbt_reach <= key) {
+			first = mid + 1;
+			n -= half + 1;
+		} else {
+			n = half;
+		}
+	}
+
+	return first;
+}
+
+/** @return the first entry in @param index for a section in bar @param bar
+ *  or later, or the end of the index.
+ */
+TempoMap::MetricIndex::iterator
+TempoMap::first_in_or_after_bar (MetricIndex& index, uint32_t bar)
+{
+	MetricIndex::iterator first = index.begin();
+	MetricIndex::size_type n = index.size();
+
+	while (n > 0) {
+		MetricIndex::size_type const half = n / 2;
+		MetricIndex::iterator const mid = first + half;
+
+		if (mid->bbt_reach.bars < bar) {
+			first = mid + 1;
+			n -= half + 1;
+		} else {
+			n = half;
+		}
+	}
+
+	return first;
 }
 
 void
@@ -932,10 +1246,11 @@ TempoMap::extend_map (framepos_t end)
 	 * last point in the map 
 	 */
 
-	for (next_metric = metrics.begin(); next_metric != metrics.end(); ++next_metric) {
-		if ((*next_metric)->start() > last_metric_start) {
-			break;
-		}
+	next_metric = first_section_after (last_metric_start);
+
+	if (next_metric != metrics.end()) {
+		/* sections from here on may be given new frames */
+		truncate_metric_index ((*next_metric)->start().bars);
 	}
 
 	/* we cast away const here because this is the one place where we need
@@ -944,20 +1259,22 @@ TempoMap::extend_map (framepos_t end)
 
 	_extend_map (const_cast<TempoSection*> ((*i).tempo), 
 		     const_cast<MeterSection*> ((*i).meter),
-		     next_metric, BBT_Time ((*i).bar, (*i).beat, 0), (*i).frame, end);
+		     next_metric, BBT_Time ((*i).bar, (*i).beat, 0), (*i).exact_frame, end);
+
+	extend_metric_index ();
 }
 
 void
 TempoMap::_extend_map (TempoSection* tempo, MeterSection* meter, 
 		       Metrics::iterator next_metric,
-		       BBT_Time current, framepos_t current_frame, framepos_t end)
+		       BBT_Time current, double current_frame_exact, framepos_t end)
 {
 	/* CALLER MUST HOLD WRITE LOCK */
 
 	TempoSection* ts;
 	MeterSection* ms;
 	double beat_frames;
-	double current_frame_exact;
+	framepos_t current_frame = llrint (current_frame_exact);
 	framepos_t bar_start_frame;
 
 	DEBUG_TRACE (DEBUG::TempoMath, string_compose ("Extend map to %1 from %2 = %3\n", end, current, current_frame));
@@ -969,7 +1286,6 @@ TempoMap::_extend_map (TempoSection* tempo, MeterSection* meter,
 	}
 
 	beat_frames = meter->frames_per_grid (*tempo,_frame_rate);
-	current_frame_exact = current_frame;
 
 	while (current_frame < end) {
 
@@ -1090,11 +1406,11 @@ TempoMap::_extend_map (TempoSection* tempo, MeterSection* meter,
 
 		if (current.beats == 1) {
 			DEBUG_TRACE (DEBUG::TempoMath, string_compose ("Add Bar at %1|1 @ %2\n", current.bars, current_frame));
-			_map.push_back (BBTPoint (*meter, *tempo, current_frame, current.bars, 1));
+			_map.push_back (BBTPoint (*meter, *tempo, current_frame_exact, current.bars, 1));
 			bar_start_frame = current_frame;
 		} else {
 			DEBUG_TRACE (DEBUG::TempoMath, string_compose ("Add Beat at %1|%2 @ %3\n", current.bars, current.beats, current_frame));
-			_map.push_back (BBTPoint (*meter, *tempo, current_frame, current.bars, current.beats));
+			_map.push_back (BBTPoint (*meter, *tempo, current_frame_exact, current.bars, current.beats));
 		}
 
 		if (next_metric == metrics.end()) {
@@ -1121,16 +1437,23 @@ TempoMap::metric_at (framepos_t frame, Metrics::const_iterator* last) const
 	   now see if we can find better candidates.
 	*/
 
-	for (Metrics::const_iterator i = metrics.begin(); i != metrics.end(); ++i) {
+	MetricIndex::const_iterator i = first_beyond (_metric_index, frame);
 
-		if ((*i)->frame() > frame) {
-			break;
-		}
+	if (i != _metric_index.begin()) {
+
+		--i;
 
-		m.set_metric(*i);
+		if (i->meter) {
+			m.set_meter (*i->meter);
+		}
+		if (i->tempo) {
+			m.set_tempo (*i->tempo);
+		}
+		m.set_frame ((*i->section)->frame());
+		m.set_start ((*i->section)->start());
 
 		if (last) {
-			*last = i;
+			*last = i->section;
 		}
 	}
 	
@@ -1150,15 +1473,20 @@ TempoMap::metric_at (BBT_Time bbt) const
 	   now see if we can find better candidates.
 	*/
 
-	for (Metrics::const_iterator i = metrics.begin(); i != metrics.end(); ++i) {
+	MetricIndex::const_iterator i = first_beyond (_metric_index, bbt);
 
-		BBT_Time section_start ((*i)->start());
+	if (i != _metric_index.begin()) {
 
-		if (section_start.bars > bbt.bars || (section_start.bars == bbt.bars && section_start.beats > bbt.beats)) {
-			break;
-		}
+		--i;
 
-		m.set_metric (*i);
+		if (i->meter) {
+			m.set_meter (*i->meter);
+		}
+		if (i->tempo) {
+			m.set_tempo (*i->tempo);
+		}
+		m.set_frame ((*i->section)->frame());
+		m.set_start ((*i->section)->start());
 	}
 
 	return m;
@@ -1589,28 +1917,16 @@ const TempoSection&
 TempoMap::tempo_section_at (framepos_t frame) const
 {
 	Glib::Threads::RWLock::ReaderLock lm (lock);
-	Metrics::const_iterator i;
-	TempoSection* prev = 0;
-
-	for (i = metrics.begin(); i != metrics.end(); ++i) {
-		TempoSection* t;
-
-		if ((t = dynamic_cast<TempoSection*> (*i)) != 0) {
+	MetricIndex::const_iterator i = first_beyond (_tempo_index, frame);
 
-			if ((*i)->frame() > frame) {
-				break;
-			}
-
-			prev = t;
-		}
-	}
-
-	if (prev == 0) {
+	if (i == _tempo_index.begin()) {
 		fatal << endmsg;
 		abort(); /*NOTREACHED*/
 	}
 
-	return *prev;
+	--i;
+
+	return *i->tempo;
 }
 
 const Tempo&
@@ -1624,28 +1940,16 @@ const MeterSection&
 TempoMap::meter_section_at (framepos_t frame) const
 {
 	Glib::Threads::RWLock::ReaderLock lm (lock);
-	Metrics::const_iterator i;
-	MeterSection* prev = 0;
+	MetricIndex::const_iterator i = first_beyond (_meter_index, frame);
 
-	for (i = metrics.begin(); i != metrics.end(); ++i) {
-		MeterSection* t;
-
-		if ((t = dynamic_cast<MeterSection*> (*i)) != 0) {
-
-			if ((*i)->frame() > frame) {
-				break;
-			}
-
-			prev = t;
-		}
-	}
-
-	if (prev == 0) {
+	if (i == _meter_index.begin()) {
 		fatal << endmsg;
 		abort(); /*NOTREACHED*/
 	}
 
-	return *prev;
+	--i;
+
+	return *i->meter;
 }
 
 const Meter&
@@ -1739,12 +2043,16 @@ TempoMap::set_state (const XMLNode& node, int /*version*/)
 					if ((*prev)->start() == (*i)->start()) {
 						cerr << string_compose (_("Multiple meter definitions found at %1"), (*prev)->start()) << endmsg;
 						error << string_compose (_("Multiple meter definitions found at %1"), (*prev)->start()) << endmsg;
+						truncate_metric_index (0);
+						extend_metric_index ();
 						return -1;
 					}
 				} else if (dynamic_cast<TempoSection*>(*prev) && dynamic_cast<TempoSection*>(*i)) {
 					if ((*prev)->start() == (*i)->start()) {
 						cerr << string_compose (_("Multiple tempo definitions found at %1"), (*prev)->start()) << endmsg;
 						error << string_compose (_("Multiple tempo definitions found at %1"), (*prev)->start()) << endmsg;
+						truncate_metric_index (0);
+						extend_metric_index ();
 						return -1;
 					}
 				}
@@ -1973,31 +2281,18 @@ TempoMap::framepos_plus_beats (framepos_t pos, Evoral::Beats beats) const
 	Metrics::const_iterator next_tempo;
 	const TempoSection* tempo = 0;
 
-	/* Find the starting tempo metric */
-
-	for (next_tempo = metrics.begin(); next_tempo != metrics.end(); ++next_tempo) {
-
-		const TempoSection* t;
+	/* Find the starting tempo metric.  This is a bit of a hack, but pos
+	   could be -ve, and if it is, we consider the initial metric changes
+	   (at time 0) to actually be in effect at pos.
+	*/
 
-		if ((t = dynamic_cast<const TempoSection*>(*next_tempo)) != 0) {
+	MetricIndex::const_iterator ti = first_beyond (_tempo_index, max (pos, (framepos_t) 0));
 
-			/* This is a bit of a hack, but pos could be -ve, and if it is,
-			   we consider the initial metric changes (at time 0) to actually
-			   be in effect at pos.
-			*/
+	next_tempo = (ti == _tempo_index.end() ? metrics.end() : ti->section);
 
-			framepos_t f = (*next_tempo)->frame ();
-
-			if (pos < 0 && f == 0) {
-				f = pos;
-			}
-			
-			if (f > pos) {
-				break;
-			}
-			
-			tempo = t;
-		}
+	if (ti != _tempo_index.begin()) {
+		--ti;
+		tempo = ti->tempo;
 	}
 
 	/* We now have:
@@ -2191,16 +2486,17 @@ TempoMap::framepos_plus_bbt (framepos_t pos, BBT_Time op) const
 
 	/* find the starting metrics for tempo & meter */
 
-	for (i = metrics.begin(); i != metrics.end(); ++i) {
+	MetricIndex::const_iterator mi = first_beyond (_metric_index, effective_pos);
 
-		if ((*i)->frame() > effective_pos) {
-			break;
-		}
+	i = (mi == _metric_index.end() ? metrics.end() : mi->section);
 
-		if ((t = dynamic_cast<const TempoSection*>(*i)) != 0) {
-			tempo = t;
-		} else if ((m = dynamic_cast<const MeterSection*>(*i)) != 0) {
-			meter = m;
+	if (mi != _metric_index.begin()) {
+		--mi;
+		if (mi->tempo) {
+			tempo = mi->tempo;
+		}
+		if (mi->meter) {
+			meter = mi->meter;
 		}
 	}
 
@@ -2319,18 +2615,13 @@ TempoMap::framewalk_to_beats (framepos_t pos, framecnt_t distance) const
 
 	/* Find the relevant initial tempo metric  */
 
-	for (next_tempo = metrics.begin(); next_tempo != metrics.end(); ++next_tempo) {
-
-		const TempoSection* t;
-
-		if ((t = dynamic_cast<const TempoSection*>(*next_tempo)) != 0) {
+	MetricIndex::const_iterator ti = first_beyond (_tempo_index, effective_pos);
 
-			if ((*next_tempo)->frame() > effective_pos) {
-				break;
-			}
+	next_tempo = (ti == _tempo_index.end() ? metrics.end() : ti->section);
 
-			tempo = t;
-		}
+	if (ti != _tempo_index.begin()) {
+		--ti;
+		tempo = ti->tempo;
 	}
 
 	/* We now have:
@@ -2434,12 +2725,6 @@ TempoMap::bbt_before_or_at (framepos_t pos)
 	return i;
 }
 
-struct bbtcmp {
-    bool operator() (const BBT_Time& a, const BBT_Time& b) {
-	    return a < b;
-    }
-};
-
 TempoMap::BBTPointList::const_iterator
 TempoMap::bbt_before_or_at (const BBT_Time& bbt)
 {
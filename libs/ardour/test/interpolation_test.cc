@@ -1,3 +1,7 @@
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include <glib.h>
 #include <sigc++/sigc++.h>
 #include "interpolation_test.h"
 
@@ -170,3 +174,211 @@ InterpolationTest::cubicInterpolationTest ()
 		CPPUNIT_ASSERT_EQUAL (1.0f, output[i]);
 	}
 }
+
+static ARDOUR::VarispeedQuality const qualities[] = {
+	ARDOUR::VarispeedLinear,
+	ARDOUR::VarispeedCubic,
+	ARDOUR::VarispeedSinc16,
+	ARDOUR::VarispeedSinc64
+};
+
+void
+InterpolationTest::varispeedInterpolationTest ()
+{
+	for (int q = 0; q < 4; ++q) {
+
+		varispeed.set_quality (qualities[q]);
+
+		/* at normal speed the input comes straight through; leave room for the lookahead */
+		varispeed.reset ();
+		varispeed.set_speed (1.0);
+		varispeed.set_target_speed (1.0);
+		framecnt_t result = varispeed.interpolate (0, NUM_SAMPLES - 64, input, output);
+		CPPUNIT_ASSERT_EQUAL ((framecnt_t) NUM_SAMPLES - 64, result);
+		for (int i = 0; i < NUM_SAMPLES - 64; ++i) {
+			CPPUNIT_ASSERT_EQUAL (input[i], output[i]);
+		}
+
+		/* at half speed every other output falls on a whole input sample */
+		varispeed.reset ();
+		varispeed.set_speed (0.5);
+		varispeed.set_target_speed (0.5);
+		result = varispeed.interpolate (0, NUM_SAMPLES, input, output);
+		CPPUNIT_ASSERT_EQUAL ((framecnt_t) NUM_SAMPLES / 2, result);
+		for (int i = 0; i < NUM_SAMPLES; i += INTERVAL * 2) {
+			CPPUNIT_ASSERT_EQUAL (1.0f, output[i]);
+		}
+
+		/* gliding from 1 to 2 over 1000 samples moves half a block less
+		   than the session does at the new speed, and the next block
+		   makes it up; with or without buffers.
+		*/
+		for (int with_buffers = 0; with_buffers < 2; ++with_buffers) {
+			varispeed.reset ();
+			varispeed.set_speed (1.0);
+			varispeed.set_target_speed (2.0);
+			CPPUNIT_ASSERT_EQUAL ((framecnt_t) 1500, varispeed.interpolate (0, 1000, with_buffers ? input : 0, output));
+			varispeed.set_speed (2.0);
+			CPPUNIT_ASSERT_EQUAL ((framecnt_t) 2500, varispeed.interpolate (0, 1000, with_buffers ? input + 1500 : 0, output));
+		}
+
+		/* ramping 1 -> 0.5 -> 1 gets back in step with the session,
+		   carrying the fractional position from one block to the next
+		*/
+		for (int with_buffers = 0; with_buffers < 2; ++with_buffers) {
+			double const speeds[] = { 1.0, 0.5, 0.5, 1.0, 1.0, 1.0 };
+			framecnt_t const block = 333;
+			double session_position = 0;
+			framecnt_t position = 0;
+
+			varispeed.reset ();
+			varispeed.set_speed (speeds[0]);
+
+			for (int i = 1; i < 6; ++i) {
+				varispeed.set_target_speed (speeds[i]);
+				if (with_buffers) {
+					position += varispeed.interpolate (0, block, input + position, output);
+				} else {
+					position += varispeed.interpolate (0, block, NULL, NULL);
+				}
+				varispeed.set_speed (speeds[i]);
+				session_position += block * speeds[i];
+			}
+
+			CPPUNIT_ASSERT_EQUAL ((framecnt_t) floor (session_position), position);
+		}
+	}
+
+	/* slowing down sharply, as when shuttling, never reads backwards,
+	   either during the glide or while making up the distance after it;
+	   with linear interpolation of a ramp the output is where it read from.
+	*/
+
+	std::vector<Sample> ramp (32768);
+	for (size_t i = 0; i < ramp.size(); ++i) {
+		ramp[i] = i;
+	}
+
+	{
+		framecnt_t const block = 1024;
+		std::vector<Sample> out (block * 8);
+		double session_position = 0;
+		framecnt_t position = 0;
+
+		varispeed.set_quality (VarispeedLinear);
+		varispeed.reset ();
+		varispeed.set_speed (8.0);
+		varispeed.interpolate (0, block, &ramp[0], &out[0]);
+		position = 8 * block;
+
+		varispeed.set_target_speed (1.5);
+
+		for (int i = 0; i < 8; ++i) {
+			position += varispeed.interpolate (0, block, &ramp[position], &out[i * block]);
+			varispeed.set_speed (1.5);
+			session_position += block * 1.5;
+		}
+
+		for (size_t i = 1; i < out.size(); ++i) {
+			CPPUNIT_ASSERT (out[i] >= out[i - 1]);
+		}
+
+		CPPUNIT_ASSERT_EQUAL ((framecnt_t) floor (8 * block + session_position), position);
+	}
+
+	/* output made a block at a time is the same as that made in one go */
+
+	std::vector<Sample> sine (65536);
+	for (size_t i = 0; i < sine.size(); ++i) {
+		sine[i] = sin (i * 0.3);
+	}
+
+	for (int q = 0; q < 4; ++q) {
+
+		varispeed.set_quality (qualities[q]);
+
+		varispeed.reset ();
+		varispeed.set_speed (0.9);
+		varispeed.set_target_speed (0.9);
+		std::vector<Sample> whole (32768);
+		varispeed.interpolate (0, whole.size(), &sine[0], &whole[0]);
+
+		varispeed.reset ();
+		std::vector<Sample> blocks (32768);
+		framecnt_t position = 0;
+		for (size_t i = 0; i < blocks.size(); i += 256) {
+			position += varispeed.interpolate (0, 256, &sine[position], &blocks[i]);
+		}
+
+		for (size_t i = 0; i < whole.size(); ++i) {
+			CPPUNIT_ASSERT_DOUBLES_EQUAL (whole[i], blocks[i], 1e-5);
+		}
+	}
+}
+
+/** Measure how close each quality gets to a sine wave played at 0.9 speed,
+ *  and how quickly it does it.
+ */
+void
+InterpolationTest::varispeedBenchmark ()
+{
+	double const frequency = 0.1; /* cycles per sample */
+	double const speed = 0.9;
+	int const block = 1024;
+	int const frames = 1048576;
+	double const min_snr[] = { 25, 45, 70, 100 };
+	char const * names[] = { "linear", "cubic", "sinc16", "sinc64" };
+
+	std::vector<Sample> in (frames + block);
+	std::vector<Sample> out (frames);
+
+	for (size_t i = 0; i < in.size(); ++i) {
+		in[i] = 0.5 * sin (2 * M_PI * frequency * i);
+	}
+
+	for (int q = 0; q < 5; ++q) {
+
+		/* the last run is the old CubicInterpolation, for comparison */
+
+		cubic.reset ();
+		cubic.set_speed (speed);
+		cubic.set_target_speed (speed);
+		varispeed.reset ();
+		varispeed.set_quality (qualities[min (q, 3)]);
+		varispeed.set_speed (speed);
+		varispeed.set_target_speed (speed);
+
+		framecnt_t position = 0;
+		gint64 const start = g_get_monotonic_time ();
+
+		for (int i = 0; i < frames; i += block) {
+			if (q < 4) {
+				position += varispeed.interpolate (0, block, &in[position], &out[i]);
+			} else {
+				position += cubic.interpolate (0, block, &in[position], &out[i]);
+			}
+		}
+
+		gint64 const time = g_get_monotonic_time () - start;
+
+		/* skip the start, before the history is real */
+		double signal = 0;
+		double noise = 0;
+		for (int i = block; i < frames; ++i) {
+			double const ideal = 0.5 * sin (2 * M_PI * frequency * speed * i);
+			signal += ideal * ideal;
+			noise += (out[i] - ideal) * (out[i] - ideal);
+		}
+
+		double const snr = 10 * log10 (signal / noise);
+
+		cout << "\n" << (q < 4 ? names[q] : "CubicInterpolation") << ": SNR " << snr << " dB, "
+		     << (time ? (double) frames / time : 0) << " Msamples/s";
+
+		if (q < 4) {
+			CPPUNIT_ASSERT (snr > min_snr[q]);
+		}
+	}
+
+	cout << "\n";
+}
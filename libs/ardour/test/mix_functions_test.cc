@@ -0,0 +1,268 @@
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "ardour/mix.h"
+#include "ardour/runtime_functions.h"
+
+#include "mix_functions_test.h"
+#include "mix_kernels.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (MixFunctionsTest);
+
+using namespace std;
+using namespace ARDOUR;
+
+static void
+fill_random (float* buf, uint32_t n, float lo, float hi)
+{
+	for (uint32_t i = 0; i < n; ++i) {
+		buf[i] = lo + (hi - lo) * (rand () / (float) RAND_MAX);
+	}
+}
+
+static const uint32_t max_frames = 8192;
+/* room for the largest block at any of the offsets we try */
+static const uint32_t buffer_size = max_frames + 16;
+/* offsets that cover all the alignments the vector code might care about */
+static const uint32_t max_offset = 16;
+
+/** every length up to a few vectors' worth, and a long one */
+static vector<uint32_t>
+test_lengths ()
+{
+	vector<uint32_t> l;
+	for (uint32_t n = 0; n < 68; ++n) {
+		l.push_back (n);
+	}
+	l.push_back (max_frames);
+	return l;
+}
+
+/** @return true if @param actual is what @param k should have produced,
+ *  given that the default kernels produced @param expected.
+ */
+static bool
+same (vector<float> const & expected, vector<float> const & actual, Kernels const & k, bool mixes)
+{
+	if (!(mixes && k.fused)) {
+		return memcmp (&expected[0], &actual[0], expected.size () * sizeof (float)) == 0;
+	}
+
+	for (size_t i = 0; i < expected.size (); ++i) {
+		if (fabsf (expected[i] - actual[i]) > 1e-6f * max (1.0f, fabsf (expected[i]))) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/** Apply @param op to a copy of @param initial with the default kernels
+ *  and then with each of @param kernels, for every length and offset,
+ *  and check that the results agree.
+ */
+template<typename Op> static void
+compare_kernels (char const * what, vector<Kernels> const & kernels, vector<float> const & initial, Op op, bool mixes)
+{
+	vector<uint32_t> lengths = test_lengths ();
+	vector<float> expected;
+	vector<float> actual;
+
+	for (uint32_t offset = 0; offset < max_offset; ++offset) {
+		for (vector<uint32_t>::iterator l = lengths.begin(); l != lengths.end(); ++l) {
+
+			uint32_t const n = *l;
+			expected = initial;
+			op (kernels.front (), &expected[offset], offset, n);
+
+			for (vector<Kernels>::const_iterator k = kernels.begin(); k != kernels.end(); ++k) {
+				actual = initial;
+				op (*k, &actual[offset], offset, n);
+				if (!same (expected, actual, *k, mixes)) {
+					cerr << k->name << " " << what << " differs, offset " << offset << " frames " << n << endl;
+					CPPUNIT_ASSERT (false);
+				}
+			}
+		}
+	}
+}
+
+/* the operations, in a form compare_kernels() can use */
+
+struct ApplyGain {
+	void operator() (Kernels const & k, float* buf, uint32_t, uint32_t n) const { k.apply_gain (buf, n, 0.7f); }
+};
+
+struct MixWithGain {
+	MixWithGain (vector<float> const & s) : src (s) {}
+	void operator() (Kernels const & k, float* buf, uint32_t offset, uint32_t n) const { k.mix_with_gain (buf, &src[offset], n, 0.7f); }
+	vector<float> const & src;
+};
+
+struct MixNoGain {
+	MixNoGain (vector<float> const & s) : src (s) {}
+	void operator() (Kernels const & k, float* buf, uint32_t offset, uint32_t n) const { k.mix_no_gain (buf, &src[offset], n); }
+	vector<float> const & src;
+};
+
+struct Copy {
+	Copy (vector<float> const & s) : src (s) {}
+	void operator() (Kernels const & k, float* buf, uint32_t offset, uint32_t n) const { k.copy (buf, &src[offset], n); }
+	vector<float> const & src;
+};
+
+struct ApplyGainVector {
+	ApplyGainVector (vector<float> const & g) : gain (g) {}
+	void operator() (Kernels const & k, float* buf, uint32_t offset, uint32_t n) const { k.apply_gain_vector (buf, &gain[offset], n); }
+	vector<float> const & gain;
+};
+
+struct MixWithGainVector {
+	MixWithGainVector (vector<float> const & s, vector<float> const & g) : src (s), gain (g) {}
+	void operator() (Kernels const & k, float* buf, uint32_t offset, uint32_t n) const { k.mix_with_gain_vector (buf, &src[offset], &gain[offset], n); }
+	vector<float> const & src;
+	vector<float> const & gain;
+};
+
+void
+MixFunctionsTest::setUp ()
+{
+	srand (42);
+}
+
+void
+MixFunctionsTest::computePeakTest ()
+{
+	vector<Kernels> kernels = available_kernels ();
+	vector<float> buf (buffer_size);
+	vector<uint32_t> lengths = test_lengths ();
+
+	fill_random (&buf[0], buffer_size, -1.0, 1.0);
+
+	for (uint32_t offset = 0; offset < max_offset; ++offset) {
+		for (vector<uint32_t>::iterator l = lengths.begin(); l != lengths.end(); ++l) {
+
+			/* put the peak in each possible position, so that every
+			   lane and the tail all get a chance to find it.
+			*/
+			for (uint32_t p = 0; p < min (*l, 34U); ++p) {
+				float const saved = buf[offset + p];
+				buf[offset + p] = (p % 2) ? -1.5f : 1.5f;
+
+				float const expected = default_compute_peak (&buf[offset], *l, 0.0f);
+
+				for (vector<Kernels>::iterator k = kernels.begin(); k != kernels.end(); ++k) {
+					if (k->compute_peak (&buf[offset], *l, 0.0f) != expected) {
+						cerr << k->name << " compute_peak differs, offset " << offset << " frames " << *l << endl;
+						CPPUNIT_ASSERT (false);
+					}
+				}
+
+				buf[offset + p] = saved;
+			}
+
+			/* a current peak higher than anything in the buffer */
+			for (vector<Kernels>::iterator k = kernels.begin(); k != kernels.end(); ++k) {
+				CPPUNIT_ASSERT_EQUAL (2.0f, k->compute_peak (&buf[offset], *l, 2.0f));
+			}
+		}
+	}
+}
+
+void
+MixFunctionsTest::findPeaksTest ()
+{
+	vector<Kernels> kernels = available_kernels ();
+	vector<float> buf (buffer_size);
+	vector<uint32_t> lengths = test_lengths ();
+
+	fill_random (&buf[0], buffer_size, -1.0, 1.0);
+
+	for (uint32_t offset = 0; offset < max_offset; ++offset) {
+		for (vector<uint32_t>::iterator l = lengths.begin(); l != lengths.end(); ++l) {
+
+			float emin = 0.5f;
+			float emax = -0.5f;
+			default_find_peaks (&buf[offset], *l, &emin, &emax);
+
+			for (vector<Kernels>::iterator k = kernels.begin(); k != kernels.end(); ++k) {
+				float amin = 0.5f;
+				float amax = -0.5f;
+				k->find_peaks (&buf[offset], *l, &amin, &amax);
+				if (amin != emin || amax != emax) {
+					cerr << k->name << " find_peaks differs, offset " << offset << " frames " << *l << endl;
+					CPPUNIT_ASSERT (false);
+				}
+			}
+		}
+	}
+}
+
+void
+MixFunctionsTest::applyGainTest ()
+{
+	vector<float> buf (buffer_size);
+	fill_random (&buf[0], buffer_size, -1.0, 1.0);
+
+	compare_kernels ("apply_gain_to_buffer", available_kernels (), buf, ApplyGain (), false);
+}
+
+void
+MixFunctionsTest::mixBuffersWithGainTest ()
+{
+	vector<float> src (buffer_size);
+	vector<float> dst (buffer_size);
+	fill_random (&src[0], buffer_size, -1.0, 1.0);
+	fill_random (&dst[0], buffer_size, -1.0, 1.0);
+
+	compare_kernels ("mix_buffers_with_gain", available_kernels (), dst, MixWithGain (src), true);
+}
+
+void
+MixFunctionsTest::mixBuffersNoGainTest ()
+{
+	vector<float> src (buffer_size);
+	vector<float> dst (buffer_size);
+	fill_random (&src[0], buffer_size, -1.0, 1.0);
+	fill_random (&dst[0], buffer_size, -1.0, 1.0);
+
+	compare_kernels ("mix_buffers_no_gain", available_kernels (), dst, MixNoGain (src), false);
+}
+
+void
+MixFunctionsTest::copyVectorTest ()
+{
+	vector<float> src (buffer_size);
+	vector<float> dst (buffer_size);
+	fill_random (&src[0], buffer_size, -1.0, 1.0);
+	fill_random (&dst[0], buffer_size, -1.0, 1.0);
+
+	compare_kernels ("copy_vector", available_kernels (), dst, Copy (src), false);
+}
+
+void
+MixFunctionsTest::applyGainVectorTest ()
+{
+	vector<float> buf (buffer_size);
+	vector<float> gain (buffer_size);
+	fill_random (&buf[0], buffer_size, -1.0, 1.0);
+	fill_random (&gain[0], buffer_size, 0.0, 2.0);
+
+	compare_kernels ("apply_gain_vector_to_buffer", available_kernels (), buf, ApplyGainVector (gain), false);
+}
+
+void
+MixFunctionsTest::mixBuffersWithGainVectorTest ()
+{
+	vector<float> src (buffer_size);
+	vector<float> dst (buffer_size);
+	vector<float> gain (buffer_size);
+	fill_random (&src[0], buffer_size, -1.0, 1.0);
+	fill_random (&dst[0], buffer_size, -1.0, 1.0);
+	fill_random (&gain[0], buffer_size, 0.0, 2.0);
+
+	compare_kernels ("mix_buffers_with_gain_vector", available_kernels (), dst, MixWithGainVector (src, gain), true);
+}
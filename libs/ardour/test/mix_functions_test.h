@@ -0,0 +1,29 @@
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class MixFunctionsTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE (MixFunctionsTest);
+	CPPUNIT_TEST (computePeakTest);
+	CPPUNIT_TEST (findPeaksTest);
+	CPPUNIT_TEST (applyGainTest);
+	CPPUNIT_TEST (mixBuffersWithGainTest);
+	CPPUNIT_TEST (mixBuffersNoGainTest);
+	CPPUNIT_TEST (copyVectorTest);
+	CPPUNIT_TEST (applyGainVectorTest);
+	CPPUNIT_TEST (mixBuffersWithGainVectorTest);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	void setUp ();
+	void tearDown () {}
+
+	void computePeakTest ();
+	void findPeaksTest ();
+	void applyGainTest ();
+	void mixBuffersWithGainTest ();
+	void mixBuffersNoGainTest ();
+	void copyVectorTest ();
+	void applyGainVectorTest ();
+	void mixBuffersWithGainVectorTest ();
+};
@@ -0,0 +1,60 @@
+#include "pbd/fpu.h"
+
+#include "ardour/mix.h"
+
+#include "mix_kernels.h"
+
+using namespace std;
+using namespace ARDOUR;
+
+vector<Kernels>
+available_kernels ()
+{
+	vector<Kernels> k;
+
+	Kernels const def = { "default", default_compute_peak, default_find_peaks, default_apply_gain_to_buffer,
+	                      default_mix_buffers_with_gain, default_mix_buffers_no_gain, default_copy_vector,
+	                      default_apply_gain_vector_to_buffer, default_mix_buffers_with_gain_vector, false };
+	k.push_back (def);
+
+	Kernels selected = { "selected", compute_peak, find_peaks, apply_gain_to_buffer,
+	                     mix_buffers_with_gain, mix_buffers_no_gain, copy_vector,
+	                     apply_gain_vector_to_buffer, mix_buffers_with_gain_vector, false };
+
+#if defined (ARCH_X86) && defined (BUILD_SSE_OPTIMIZATIONS)
+	PBD::FPU fpu;
+
+	selected.fused = (mix_buffers_with_gain == x86_fma_mix_buffers_with_gain ||
+	                  mix_buffers_with_gain == x86_avx512f_mix_buffers_with_gain);
+	k.push_back (selected);
+
+	if (fpu.has_sse ()) {
+		Kernels const sse = { "SSE", x86_sse_compute_peak, x86_sse_find_peaks, x86_sse_apply_gain_to_buffer,
+		                      x86_sse_mix_buffers_with_gain, x86_sse_mix_buffers_no_gain, default_copy_vector,
+		                      x86_sse_apply_gain_vector_to_buffer, x86_sse_mix_buffers_with_gain_vector, false };
+		k.push_back (sse);
+	}
+	if (fpu.has_avx ()) {
+		Kernels const avx = { "AVX", x86_sse_avx_compute_peak, x86_sse_avx_find_peaks, x86_sse_avx_apply_gain_to_buffer,
+		                      x86_sse_avx_mix_buffers_with_gain, x86_sse_avx_mix_buffers_no_gain, x86_sse_avx_copy_vector,
+		                      x86_sse_avx_apply_gain_vector_to_buffer, x86_sse_avx_mix_buffers_with_gain_vector, false };
+		k.push_back (avx);
+	}
+	if (fpu.has_avx2 () && fpu.has_fma ()) {
+		Kernels const fma = { "AVX2/FMA", x86_sse_avx_compute_peak, x86_sse_avx_find_peaks, x86_sse_avx_apply_gain_to_buffer,
+		                      x86_fma_mix_buffers_with_gain, x86_sse_avx_mix_buffers_no_gain, x86_sse_avx_copy_vector,
+		                      x86_sse_avx_apply_gain_vector_to_buffer, x86_fma_mix_buffers_with_gain_vector, true };
+		k.push_back (fma);
+	}
+	if (fpu.has_avx512f ()) {
+		Kernels const avx512 = { "AVX-512", x86_avx512f_compute_peak, x86_avx512f_find_peaks, x86_avx512f_apply_gain_to_buffer,
+		                         x86_avx512f_mix_buffers_with_gain, x86_avx512f_mix_buffers_no_gain, x86_avx512f_copy_vector,
+		                         x86_avx512f_apply_gain_vector_to_buffer, x86_avx512f_mix_buffers_with_gain_vector, true };
+		k.push_back (avx512);
+	}
+#else
+	k.push_back (selected);
+#endif
+
+	return k;
+}
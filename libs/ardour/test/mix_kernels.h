@@ -0,0 +1,32 @@
+#ifndef ARDOUR_TEST_MIX_KERNELS_H
+#define ARDOUR_TEST_MIX_KERNELS_H
+
+#include <vector>
+
+#include "ardour/runtime_functions.h"
+
+/* A complete set of kernels, as setup_hardware_optimization() would
+ * install it.  The first set is the plain C++ one, which the others must
+ * match exactly; except that a set with `fused' set does its mixes with
+ * fused multiply-adds, which round once rather than twice, so those are
+ * only required to be very close.
+ */
+struct Kernels {
+	char const *                           name;
+	ARDOUR::compute_peak_t                 compute_peak;
+	ARDOUR::find_peaks_t                   find_peaks;
+	ARDOUR::apply_gain_to_buffer_t         apply_gain;
+	ARDOUR::mix_buffers_with_gain_t        mix_with_gain;
+	ARDOUR::mix_buffers_no_gain_t          mix_no_gain;
+	ARDOUR::copy_vector_t                  copy;
+	ARDOUR::apply_gain_vector_to_buffer_t  apply_gain_vector;
+	ARDOUR::mix_buffers_with_gain_vector_t mix_with_gain_vector;
+	bool                                   fused;
+};
+
+/** @return the default kernels, the ones ARDOUR::init() selected, and
+ *  every other set that this CPU can run.
+ */
+extern std::vector<Kernels> available_kernels ();
+
+#endif
@@ -16,6 +16,9 @@
     Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 */
 
+#include <boost/bind.hpp>
+
+#include "pbd/command.h"
 #include "ardour/playlist.h"
 #include "ardour/region.h"
 #include "playlist_layering_test.h"
@@ -43,3 +46,98 @@ PlaylistLayeringTest::basicsTest ()
 	CPPUNIT_ASSERT_EQUAL (layer_t (1), _r[1]->layer ());
 	CPPUNIT_ASSERT_EQUAL (layer_t (2), _r[2]->layer ());
 }
+
+static int contents_changed_count = 0;
+
+static void
+contents_changed ()
+{
+	++contents_changed_count;
+}
+
+/* Edits made in a batch should leave the playlist just as if they had been
+ * made one at a time, but with one set of signals and undo commands at the end.
+ */
+void
+PlaylistLayeringTest::batchTest ()
+{
+	PBD::ScopedConnection c;
+	_playlist->ContentsChanged.connect_same_thread (c, boost::bind (&contents_changed));
+	contents_changed_count = 0;
+
+	_playlist->begin_batch ();
+
+	_playlist->add_region (_r[2], 20);
+	_playlist->add_region (_r[1], 10);
+	_playlist->add_region (_r[0], 0);
+	_r[1]->set_position (30);
+
+	/* nothing is said until the batch is committed */
+	CPPUNIT_ASSERT_EQUAL (0, contents_changed_count);
+
+	std::vector<Command*> cmds;
+	_playlist->commit_batch (&cmds);
+
+	CPPUNIT_ASSERT_EQUAL (1, contents_changed_count);
+	CPPUNIT_ASSERT (!cmds.empty ());
+
+	for (std::vector<Command*>::iterator i = cmds.begin(); i != cmds.end(); ++i) {
+		delete *i;
+	}
+
+	/* the region list is back in position order */
+	RegionList const rl = _playlist->region_list().rlist ();
+	RegionList::const_iterator i = rl.begin ();
+	CPPUNIT_ASSERT (*i++ == _r[0]);
+	CPPUNIT_ASSERT (*i++ == _r[2]);
+	CPPUNIT_ASSERT (*i++ == _r[1]);
+
+	/* and later additions are higher, as they would have been outside a batch */
+	CPPUNIT_ASSERT_EQUAL (layer_t (0), _r[2]->layer ());
+	CPPUNIT_ASSERT_EQUAL (layer_t (1), _r[1]->layer ());
+	CPPUNIT_ASSERT_EQUAL (layer_t (2), _r[0]->layer ());
+}
+
+/* Only the regions near a change are relayered; check that those which
+ * were overlapped, and no longer are, come down again.
+ */
+void
+PlaylistLayeringTest::incrementalTest ()
+{
+	_playlist->add_region (_r[0], 0);
+	_playlist->add_region (_r[1], 50);
+	_playlist->add_region (_r[2], 1000);
+	_playlist->add_region (_r[3], 1050);
+
+	CPPUNIT_ASSERT_EQUAL (layer_t (0), _r[0]->layer ());
+	CPPUNIT_ASSERT_EQUAL (layer_t (1), _r[1]->layer ());
+	CPPUNIT_ASSERT_EQUAL (layer_t (0), _r[2]->layer ());
+	CPPUNIT_ASSERT_EQUAL (layer_t (1), _r[3]->layer ());
+
+	/* move r1 under the other pair; it keeps its place in the layering order */
+	_r[1]->set_position (1040);
+
+	CPPUNIT_ASSERT_EQUAL (layer_t (0), _r[0]->layer ());
+	CPPUNIT_ASSERT_EQUAL (layer_t (0), _r[1]->layer ());
+	CPPUNIT_ASSERT_EQUAL (layer_t (1), _r[2]->layer ());
+	CPPUNIT_ASSERT_EQUAL (layer_t (2), _r[3]->layer ());
+
+	/* and back over r0 */
+	_r[1]->set_position (90);
+
+	CPPUNIT_ASSERT_EQUAL (layer_t (0), _r[0]->layer ());
+	CPPUNIT_ASSERT_EQUAL (layer_t (1), _r[1]->layer ());
+	CPPUNIT_ASSERT_EQUAL (layer_t (0), _r[2]->layer ());
+	CPPUNIT_ASSERT_EQUAL (layer_t (1), _r[3]->layer ());
+
+	/* trimming r0 clear of r1 brings r1 down */
+	_r[0]->set_length (50);
+
+	CPPUNIT_ASSERT_EQUAL (layer_t (0), _r[0]->layer ());
+	CPPUNIT_ASSERT_EQUAL (layer_t (0), _r[1]->layer ());
+
+	/* as does removing r2 for r3 */
+	_playlist->remove_region (_r[2]);
+
+	CPPUNIT_ASSERT_EQUAL (layer_t (0), _r[3]->layer ());
+}
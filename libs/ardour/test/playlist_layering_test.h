@@ -22,8 +22,12 @@ class PlaylistLayeringTest : public AudioRegionTest
 {
 	CPPUNIT_TEST_SUITE (PlaylistLayeringTest);
 	CPPUNIT_TEST (basicsTest);
+	CPPUNIT_TEST (batchTest);
+	CPPUNIT_TEST (incrementalTest);
 	CPPUNIT_TEST_SUITE_END ();
 
 public:
 	void basicsTest ();
+	void batchTest ();
+	void incrementalTest ();
 };
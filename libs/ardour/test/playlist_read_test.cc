@@ -222,6 +222,60 @@ PlaylistReadTest::check_staircase (Sample* b, int offset, int N)
 	}
 }
 
+void
+PlaylistReadTest::check_silence (Sample* b, int N)
+{
+	for (int i = 0; i < N; ++i) {
+		CPPUNIT_ASSERT_EQUAL (0.0f, b[i]);
+	}
+}
+
+/* Check that reads notice changes made to the playlist and its regions
+ * in between them, rather than reusing what was worked out before.
+ */
+void
+PlaylistReadTest::changedPlaylistReadTest ()
+{
+	_audio_playlist->add_region (_ar[0], 0);
+	_ar[0]->set_fade_in_active (false);
+	_ar[0]->set_fade_out_active (false);
+	_ar[0]->set_length (128);
+
+	_audio_playlist->read (_buf, _mbuf, _gbuf, 0, 256, 0);
+	check_staircase (_buf, 0, 128);
+	check_silence (_buf + 128, 128);
+
+	/* Move the region */
+	_ar[0]->set_position (64);
+	_audio_playlist->read (_buf, _mbuf, _gbuf, 0, 256, 0);
+	check_silence (_buf, 64);
+	check_staircase (_buf + 64, 0, 128);
+	check_silence (_buf + 192, 64);
+
+	/* Trim its end */
+	_ar[0]->set_length (64);
+	_audio_playlist->read (_buf, _mbuf, _gbuf, 0, 256, 0);
+	check_silence (_buf, 64);
+	check_staircase (_buf + 64, 0, 64);
+	check_silence (_buf + 128, 128);
+
+	/* Mute it */
+	_ar[0]->set_muted (true);
+	_audio_playlist->read (_buf, _mbuf, _gbuf, 0, 256, 0);
+	check_silence (_buf, 256);
+
+	/* Unmute it and add another after it */
+	_ar[0]->set_muted (false);
+	_audio_playlist->add_region (_ar[1], 128);
+	_ar[1]->set_fade_in_active (false);
+	_ar[1]->set_fade_out_active (false);
+	_audio_playlist->read (_buf, _mbuf, _gbuf, 0, 256, 0);
+	check_silence (_buf, 64);
+	check_staircase (_buf + 64, 0, 64);
+	check_staircase (_buf + 128, 0, 100);
+	check_silence (_buf + 228, 28);
+}
+
 /* Check the case where we have
  *    |----------- Region A (transparent) ------------------|
  *                     |---- Region B (opaque) --|
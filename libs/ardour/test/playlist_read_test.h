@@ -27,6 +27,7 @@ class PlaylistReadTest : public AudioRegionTest
 	CPPUNIT_TEST (transparentReadTest);
 	CPPUNIT_TEST (enclosedTransparentReadTest);
 	CPPUNIT_TEST (miscReadTest);
+	CPPUNIT_TEST (changedPlaylistReadTest);
 	CPPUNIT_TEST_SUITE_END ();
 
 public:
@@ -38,6 +39,7 @@ public:
 	void transparentReadTest ();
 	void enclosedTransparentReadTest ();
 	void miscReadTest ();
+	void changedPlaylistReadTest ();
 
 private:
 	int _N;
@@ -46,4 +48,5 @@ private:
 	float* _gbuf;
 	
 	void check_staircase (ARDOUR::Sample *, int, int);
+	void check_silence (ARDOUR::Sample *, int);
 };
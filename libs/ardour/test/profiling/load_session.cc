@@ -1,8 +1,12 @@
 #include "test_util.h"
 #include "pbd/failed_constructor.h"
 #include "ardour/ardour.h"
+#include "ardour/audio_backend.h"
 #include "ardour/audioengine.h"
+#include "ardour/diskstream.h"
 #include "ardour/session.h"
+#include <glib.h>
+#include <glibmm/timer.h>
 #include <iostream>
 #include <cstdlib>
 
@@ -11,15 +15,43 @@ using namespace ARDOUR;
 
 static const char* localedir = LOCALEDIR;
 
+static gint disk_underruns = 0;
+
+static void
+disk_underrun ()
+{
+	g_atomic_int_inc (&disk_underruns);
+}
+
 int main (int argc, char* argv[])
 {
-	if (argc != 3) {
-		cerr << "Syntax: " << argv[0] << " <dir> <snapshot-name>\n";
+	if (argc < 3 || argc > 5) {
+		cerr << "Syntax: " << argv[0] << " <dir> <snapshot-name> [<seconds> [<dummy-driver>]]\n"
+		     << "  With <seconds>, roll the session for that long on the Dummy backend\n"
+		     << "  (default driver \"Maximum Speed\") and report process cycles per second.\n";
 		exit (EXIT_FAILURE);
 	}
 
+	double const seconds = argc > 3 ? atof (argv[3]) : 0;
+	string const driver = argc > 4 ? argv[4] : (seconds > 0 ? "Maximum Speed" : "Normal Speed");
+
 	ARDOUR::init (false, true, localedir);
 
+	AudioEngine* engine = AudioEngine::create ();
+	boost::shared_ptr<AudioBackend> backend = engine->set_backend ("Dummy", "", "");
+
+	if (!backend || backend->set_driver (driver)) {
+		cerr << "Cannot use the Dummy backend with driver '" << driver << "'.\n";
+		exit (EXIT_FAILURE);
+	}
+
+	init_post_engine ();
+
+	if (engine->start ()) {
+		cerr << "Cannot start the Dummy backend.\n";
+		exit (EXIT_FAILURE);
+	}
+
 	Session* s = 0;
 	
 	try {
@@ -38,6 +70,55 @@ int main (int argc, char* argv[])
 		exit (EXIT_FAILURE);
 	}
 
+	if (seconds > 0) {
+		pframes_t const nframes = engine->samples_per_cycle ();
+
+		/* an underrun stops the transport, after which cycles cost
+		   next to nothing, so watch for them.
+		*/
+		PBD::ScopedConnection underrun_connection;
+		Diskstream::DiskUnderrun.connect_same_thread (underrun_connection, &disk_underrun);
+
+		/* only count cycles once the transport is actually rolling */
+		s->request_transport_speed (1.0);
+		for (int i = 0; !s->transport_rolling (); ++i) {
+			if (i == 10000) {
+				cerr << "The transport did not start.\n";
+				exit (EXIT_FAILURE);
+			}
+			Glib::usleep (1000);
+		}
+
+		/* count the distance rolled rather than the cycles run */
+		framepos_t const start_frame = s->transport_frame ();
+		gint64 const start = g_get_monotonic_time ();
+
+		Glib::usleep (seconds * 1e6);
+
+		bool const rolled = s->transport_rolling ();
+		framepos_t const end_frame = s->transport_frame ();
+		double const elapsed = (g_get_monotonic_time () - start) / 1e6;
+
+		s->request_stop ();
+
+		if (g_atomic_int_get (&disk_underruns)) {
+			cerr << "Disk underruns: " << g_atomic_int_get (&disk_underruns) << ", so the figures would not be trustworthy.\n";
+			exit (EXIT_FAILURE);
+		}
+
+		if (!rolled) {
+			cerr << "The transport stopped early, so the figures would not be trustworthy.\n";
+			exit (EXIT_FAILURE);
+		}
+
+		double const cycles = (end_frame - start_frame) / (double) nframes;
+
+		cout << "Driver: " << driver << ", " << nframes << " frames per cycle\n"
+		     << "Cycles: " << cycles << " in " << elapsed << " sec\n"
+		     << "Cycles per second: " << cycles / elapsed << "\n"
+		     << "Realtime multiple: " << cycles * nframes / (elapsed * engine->sample_rate ()) << "\n";
+	}
+
 	AudioEngine::instance()->remove_session ();
 	delete s;
 	AudioEngine::instance()->stop ();
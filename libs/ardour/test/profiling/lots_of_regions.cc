@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <iostream>
+#include <glib.h>
 #include "test_util.h"
 #include "ardour/ardour.h"
 #include "ardour/midi_track.h"
@@ -48,4 +51,53 @@ main (int argc, char* argv[])
 	playlist->duplicate (region, region->last_frame(), 1000);
 	session->add_command (new StatefulDiffCommand (playlist));
 	session->commit_reversible_command ();
+
+	/* Time the region queries that the editor and the butler make */
+	int const queries = 10000;
+	framepos_t const extent = playlist->get_extent().second;
+	framecnt_t const step = max ((framecnt_t) 1, extent / queries);
+	size_t found = 0;
+
+	gint64 start = g_get_monotonic_time ();
+	for (framepos_t f = 0; f < extent; f += step) {
+		found += playlist->regions_at (f)->size ();
+	}
+	gint64 regions_at_time = g_get_monotonic_time () - start;
+
+	start = g_get_monotonic_time ();
+	for (framepos_t f = 0; f < extent; f += step) {
+		found += playlist->regions_touched (f, f + 1024)->size ();
+	}
+	gint64 regions_touched_time = g_get_monotonic_time () - start;
+
+	start = g_get_monotonic_time ();
+	for (framepos_t f = 0; f < extent; f += step) {
+		found += playlist->top_region_at (f) ? 1 : 0;
+	}
+	gint64 top_region_at_time = g_get_monotonic_time () - start;
+
+	start = g_get_monotonic_time ();
+	for (framepos_t f = 0; f < extent; f += step) {
+		found += playlist->find_next_region (f, Start, 1) ? 1 : 0;
+	}
+	gint64 find_next_region_time = g_get_monotonic_time () - start;
+
+	/* Time moving one region to and fro, as a drag would */
+	boost::shared_ptr<Region> moved = playlist->top_region_at (extent / 2);
+	int const moves = 100;
+
+	start = g_get_monotonic_time ();
+	for (int i = 0; i < moves; ++i) {
+		moved->set_position (moved->position() + ((i % 2) ? -step : step));
+	}
+	gint64 move_time = g_get_monotonic_time () - start;
+
+	int const n = extent / step;
+
+	cout << playlist->n_regions() << " regions, " << found << " found\n"
+	     << "regions_at:        " << (double) regions_at_time / n << "us per query\n"
+	     << "regions_touched:   " << (double) regions_touched_time / n << "us per query\n"
+	     << "top_region_at:     " << (double) top_region_at_time / n << "us per query\n"
+	     << "find_next_region:  " << (double) find_next_region_time / n << "us per query\n"
+	     << "region move:       " << (double) move_time / moves << "us per move\n";
 }
@@ -0,0 +1,144 @@
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <glib.h>
+
+#include "ardour/ardour.h"
+
+#include "mix_kernels.h"
+
+using namespace std;
+using namespace ARDOUR;
+
+static const char* localedir = LOCALEDIR;
+
+static const uint32_t max_frames = 8192;
+
+/** Time @param op over @param n samples, enough times to process
+ *  @param total samples, and print the memory bandwidth it achieved given
+ *  that it moves @param bytes_per_sample bytes to or from memory for each
+ *  sample.
+ */
+template<typename Op> static void
+time_kernel (char const * what, Op op, float* buf, uint32_t n, uint32_t total, uint32_t bytes_per_sample)
+{
+	uint32_t const runs = total / n;
+
+	gint64 const start = g_get_monotonic_time ();
+	for (uint32_t r = 0; r < runs; ++r) {
+		op (buf, n);
+	}
+	gint64 const usecs = max ((gint64) 1, g_get_monotonic_time () - start);
+
+	cout << " " << what << " " << fixed << setprecision (2)
+	     << (double) runs * n * bytes_per_sample / (usecs * 1e3) << " GB/s";
+}
+
+/* the operations, in a form time_kernel() can use; anything that
+   accumulates starts from a buffer of zeros and adds very little, so the
+   values never grow enough to slow things down.
+*/
+
+struct TimePeak {
+	TimePeak (Kernels const & k) : kernels (k), peak (0) {}
+	void operator() (float* buf, uint32_t n) { peak = kernels.compute_peak (buf, n, peak); }
+	Kernels const & kernels;
+	float peak;
+};
+
+struct TimeFindPeaks {
+	TimeFindPeaks (Kernels const & k) : kernels (k), mn (0), mx (0) {}
+	void operator() (float* buf, uint32_t n) { kernels.find_peaks (buf, n, &mn, &mx); }
+	Kernels const & kernels;
+	float mn;
+	float mx;
+};
+
+struct TimeApplyGain {
+	TimeApplyGain (Kernels const & k) : kernels (k) {}
+	void operator() (float* buf, uint32_t n) { kernels.apply_gain (buf, n, 0.999f); }
+	Kernels const & kernels;
+};
+
+struct TimeMixWithGain {
+	TimeMixWithGain (Kernels const & k, float const * s) : kernels (k), src (s) {}
+	void operator() (float* buf, uint32_t n) { kernels.mix_with_gain (buf, src, n, 1e-6f); }
+	Kernels const & kernels;
+	float const * src;
+};
+
+struct TimeMixNoGain {
+	TimeMixNoGain (Kernels const & k, float const * s) : kernels (k), src (s) {}
+	void operator() (float* buf, uint32_t n) { kernels.mix_no_gain (buf, src, n); }
+	Kernels const & kernels;
+	float const * src;
+};
+
+struct TimeCopy {
+	TimeCopy (Kernels const & k, float const * s) : kernels (k), src (s) {}
+	void operator() (float* buf, uint32_t n) { kernels.copy (buf, src, n); }
+	Kernels const & kernels;
+	float const * src;
+};
+
+struct TimeApplyGainVector {
+	TimeApplyGainVector (Kernels const & k, float const * g) : kernels (k), gain (g) {}
+	void operator() (float* buf, uint32_t n) { kernels.apply_gain_vector (buf, gain, n); }
+	Kernels const & kernels;
+	float const * gain;
+};
+
+struct TimeMixWithGainVector {
+	TimeMixWithGainVector (Kernels const & k, float const * s, float const * g) : kernels (k), src (s), gain (g) {}
+	void operator() (float* buf, uint32_t n) { kernels.mix_with_gain_vector (buf, src, gain, n); }
+	Kernels const & kernels;
+	float const * src;
+	float const * gain;
+};
+
+int
+main (int argc, char* argv[])
+{
+	if (argc > 2) {
+		cerr << "Syntax: " << argv[0] << " [<samples-per-run>]\n";
+		exit (EXIT_FAILURE);
+	}
+
+	ARDOUR::init (false, true, localedir);
+
+	vector<Kernels> kernels = available_kernels ();
+	uint32_t const block_sizes[] = { 64, 256, 1024, 8192 };
+	uint32_t const samples_per_run = argc > 1 ? atoi (argv[1]) : 1 << 26;
+
+	vector<float> src (max_frames, 0.0f);
+	vector<float> dst (max_frames, 0.0f);
+	vector<float> gain (max_frames, 1.0f);
+
+	for (vector<Kernels>::iterator k = kernels.begin(); k != kernels.end(); ++k) {
+		for (uint32_t b = 0; b < sizeof (block_sizes) / sizeof (block_sizes[0]); ++b) {
+
+			uint32_t const n = block_sizes[b];
+
+			cout << k->name << " block " << n << ":";
+
+			/* bytes per sample: a read for the peak functions, a read
+			   and write for gain and copy, two reads and a write for
+			   mixes, and one more read for a gain vector.
+			*/
+			time_kernel ("compute_peak", TimePeak (*k), &src[0], n, samples_per_run, 4);
+			time_kernel ("find_peaks", TimeFindPeaks (*k), &src[0], n, samples_per_run, 4);
+			time_kernel ("apply_gain_to_buffer", TimeApplyGain (*k), &dst[0], n, samples_per_run, 8);
+			time_kernel ("copy_vector", TimeCopy (*k, &src[0]), &dst[0], n, samples_per_run, 8);
+			time_kernel ("mix_buffers_no_gain", TimeMixNoGain (*k, &src[0]), &dst[0], n, samples_per_run, 12);
+			time_kernel ("mix_buffers_with_gain", TimeMixWithGain (*k, &src[0]), &dst[0], n, samples_per_run, 12);
+			time_kernel ("apply_gain_vector_to_buffer", TimeApplyGainVector (*k, &gain[0]), &dst[0], n, samples_per_run, 12);
+			time_kernel ("mix_buffers_with_gain_vector", TimeMixWithGainVector (*k, &src[0], &gain[0]), &dst[0], n, samples_per_run, 16);
+
+			cout << endl;
+		}
+	}
+
+	return 0;
+}
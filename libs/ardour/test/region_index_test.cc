@@ -0,0 +1,181 @@
+/*
+    Copyright (C) 2015 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "pbd/compose.h"
+#include "ardour/region.h"
+#include "ardour/region_factory.h"
+#include "ardour/region_index.h"
+#include "region_index_test.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (RegionIndexTest);
+
+using namespace std;
+using namespace PBD;
+using namespace ARDOUR;
+
+struct RegionPositionSorter {
+	bool operator() (boost::shared_ptr<Region> a, boost::shared_ptr<Region> b) const {
+		return a->position() < b->position();
+	}
+};
+
+/** @return true if @param r has some part within @param start to @param end (inclusive) */
+static bool
+overlaps (boost::shared_ptr<Region> r, framepos_t start, framepos_t end)
+{
+	return r->length() > 0 && r->first_frame() <= end && r->last_frame() >= start;
+}
+
+/** @return the region that a walk of @param regions finds with the closest
+ *  first frame after @param frame (or before it, if not @param forwards),
+ *  taking the first in the list if several start at the same place.
+ */
+static boost::shared_ptr<Region>
+walk_next_start (RegionList const & regions, framepos_t frame, bool forwards)
+{
+	boost::shared_ptr<Region> best;
+
+	for (RegionList::const_iterator i = regions.begin(); i != regions.end(); ++i) {
+		framepos_t const pos = (*i)->first_frame();
+		if (forwards && pos > frame && (!best || pos < best->first_frame())) {
+			best = *i;
+		} else if (!forwards && pos < frame && (!best || pos > best->first_frame())) {
+			best = *i;
+		}
+	}
+
+	return best;
+}
+
+/** Build indices over random regions, including zero-length ones and ones
+ *  which start in the same place, in numbers either side of the sizes at
+ *  which the implicit tree gains a level, and check that every query gives
+ *  what a walk of the list would.
+ */
+void
+RegionIndexTest::randomTest ()
+{
+	srand (42);
+
+	int const sizes[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 14, 15, 16, 17, 31, 32, 33, 40, 63, 64, 65, 75, 100, 127, 150, 200, 255, 256, 257, 300 };
+
+	for (size_t s = 0; s < sizeof (sizes) / sizeof (sizes[0]); ++s) {
+		for (int trial = 0; trial < 4; ++trial) {
+
+			RegionList regions;
+
+			for (int i = 0; i < sizes[s]; ++i) {
+				PropertyList plist;
+				plist.add (Properties::start, 0);
+				/* one in five has no length */
+				plist.add (Properties::length, (rand() % 5) ? 1 + rand() % ((rand() % 4) ? 200 : 1000) : 0);
+				/* one in three starts where the one before does */
+				if (i > 0 && rand() % 3 == 0) {
+					plist.add (Properties::position, regions.back()->position());
+				} else {
+					plist.add (Properties::position, rand() % 1000);
+				}
+				regions.push_back (RegionFactory::create (_source, plist));
+			}
+
+			/* check both the position-ordered lists that playlists
+			   usually have, and lists in any order.
+			*/
+			if (trial % 2) {
+				vector<boost::shared_ptr<Region> > v (regions.begin(), regions.end());
+				stable_sort (v.begin(), v.end(), RegionPositionSorter ());
+				regions.assign (v.begin(), v.end());
+			}
+
+			RegionIndex index (regions.begin(), regions.end());
+			CPPUNIT_ASSERT_EQUAL (regions.size(), index.size());
+
+			/* query from random places, and from either side of every
+			   region's ends, which is where mistakes in the tree show.
+			*/
+			vector<framepos_t> starts;
+			for (int q = 0; q < 100; ++q) {
+				starts.push_back (rand() % 1400 - 200);
+			}
+			for (RegionList::const_iterator i = regions.begin(); i != regions.end(); ++i) {
+				for (int d = -1; d <= 1; ++d) {
+					starts.push_back ((*i)->first_frame() + d);
+					starts.push_back ((*i)->last_frame() + d);
+				}
+			}
+
+			for (vector<framepos_t>::const_iterator q = starts.begin(); q != starts.end(); ++q) {
+
+				framepos_t const start = *q;
+				framepos_t const end = start + rand() % 300;
+				string const what = string_compose ("%1 regions, trial %2, range %3 to %4", sizes[s], trial, start, end);
+
+				RegionList got;
+				RegionList expected;
+
+				index.touched (start, end, got);
+				for (RegionList::const_iterator i = regions.begin(); i != regions.end(); ++i) {
+					if (overlaps (*i, start, end)) {
+						expected.push_back (*i);
+					}
+				}
+				CPPUNIT_ASSERT_MESSAGE ("touched: " + what, got == expected);
+
+				got.clear ();
+				expected.clear ();
+				index.at (start, got);
+				for (RegionList::const_iterator i = regions.begin(); i != regions.end(); ++i) {
+					if ((*i)->covers (start)) {
+						expected.push_back (*i);
+					}
+				}
+				CPPUNIT_ASSERT_MESSAGE ("at: " + what, got == expected);
+				CPPUNIT_ASSERT_EQUAL_MESSAGE ("count_at: " + what, (uint32_t) expected.size(), index.count_at (start));
+
+				got.clear ();
+				expected.clear ();
+				index.with_start_within (start, end, got);
+				for (RegionList::const_iterator i = regions.begin(); i != regions.end(); ++i) {
+					if ((*i)->first_frame() >= start && (*i)->first_frame() <= end) {
+						expected.push_back (*i);
+					}
+				}
+				CPPUNIT_ASSERT_MESSAGE ("with_start_within: " + what, got == expected);
+
+				got.clear ();
+				expected.clear ();
+				index.with_end_within (start, end, got);
+				for (RegionList::const_iterator i = regions.begin(); i != regions.end(); ++i) {
+					if ((*i)->last_frame() >= start && (*i)->last_frame() <= end) {
+						expected.push_back (*i);
+					}
+				}
+				CPPUNIT_ASSERT_MESSAGE ("with_end_within: " + what, got == expected);
+
+				if (index.in_position_order ()) {
+					CPPUNIT_ASSERT_MESSAGE ("next_start forwards: " + what, index.next_start (start, true) == walk_next_start (regions, start, true));
+					CPPUNIT_ASSERT_MESSAGE ("next_start backwards: " + what, index.next_start (start, false) == walk_next_start (regions, start, false));
+				}
+			}
+		}
+	}
+}
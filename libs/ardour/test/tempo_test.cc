@@ -1,3 +1,8 @@
+#include <iomanip>
+#include <iostream>
+
+#include <glib.h>
+
 #include "ardour/tempo.h"
 #include "tempo_test.h"
 
@@ -48,3 +53,205 @@ TempoTest::recomputeMapTest ()
 	--i;
 	CPPUNIT_ASSERT_EQUAL (framepos_t (288e3), (*i)->frame ());
 }
+
+/* some of these have beats which are a whole number of frames long at
+   48kHz, but most do not, so that rounding matters to where a map
+   restarted part-way through puts things.
+*/
+static double const tempos[] = { 96, 97, 100, 113.7, 120, 125, 133, 150, 160, 171.3, 200, 240 };
+static int const n_tempos = sizeof (tempos) / sizeof (tempos[0]);
+
+/** Fill @param map with a tempo change at every bar, plus some off the
+ *  bar line, and a few meter changes, as a film score might have.
+ */
+void
+TempoTest::build_busy_map (TempoMap& map, uint32_t bars)
+{
+	for (uint32_t b = 2; b <= bars; ++b) {
+		map.add_tempo (Tempo (tempos[b % n_tempos]), BBT_Time (b, 1, 0));
+		if ((b % 7) == 0) {
+			map.add_tempo (Tempo (tempos[(b + 3) % n_tempos]), BBT_Time (b, 3, 0));
+		}
+		if ((b % 50) == 0) {
+			map.add_meter (Meter ((b % 100) ? 3 : 4, 4), BBT_Time (b, 1, 0));
+		}
+	}
+}
+
+/** Check that the map and section positions that @param map built up
+ *  incrementally are the same as a recompute from scratch gives.
+ */
+void
+TempoTest::check_against_full_recompute (TempoMap& map)
+{
+	TempoMap::BBTPointList const incremental (map._map);
+	vector<framepos_t> incremental_frames;
+
+	for (Metrics::const_iterator i = map.metrics.begin(); i != map.metrics.end(); ++i) {
+		incremental_frames.push_back ((*i)->frame ());
+	}
+
+	{
+		Glib::Threads::RWLock::WriterLock lm (map.lock);
+		map.recompute_map (false);
+	}
+
+	/* the two maps may stop at different places past the last section,
+	   but must agree up to there.
+	*/
+
+	size_t const n = min (incremental.size(), map._map.size());
+	CPPUNIT_ASSERT (n > 1);
+
+	for (size_t i = 0; i < n; ++i) {
+		CPPUNIT_ASSERT_EQUAL (map._map[i].frame, incremental[i].frame);
+		CPPUNIT_ASSERT_EQUAL (map._map[i].bar, incremental[i].bar);
+		CPPUNIT_ASSERT_EQUAL (map._map[i].beat, incremental[i].beat);
+		CPPUNIT_ASSERT (map._map[i].tempo == incremental[i].tempo);
+		CPPUNIT_ASSERT (map._map[i].meter == incremental[i].meter);
+	}
+
+	vector<framepos_t>::const_iterator f = incremental_frames.begin();
+	for (Metrics::const_iterator i = map.metrics.begin(); i != map.metrics.end(); ++i, ++f) {
+		CPPUNIT_ASSERT_EQUAL ((*i)->frame (), *f);
+	}
+}
+
+void
+TempoTest::incrementalRecomputeTest ()
+{
+	TempoMap map (48000);
+
+	build_busy_map (map, 400);
+	check_against_full_recompute (map);
+
+	/* change a tempo in the middle */
+	map.change_existing_tempo_at (map.frame_time (BBT_Time (200, 2, 0)), 150, 4);
+	check_against_full_recompute (map);
+
+	/* move one */
+	map.replace_tempo (map.tempo_section_at (map.frame_time (BBT_Time (140, 1, 0))), Tempo (96), BBT_Time (120, 1, 0));
+	check_against_full_recompute (map);
+
+	/* remove one */
+	map.remove_tempo (map.tempo_section_at (map.frame_time (BBT_Time (301, 1, 0))), true);
+	check_against_full_recompute (map);
+
+	/* change the meter, which moves tempo sections after it within their bars */
+	map.add_meter (Meter (5, 4), BBT_Time (98, 1, 0));
+	check_against_full_recompute (map);
+
+	map.replace_meter (map.meter_section_at (map.frame_time (BBT_Time (98, 1, 0))), Meter (7, 8), BBT_Time (60, 3, 0));
+	check_against_full_recompute (map);
+
+	map.remove_meter (map.meter_section_at (map.frame_time (BBT_Time (61, 1, 0))), true);
+	check_against_full_recompute (map);
+}
+
+void
+TempoTest::metricIndexTest ()
+{
+	TempoMap map (48000);
+
+	build_busy_map (map, 300);
+
+	framepos_t const end = map.frame_time (BBT_Time (305, 1, 0));
+
+	for (framepos_t f = 0; f < end; f += 7919) {
+
+		/* the sections in effect at f, found by walking the list */
+
+		const TempoSection* tempo = 0;
+		const MeterSection* meter = 0;
+		const MetricSection* last = 0;
+
+		for (Metrics::const_iterator i = map.metrics.begin(); i != map.metrics.end(); ++i) {
+			if ((*i)->frame() > f) {
+				break;
+			}
+			if (dynamic_cast<const TempoSection*> (*i)) {
+				tempo = dynamic_cast<const TempoSection*> (*i);
+			} else {
+				meter = dynamic_cast<const MeterSection*> (*i);
+			}
+			last = *i;
+		}
+
+		Metrics::const_iterator li;
+		TempoMetric const m = map.metric_at (f, &li);
+
+		CPPUNIT_ASSERT (&m.tempo() == static_cast<const Tempo*> (tempo));
+		CPPUNIT_ASSERT (&m.meter() == static_cast<const Meter*> (meter));
+		CPPUNIT_ASSERT (*li == last);
+		CPPUNIT_ASSERT_EQUAL (last->frame(), m.frame());
+		CPPUNIT_ASSERT (&map.tempo_section_at (f) == tempo);
+		CPPUNIT_ASSERT (&map.meter_section_at (f) == meter);
+
+		BBT_Time bbt;
+		map.bbt_time (f, bbt);
+		CPPUNIT_ASSERT_EQUAL (m.frame(), map.metric_at (bbt).frame());
+	}
+}
+
+/** Time @param n calls of @param op, and print how long each took. */
+template<typename Op> static void
+time_lookups (char const * what, Op op, int n)
+{
+	gint64 const start = g_get_monotonic_time ();
+	for (int i = 0; i < n; ++i) {
+		op (i);
+	}
+	gint64 const usecs = max ((gint64) 1, g_get_monotonic_time () - start);
+
+	cout << " " << what << " " << fixed << setprecision (3) << (double) usecs / n << " us";
+}
+
+struct MetricAt {
+	MetricAt (TempoMap& m, framepos_t e) : map (m), end (e) {}
+	void operator() (int i) { map.metric_at ((framepos_t) ((i * 7919LL) % end)); }
+	TempoMap& map;
+	framepos_t end;
+};
+
+struct BBTTime {
+	BBTTime (TempoMap& m, framepos_t e) : map (m), end (e) {}
+	void operator() (int i) { BBT_Time bbt; map.bbt_time ((framepos_t) ((i * 7919LL) % end), bbt); }
+	TempoMap& map;
+	framepos_t end;
+};
+
+struct PlusBeats {
+	PlusBeats (TempoMap& m, framepos_t e) : map (m), end (e) {}
+	void operator() (int i) { map.framepos_plus_beats ((framepos_t) ((i * 7919LL) % end), Evoral::Beats (1)); }
+	TempoMap& map;
+	framepos_t end;
+};
+
+struct ChangeTempo {
+	ChangeTempo (TempoMap& m, framepos_t e) : map (m), end (e) {}
+	void operator() (int i) { map.change_existing_tempo_at (end - 1 - (i * 7919LL) % (end / 10), tempos[i % n_tempos], 4); }
+	TempoMap& map;
+	framepos_t end;
+};
+
+void
+TempoTest::lookupBenchmark ()
+{
+	uint32_t const bars = 5000;
+	TempoMap map (48000);
+
+	gint64 const start = g_get_monotonic_time ();
+	build_busy_map (map, bars);
+	gint64 const usecs = g_get_monotonic_time () - start;
+
+	framepos_t const end = map.frame_time (BBT_Time (bars, 1, 0));
+
+	cout << endl << map.n_tempos() << " tempos, built in " << usecs / 1000 << " ms;";
+
+	time_lookups ("metric_at", MetricAt (map, end), 100000);
+	time_lookups ("bbt_time", BBTTime (map, end), 100000);
+	time_lookups ("framepos_plus_beats", PlusBeats (map, end), 100000);
+	time_lookups ("edit near the end", ChangeTempo (map, end), 100);
+
+	cout << endl;
+}
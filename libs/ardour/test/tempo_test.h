@@ -6,6 +6,9 @@ class TempoTest : public CppUnit::TestFixture
 {
 	CPPUNIT_TEST_SUITE (TempoTest);
 	CPPUNIT_TEST (recomputeMapTest);
+	CPPUNIT_TEST (incrementalRecomputeTest);
+	CPPUNIT_TEST (metricIndexTest);
+	CPPUNIT_TEST (lookupBenchmark);
 	CPPUNIT_TEST_SUITE_END ();
 
 public:
@@ -13,5 +16,12 @@ public:
 	void tearDown () {}
 
 	void recomputeMapTest ();
+	void incrementalRecomputeTest ();
+	void metricIndexTest ();
+	void lookupBenchmark ();
+
+private:
+	void build_busy_map (ARDOUR::TempoMap&, uint32_t bars);
+	void check_against_full_recompute (ARDOUR::TempoMap&);
 };
 
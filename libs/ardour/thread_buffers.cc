@@ -37,6 +37,7 @@ ThreadBuffers::ThreadBuffers ()
 	, send_gain_automation_buffer (0)
 	, pan_automation_buffer (0)
 	, npan_buffers (0)
+	, dsp_timings (DSPProfiler::add_timings ())
 {
 }
 
@@ -692,6 +692,12 @@ Track::do_refill ()
 	return _diskstream->do_refill ();
 }
 
+void
+Track::prefetch (DiskReadAhead& ra)
+{
+	_diskstream->prefetch (ra);
+}
+
 int
 Track::do_flush (RunContext c, bool force)
 {
@@ -568,6 +568,8 @@ AlsaAudioBackend::_start (bool for_latency_measurement)
 		_system_midi_in.clear();
 		_system_midi_out.clear();
 		_ports.clear();
+		_portmap.clear();
+		_portset.clear();
 	}
 
 	/* reset internal state */
@@ -932,7 +934,19 @@ AlsaAudioBackend::set_port_name (PortEngine::PortHandle port, const std::string&
 		PBD::error << _("AlsaBackend::set_port_name: Invalid Port(s)") << endmsg;
 		return -1;
 	}
-	return static_cast<AlsaPort*>(port)->set_name (_instance_name + ":" + name);
+	AlsaPort* p = static_cast<AlsaPort*>(port);
+	const std::string newname (_instance_name + ":" + name);
+	if (newname == p->name ()) {
+		return 0;
+	}
+	if (find_port (newname)) {
+		PBD::error << _("AlsaBackend::set_port_name: Port with given name already exists") << endmsg;
+		return -1;
+	}
+	_portmap.erase (p->name ());
+	int rv = p->set_name (newname);
+	_portmap.insert (std::make_pair (p->name (), p));
+	return rv;
 }
 
 std::string
@@ -945,6 +959,73 @@ AlsaAudioBackend::get_port_name (PortEngine::PortHandle port) const
 	return static_cast<AlsaPort*>(port)->name ();
 }
 
+/** @return the literal text which every match of @param pattern, an extended
+ * regular expression, must start with; or an empty string if the pattern is
+ * not anchored, or starts with anything other than plain characters.
+ */
+static std::string
+regex_literal_prefix (const std::string& pattern)
+{
+	if (pattern.size () < 2 || pattern[0] != '^') {
+		return std::string ();
+	}
+
+	/* an alternative outside any group is not bound by the anchor */
+	const std::string::size_type len = pattern.size ();
+	int depth = 0;
+	for (std::string::size_type i = 1; i < len; ++i) {
+		switch (pattern[i]) {
+			case '\\': ++i; break;
+			case '(': ++depth; break;
+			case ')': --depth; break;
+			case '|':
+				if (depth == 0) {
+					return std::string ();
+				}
+				break;
+			case '[':
+				/* skip a bracket expression, in which nothing is special;
+				 * a leading ']' is literal, and "[:alpha:]" and the like
+				 * may contain one.
+				 */
+				++i;
+				if (i < len && pattern[i] == '^') { ++i; }
+				if (i < len && pattern[i] == ']') { ++i; }
+				while (i < len && pattern[i] != ']') {
+					if (pattern[i] == '[' && i + 1 < len && strchr (":.=", pattern[i + 1])) {
+						const char close[] = { pattern[i + 1], ']', '\0' };
+						const std::string::size_type e = pattern.find (close, i + 2);
+						if (e == std::string::npos) {
+							return std::string ();
+						}
+						i = e + 2;
+					} else {
+						++i;
+					}
+				}
+				break;
+		}
+	}
+
+	std::string prefix;
+
+	for (std::string::size_type i = 1; i < pattern.size (); ++i) {
+		const char c = pattern[i];
+		if (strchr (".[]()*+?{}|\\^$", c)) {
+			if (c == '*' || c == '?' || c == '{') {
+				/* the last character was optional */
+				if (!prefix.empty ()) {
+					prefix.erase (prefix.size () - 1);
+				}
+			}
+			break;
+		}
+		prefix += c;
+	}
+
+	return prefix;
+}
+
 PortEngine::PortHandle
 AlsaAudioBackend::get_port_by_name (const std::string& name) const
 {
@@ -966,12 +1047,30 @@ AlsaAudioBackend::get_ports (
 			use_regexp = true;
 		}
 	}
-	for (size_t i = 0; i < _ports.size (); ++i) {
-		AlsaPort* port = _ports[i];
-		if ((port->type () == type) && flags == (port->flags () & flags)) {
-			if (!use_regexp || !regexec (&port_regex, port->name ().c_str (), 0, NULL, 0)) {
-				port_names.push_back (port->name ());
-				++rv;
+	const std::string prefix = use_regexp ? regex_literal_prefix (port_name_pattern) : std::string ();
+	if (!prefix.empty ()) {
+		/* only ports whose names start with the prefix can match,
+		 * and the name index holds those together (in name order).
+		 */
+		for (PortMap::const_iterator it = _portmap.lower_bound (prefix);
+				it != _portmap.end () && it->first.compare (0, prefix.size (), prefix) == 0;
+				++it) {
+			AlsaPort* port = it->second;
+			if ((port->type () == type) && flags == (port->flags () & flags)) {
+				if (!regexec (&port_regex, port->name ().c_str (), 0, NULL, 0)) {
+					port_names.push_back (port->name ());
+					++rv;
+				}
+			}
+		}
+	} else {
+		for (size_t i = 0; i < _ports.size (); ++i) {
+			AlsaPort* port = _ports[i];
+			if ((port->type () == type) && flags == (port->flags () & flags)) {
+				if (!use_regexp || !regexec (&port_regex, port->name ().c_str (), 0, NULL, 0)) {
+					port_names.push_back (port->name ());
+					++rv;
+				}
 			}
 		}
 	}
@@ -1027,6 +1126,8 @@ AlsaAudioBackend::add_port (
 	}
 
 	_ports.push_back (port);
+	_portmap.insert (std::make_pair (name, port));
+	_portset.insert (port);
 
 	return port;
 }
@@ -1038,13 +1139,14 @@ AlsaAudioBackend::unregister_port (PortEngine::PortHandle port_handle)
 		return;
 	}
 	AlsaPort* port = static_cast<AlsaPort*>(port_handle);
-	std::vector<AlsaPort*>::iterator i = std::find (_ports.begin (), _ports.end (), static_cast<AlsaPort*>(port_handle));
-	if (i == _ports.end ()) {
+	if (!valid_port (port_handle)) {
 		PBD::error << _("AlsaBackend::unregister_port: Failed to find port") << endmsg;
 		return;
 	}
 	disconnect_all(port_handle);
-	_ports.erase (i);
+	_ports.erase (std::find (_ports.begin (), _ports.end (), port));
+	_portmap.erase (port->name ());
+	_portset.erase (port);
 	delete port;
 }
 
@@ -1179,21 +1281,24 @@ AlsaAudioBackend::register_system_midi_ports()
 void
 AlsaAudioBackend::unregister_ports (bool system_only)
 {
-	size_t i = 0;
 	_system_inputs.clear();
 	_system_outputs.clear();
 	_system_midi_in.clear();
 	_system_midi_out.clear();
-	while (i <  _ports.size ()) {
-		AlsaPort* port = _ports[i];
+
+	std::vector<AlsaPort*>::iterator kept = _ports.begin ();
+	for (std::vector<AlsaPort*>::iterator i = _ports.begin (); i != _ports.end (); ++i) {
+		AlsaPort* port = *i;
 		if (! system_only || (port->is_physical () && port->is_terminal ())) {
 			port->disconnect_all ();
+			_portmap.erase (port->name ());
+			_portset.erase (port);
 			delete port;
-			_ports.erase (_ports.begin() + i);
 		} else {
-			++i;
+			*kept++ = port;
 		}
 	}
+	_ports.erase (kept, _ports.end ());
 }
 
 int
@@ -1328,11 +1433,11 @@ AlsaAudioBackend::midi_event_get (
 	if (event_index >= source.size ()) {
 		return -1;
 	}
-	AlsaMidiEvent * const event = source[event_index].get ();
+	AlsaMidiEvent& event = source[event_index];
 
-	timestamp = event->timestamp ();
-	size = event->size ();
-	*buf = event->data ();
+	timestamp = event.timestamp ();
+	size = event.size ();
+	*buf = event.data ();
 	return 0;
 }
 
@@ -1344,15 +1449,14 @@ AlsaAudioBackend::midi_event_put (
 {
 	assert (buffer && port_buffer);
 	AlsaMidiBuffer& dst = * static_cast<AlsaMidiBuffer*>(port_buffer);
-	if (dst.size () && (pframes_t)dst.back ()->timestamp () > timestamp) {
+	if (dst.size () && (pframes_t)dst.back ().timestamp () > timestamp) {
 #ifndef NDEBUG
 		// nevermind, ::get_buffer() sorts events
 		fprintf (stderr, "AlsaMidiBuffer: it's too late for this event. %d > %d\n",
-				(pframes_t)dst.back ()->timestamp (), timestamp);
+				(pframes_t)dst.back ().timestamp (), timestamp);
 #endif
 	}
-	dst.push_back (boost::shared_ptr<AlsaMidiEvent>(new AlsaMidiEvent (timestamp, buffer, size)));
-	return 0;
+	return dst.push_back (timestamp, buffer, size);
 }
 
 uint32_t
@@ -1619,7 +1723,7 @@ AlsaAudioBackend::main_process_thread ()
 					AlsaMidiOut *rm = _rmidi_out.at(i);
 					rm->sync_time (clock1);
 					for (AlsaMidiBuffer::const_iterator mit = src->begin (); mit != src->end (); ++mit) {
-						rm->send_event ((*mit)->timestamp(), (*mit)->data(), (*mit)->size());
+						rm->send_event (mit->timestamp(), mit->const_data(), mit->size());
 					}
 				}
 
@@ -1969,12 +2073,6 @@ AlsaMidiPort::AlsaMidiPort (AlsaAudioBackend &b, const std::string& name, PortFl
 
 AlsaMidiPort::~AlsaMidiPort () { }
 
-struct MidiEventSorter {
-	bool operator() (const boost::shared_ptr<AlsaMidiEvent>& a, const boost::shared_ptr<AlsaMidiEvent>& b) {
-		return *a < *b;
-	}
-};
-
 void* AlsaMidiPort::get_buffer (pframes_t /* nframes */)
 {
 	if (is_input ()) {
@@ -1982,38 +2080,100 @@ void* AlsaMidiPort::get_buffer (pframes_t /* nframes */)
 		for (std::vector<AlsaPort*>::const_iterator i = get_connections ().begin ();
 				i != get_connections ().end ();
 				++i) {
-			const AlsaMidiBuffer * src = static_cast<const AlsaMidiPort*>(*i)->const_buffer ();
-			for (AlsaMidiBuffer::const_iterator it = src->begin (); it != src->end (); ++it) {
-				(_buffer[_bufperiod]).push_back (boost::shared_ptr<AlsaMidiEvent>(new AlsaMidiEvent (**it)));
-			}
+			(_buffer[_bufperiod]).merge (*static_cast<const AlsaMidiPort*>(*i)->const_buffer ());
 		}
-		std::sort ((_buffer[_bufperiod]).begin (), (_buffer[_bufperiod]).end (), MidiEventSorter());
 	}
 	return &(_buffer[_bufperiod]);
 }
 
-AlsaMidiEvent::AlsaMidiEvent (const pframes_t timestamp, const uint8_t* data, size_t size)
-	: _size (size)
-	, _timestamp (timestamp)
-	, _data (0)
+AlsaMidiBuffer::AlsaMidiBuffer ()
+	: _used (0)
+	, _sorted (true)
+{
+	_events.reserve (max_events);
+	_data.resize (max_data);
+}
+
+int
+AlsaMidiBuffer::push_back (pframes_t timestamp, const uint8_t* data, size_t size)
 {
-	if (size > 0) {
-		_data = (uint8_t*) malloc (size);
-		memcpy (_data, data, size);
+	if (_events.size () >= max_events || _used + size > max_data) {
+		fprintf (stderr, "AlsaMidiBuffer: buffer is full, event dropped.\n");
+		return -1;
+	}
+	if (!_events.empty () && timestamp < _events.back ().timestamp ()) {
+		_sorted = false;
 	}
+	uint8_t* const dst = &_data[0] + _used;
+	memcpy (dst, data, size);
+	_used += size;
+	_events.push_back (AlsaMidiEvent (timestamp, dst, size));
+	return 0;
 }
 
-AlsaMidiEvent::AlsaMidiEvent (const AlsaMidiEvent& other)
-	: _size (other.size ())
-	, _timestamp (other.timestamp ())
-	, _data (0)
+/** Add the events of @param src to this buffer, keeping it in time order;
+ * events with the same time as some already here go after them.
+ */
+void
+AlsaMidiBuffer::merge (const AlsaMidiBuffer& src)
 {
-	if (other.size () && other.const_data ()) {
-		_data = (uint8_t*) malloc (other.size ());
-		memcpy (_data, other.const_data (), other.size ());
+	const size_t n = _events.size ();
+	const size_t m = src._events.size ();
+
+	if (m == 0) {
+		return;
 	}
-};
 
-AlsaMidiEvent::~AlsaMidiEvent () {
-	free (_data);
+	if (!_sorted || !src._sorted || n + m > max_events || _used + src._used > max_data) {
+		for (const_iterator it = src.begin (); it != src.end (); ++it) {
+			push_back (it->timestamp (), it->const_data (), it->size ());
+		}
+		sort ();
+		return;
+	}
+
+	/* copy all of the source's data in one go; its events keep their
+	 * offsets within it.
+	 */
+	uint8_t* const base = &_data[0] + _used;
+	memcpy (base, &src._data[0], src._used);
+	_used += src._used;
+
+	/* then merge the two lists from the back, so that no scratch space
+	 * is needed.
+	 */
+	_events.resize (n + m);
+
+	size_t i = n;
+	size_t j = m;
+	size_t k = n + m;
+
+	while (j > 0) {
+		const AlsaMidiEvent& e = src._events[j - 1];
+		if (i > 0 && e.timestamp () < _events[i - 1].timestamp ()) {
+			_events[--k] = _events[--i];
+		} else {
+			_events[--k] = AlsaMidiEvent (e.timestamp (), base + (e.const_data () - &src._data[0]), e.size ());
+			--j;
+		}
+	}
+}
+
+struct MidiEventSorter {
+	bool operator() (const AlsaMidiEvent& a, const AlsaMidiEvent& b) {
+		if (a.timestamp () != b.timestamp ()) {
+			return a.timestamp () < b.timestamp ();
+		}
+		/* data is stored in the order the events were added */
+		return a.const_data () < b.const_data ();
+	}
 };
+
+void
+AlsaMidiBuffer::sort ()
+{
+	if (!_sorted) {
+		std::sort (_events.begin (), _events.end (), MidiEventSorter ());
+		_sorted = true;
+	}
+}
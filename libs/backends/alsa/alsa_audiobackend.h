@@ -44,21 +44,58 @@ class AlsaAudioBackend;
 
 class AlsaMidiEvent {
 	public:
-		AlsaMidiEvent (const pframes_t timestamp, const uint8_t* data, size_t size);
-		AlsaMidiEvent (const AlsaMidiEvent& other);
-		~AlsaMidiEvent ();
+		AlsaMidiEvent () : _size (0), _timestamp (0), _data (0) {};
+		AlsaMidiEvent (const pframes_t timestamp, uint8_t* data, size_t size)
+			: _size (size), _timestamp (timestamp), _data (data) {};
 		size_t size () const { return _size; };
 		pframes_t timestamp () const { return _timestamp; };
 		const unsigned char* const_data () const { return _data; };
 		unsigned char* data () { return _data; };
 		bool operator< (const AlsaMidiEvent &other) const { return timestamp () < other.timestamp (); };
 	private:
-		size_t _size;
+		uint32_t _size;
 		pframes_t _timestamp;
 		uint8_t *_data;
 };
 
-typedef std::vector<boost::shared_ptr<AlsaMidiEvent> > AlsaMidiBuffer;
+/** The MIDI events of one port for one cycle.
+ *
+ * Event data is stored in place in a pool of bytes which is allocated
+ * along with the buffer, and the events refer into it, so that filling,
+ * copying and merging buffers never allocates in the process thread.
+ * Events which do not fit are dropped.
+ */
+class AlsaMidiBuffer {
+	public:
+		AlsaMidiBuffer ();
+
+		typedef std::vector<AlsaMidiEvent>::const_iterator const_iterator;
+
+		size_t size () const { return _events.size (); }
+		bool empty () const { return _events.empty (); }
+		const_iterator begin () const { return _events.begin (); }
+		const_iterator end () const { return _events.end (); }
+		AlsaMidiEvent& operator[] (size_t i) { return _events[i]; }
+		const AlsaMidiEvent& back () const { return _events.back (); }
+
+		void clear () { _events.clear (); _used = 0; _sorted = true; }
+		int push_back (pframes_t timestamp, const uint8_t* data, size_t size);
+		void merge (const AlsaMidiBuffer& src);
+		void sort ();
+
+		static const size_t max_events = 2048;
+		static const size_t max_data = 8192;
+
+	private:
+		/* the events point into _data, so may not be copied elsewhere */
+		AlsaMidiBuffer (const AlsaMidiBuffer&);
+		AlsaMidiBuffer& operator= (const AlsaMidiBuffer&);
+
+		std::vector<AlsaMidiEvent> _events;
+		std::vector<uint8_t> _data;
+		size_t _used;
+		bool   _sorted; ///< true if _events is in time order
+};
 
 class AlsaPort {
 	protected:
@@ -384,6 +421,11 @@ class AlsaAudioBackend : public AudioBackend {
 		void unregister_ports (bool system_only = false);
 
 		std::vector<AlsaPort *> _ports;
+
+		/* _ports indexed by name, which also serves prefix queries, and by handle */
+		typedef std::map<std::string, AlsaPort *> PortMap;
+		PortMap _portmap;
+		std::set<AlsaPort *> _portset;
 		std::vector<AlsaPort *> _system_inputs;
 		std::vector<AlsaPort *> _system_outputs;
 		std::vector<AlsaPort *> _system_midi_in;
@@ -418,16 +460,15 @@ class AlsaAudioBackend : public AudioBackend {
 		}
 
 		bool valid_port (PortHandle port) const {
-			return std::find (_ports.begin (), _ports.end (), (AlsaPort*)port) != _ports.end ();
+			return _portset.find (static_cast<AlsaPort*>(port)) != _portset.end ();
 		}
 
 		AlsaPort * find_port (const std::string& port_name) const {
-			for (std::vector<AlsaPort*>::const_iterator it = _ports.begin (); it != _ports.end (); ++it) {
-				if ((*it)->name () == port_name) {
-					return *it;
-				}
+			PortMap::const_iterator it = _portmap.find (port_name);
+			if (it == _portmap.end ()) {
+				return NULL;
 			}
-			return NULL;
+			return it->second;
 		}
 
 }; // class AlsaAudioBackend
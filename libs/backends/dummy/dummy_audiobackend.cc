@@ -30,6 +30,7 @@
 #include "dummy_audiobackend.h"
 #include "dummy_midi_seq.h"
 
+#include "pbd/compose.h"
 #include "pbd/error.h"
 #include "ardour/port_manager.h"
 #include "i18n.h"
@@ -40,6 +41,7 @@ static std::string s_instance_name;
 size_t DummyAudioBackend::_max_buffer_size = 8192;
 std::vector<std::string> DummyAudioBackend::_midi_options;
 std::vector<AudioBackend::DeviceStatus> DummyAudioBackend::_device_status;
+std::vector<DummyAudioBackend::DriverSpeed> DummyAudioBackend::_driver_speed;
 
 #ifdef PLATFORM_WINDOWS
 static double _win_pc_rate = 0; // usec per tick
@@ -64,6 +66,7 @@ DummyAudioBackend::DummyAudioBackend (AudioEngine& e, AudioBackendInfo& info)
 	, _running (false)
 	, _freewheel (false)
 	, _freewheeling (false)
+	, _speedup (1.0)
 	, _device ("")
 	, _samplerate (48000)
 	, _samples_per_period (1024)
@@ -76,6 +79,8 @@ DummyAudioBackend::DummyAudioBackend (AudioEngine& e, AudioBackendInfo& info)
 	, _systemic_input_latency (0)
 	, _systemic_output_latency (0)
 	, _processed_samples (0)
+	, _process_cycles (0)
+	, _process_usecs (0)
 	, _port_change_flag (false)
 {
 	_instance_name = s_instance_name;
@@ -102,6 +107,52 @@ DummyAudioBackend::is_realtime () const
 	return false;
 }
 
+std::vector<std::string>
+DummyAudioBackend::enumerate_drivers () const
+{
+	if (_driver_speed.empty()) {
+		_driver_speed.push_back (DriverSpeed (X_("Half Speed"),    _("Half Speed"),     0.5f));
+		_driver_speed.push_back (DriverSpeed (X_("Normal Speed"),  _("Normal Speed"),   1.0f));
+		_driver_speed.push_back (DriverSpeed (X_("Double Speed"),  _("Double Speed"),   2.0f));
+		_driver_speed.push_back (DriverSpeed (X_("5 x Speed"),     _("5 x Speed"),      5.0f));
+		_driver_speed.push_back (DriverSpeed (X_("10 x Speed"),    _("10 x Speed"),    10.0f));
+		_driver_speed.push_back (DriverSpeed (X_("50 x Speed"),    _("50 x Speed"),    50.0f));
+		/* run process cycles back-to-back, as fast as the CPU allows */
+		_driver_speed.push_back (DriverSpeed (X_("Maximum Speed"), _("Maximum Speed"),  0.0f));
+	}
+
+	std::vector<std::string> speed_drivers;
+	for (std::vector<DriverSpeed>::const_iterator it = _driver_speed.begin () ; it != _driver_speed.end (); ++it) {
+		speed_drivers.push_back (it->name);
+	}
+	return speed_drivers;
+}
+
+std::string
+DummyAudioBackend::driver_name () const
+{
+	for (std::vector<DriverSpeed>::const_iterator it = _driver_speed.begin () ; it != _driver_speed.end (); ++it) {
+		if (it->speedup == _speedup) {
+			return it->name;
+		}
+	}
+	return _("Normal Speed");
+}
+
+int
+DummyAudioBackend::set_driver (const std::string& d)
+{
+	enumerate_drivers ();
+	for (std::vector<DriverSpeed>::const_iterator it = _driver_speed.begin () ; it != _driver_speed.end (); ++it) {
+		if (d == it->name || d == it->key) {
+			_speedup = it->speedup;
+			return 0;
+		}
+	}
+	PBD::error << string_compose (_("DummyAudioBackend: unknown driver '%1'."), d) << endmsg;
+	return -1;
+}
+
 std::vector<AudioBackend::DeviceStatus>
 DummyAudioBackend::enumerate_devices () const
 {
@@ -397,6 +448,8 @@ DummyAudioBackend::_start (bool /*for_latency_measurement*/)
 		_system_midi_in.clear();
 		_system_midi_out.clear();
 		_ports.clear();
+		_portmap.clear();
+		_portset.clear();
 	}
 
 	if (register_system_ports()) {
@@ -444,6 +497,14 @@ DummyAudioBackend::stop ()
 		PBD::error << _("DummyAudioBackend: failed to terminate.") << endmsg;
 		return -1;
 	}
+
+	if (_speedup != 1.0f && _process_usecs > 0) {
+		const double secs = _process_usecs / 1e6;
+		PBD::info << string_compose (_("DummyAudioBackend: %1 cycles in %2 sec: %3 cycles/sec, %4 x realtime."),
+				_process_cycles, secs, _process_cycles / secs,
+				_process_cycles * _samples_per_period / (secs * _samplerate)) << endmsg;
+	}
+
 	unregister_ports();
 	return 0;
 }
@@ -604,7 +665,19 @@ DummyAudioBackend::set_port_name (PortEngine::PortHandle port, const std::string
 		PBD::error << _("DummyBackend::set_port_name: Invalid Port(s)") << endmsg;
 		return -1;
 	}
-	return static_cast<DummyPort*>(port)->set_name (_instance_name + ":" + name);
+	DummyPort* p = static_cast<DummyPort*>(port);
+	const std::string newname (_instance_name + ":" + name);
+	if (newname == p->name ()) {
+		return 0;
+	}
+	if (find_port (newname)) {
+		PBD::error << _("DummyBackend::set_port_name: Port with given name already exists") << endmsg;
+		return -1;
+	}
+	_portmap.erase (p->name ());
+	int rv = p->set_name (newname);
+	_portmap.insert (std::make_pair (p->name (), p));
+	return rv;
 }
 
 std::string
@@ -617,6 +690,73 @@ DummyAudioBackend::get_port_name (PortEngine::PortHandle port) const
 	return static_cast<DummyPort*>(port)->name ();
 }
 
+/** @return the literal text which every match of @param pattern, an extended
+ * regular expression, must start with; or an empty string if the pattern is
+ * not anchored, or starts with anything other than plain characters.
+ */
+static std::string
+regex_literal_prefix (const std::string& pattern)
+{
+	if (pattern.size () < 2 || pattern[0] != '^') {
+		return std::string ();
+	}
+
+	/* an alternative outside any group is not bound by the anchor */
+	const std::string::size_type len = pattern.size ();
+	int depth = 0;
+	for (std::string::size_type i = 1; i < len; ++i) {
+		switch (pattern[i]) {
+			case '\\': ++i; break;
+			case '(': ++depth; break;
+			case ')': --depth; break;
+			case '|':
+				if (depth == 0) {
+					return std::string ();
+				}
+				break;
+			case '[':
+				/* skip a bracket expression, in which nothing is special;
+				 * a leading ']' is literal, and "[:alpha:]" and the like
+				 * may contain one.
+				 */
+				++i;
+				if (i < len && pattern[i] == '^') { ++i; }
+				if (i < len && pattern[i] == ']') { ++i; }
+				while (i < len && pattern[i] != ']') {
+					if (pattern[i] == '[' && i + 1 < len && strchr (":.=", pattern[i + 1])) {
+						const char close[] = { pattern[i + 1], ']', '\0' };
+						const std::string::size_type e = pattern.find (close, i + 2);
+						if (e == std::string::npos) {
+							return std::string ();
+						}
+						i = e + 2;
+					} else {
+						++i;
+					}
+				}
+				break;
+		}
+	}
+
+	std::string prefix;
+
+	for (std::string::size_type i = 1; i < pattern.size (); ++i) {
+		const char c = pattern[i];
+		if (strchr (".[]()*+?{}|\\^$", c)) {
+			if (c == '*' || c == '?' || c == '{') {
+				/* the last character was optional */
+				if (!prefix.empty ()) {
+					prefix.erase (prefix.size () - 1);
+				}
+			}
+			break;
+		}
+		prefix += c;
+	}
+
+	return prefix;
+}
+
 PortEngine::PortHandle
 DummyAudioBackend::get_port_by_name (const std::string& name) const
 {
@@ -638,12 +778,30 @@ DummyAudioBackend::get_ports (
 			use_regexp = true;
 		}
 	}
-	for (size_t i = 0; i < _ports.size (); ++i) {
-		DummyPort* port = _ports[i];
-		if ((port->type () == type) && flags == (port->flags () & flags)) {
-			if (!use_regexp || !regexec (&port_regex, port->name ().c_str (), 0, NULL, 0)) {
-				port_names.push_back (port->name ());
-				++rv;
+	const std::string prefix = use_regexp ? regex_literal_prefix (port_name_pattern) : std::string ();
+	if (!prefix.empty ()) {
+		/* only ports whose names start with the prefix can match,
+		 * and the name index holds those together (in name order).
+		 */
+		for (PortMap::const_iterator it = _portmap.lower_bound (prefix);
+				it != _portmap.end () && it->first.compare (0, prefix.size (), prefix) == 0;
+				++it) {
+			DummyPort* port = it->second;
+			if ((port->type () == type) && flags == (port->flags () & flags)) {
+				if (!regexec (&port_regex, port->name ().c_str (), 0, NULL, 0)) {
+					port_names.push_back (port->name ());
+					++rv;
+				}
+			}
+		}
+	} else {
+		for (size_t i = 0; i < _ports.size (); ++i) {
+			DummyPort* port = _ports[i];
+			if ((port->type () == type) && flags == (port->flags () & flags)) {
+				if (!use_regexp || !regexec (&port_regex, port->name ().c_str (), 0, NULL, 0)) {
+					port_names.push_back (port->name ());
+					++rv;
+				}
 			}
 		}
 	}
@@ -702,6 +860,8 @@ DummyAudioBackend::add_port (
 	}
 
 	_ports.push_back (port);
+	_portmap.insert (std::make_pair (name, port));
+	_portset.insert (port);
 
 	return port;
 }
@@ -715,13 +875,14 @@ DummyAudioBackend::unregister_port (PortEngine::PortHandle port_handle)
 		return;
 	}
 	DummyPort* port = static_cast<DummyPort*>(port_handle);
-	std::vector<DummyPort*>::iterator i = std::find (_ports.begin (), _ports.end (), static_cast<DummyPort*>(port_handle));
-	if (i == _ports.end ()) {
+	if (!valid_port (port_handle)) {
 		PBD::error << _("DummyBackend::unregister_port: Failed to find port") << endmsg;
 		return;
 	}
 	disconnect_all(port_handle);
-	_ports.erase (i);
+	_ports.erase (std::find (_ports.begin (), _ports.end (), port));
+	_portmap.erase (port->name ());
+	_portset.erase (port);
 	delete port;
 }
 
@@ -824,16 +985,19 @@ DummyAudioBackend::unregister_ports (bool system_only)
 	_system_midi_in.clear();
 	_system_midi_out.clear();
 
-	for (std::vector<DummyPort*>::iterator i = _ports.begin (); i != _ports.end ();) {
+	std::vector<DummyPort*>::iterator kept = _ports.begin ();
+	for (std::vector<DummyPort*>::iterator i = _ports.begin (); i != _ports.end (); ++i) {
 		DummyPort* port = *i;
 		if (! system_only || (port->is_physical () && port->is_terminal ())) {
 			port->disconnect_all ();
+			_portmap.erase (port->name ());
+			_portset.erase (port);
 			delete port;
-			i = _ports.erase (i);
 		} else {
-			++i;
+			*kept++ = port;
 		}
 	}
+	_ports.erase (kept, _ports.end ());
 }
 
 int
@@ -968,11 +1132,11 @@ DummyAudioBackend::midi_event_get (
 	if (event_index >= source.size ()) {
 		return -1;
 	}
-	DummyMidiEvent * const event = source[event_index].get ();
+	DummyMidiEvent& event = source[event_index];
 
-	timestamp = event->timestamp ();
-	size = event->size ();
-	*buf = event->data ();
+	timestamp = event.timestamp ();
+	size = event.size ();
+	*buf = event.data ();
 	return 0;
 }
 
@@ -984,12 +1148,11 @@ DummyAudioBackend::midi_event_put (
 {
 	assert (buffer && port_buffer);
 	DummyMidiBuffer& dst = * static_cast<DummyMidiBuffer*>(port_buffer);
-	if (dst.size () && (pframes_t)dst.back ()->timestamp () > timestamp) {
+	if (dst.size () && (pframes_t)dst.back ().timestamp () > timestamp) {
 		// nevermind, ::get_buffer() sorts events, but always print warning
 		fprintf (stderr, "DummyMidiBuffer: it's too late for this event.\n");
 	}
-	dst.push_back (boost::shared_ptr<DummyMidiEvent>(new DummyMidiEvent (timestamp, buffer, size)));
-	return 0;
+	return dst.push_back (timestamp, buffer, size);
 }
 
 uint32_t
@@ -1169,10 +1332,14 @@ DummyAudioBackend::main_process_thread ()
 	AudioEngine::thread_init_callback (this);
 	_running = true;
 	_processed_samples = 0;
+	_process_cycles = 0;
+	_process_usecs = 0;
 
 	manager.registration_callback();
 	manager.graph_order_callback();
 
+	const int64_t t_start = _x_get_monotonic_usec();
+
 	int64_t clock1, clock2;
 	clock1 = -1;
 	while (_running) {
@@ -1194,6 +1361,7 @@ DummyAudioBackend::main_process_thread ()
 			return 0;
 		}
 		_processed_samples += _samples_per_period;
+		++_process_cycles;
 
 		if (_device == _("Loopback") && _midi_mode != MidiToAudio) {
 			int opn = 0;
@@ -1224,7 +1392,11 @@ DummyAudioBackend::main_process_thread ()
 		}
 
 		if (!_freewheel) {
-			const int64_t nominal_time = 1e6 * _samples_per_period / _samplerate;
+			/* with a speedup, a cycle's time budget shrinks accordingly;
+			 * unthrottled, the load is relative to realtime.
+			 */
+			const float speedup = _speedup > 0 ? _speedup : 1.0f;
+			const int64_t nominal_time = 1e6 * _samples_per_period / (_samplerate * speedup);
 			clock2 = _x_get_monotonic_usec();
 			bool timers_ok = true;
 
@@ -1253,7 +1425,9 @@ DummyAudioBackend::main_process_thread ()
 				}
 			}
 
-			if (elapsed_time < nominal_time) {
+			if (_speedup == 0) {
+				/* maximum speed: start the next cycle right away */
+			} else if (elapsed_time < nominal_time) {
 				Glib::usleep (nominal_time - elapsed_time);
 			} else {
 				Glib::usleep (100); // don't hog cpu
@@ -1296,6 +1470,12 @@ DummyAudioBackend::main_process_thread ()
 		}
 
 	}
+
+	const int64_t t_end = _x_get_monotonic_usec();
+	if (t_start >= 0 && t_end > t_start) {
+		_process_usecs = t_end - t_start;
+	}
+
 	_running = false;
 	return 0;
 }
@@ -1655,12 +1835,12 @@ void DummyAudioPort::midi_to_wavetable (DummyMidiBuffer const * const src, size_
 	 * (here: midi-out playback-latency + audio-in capture-latency)
 	 */
 	for (DummyMidiBuffer::const_iterator it = src->begin (); it != src->end (); ++it) {
-		const pframes_t t = (*it)->timestamp();
+		const pframes_t t = it->timestamp();
 		assert(t < n_samples);
 		// somewhat arbitrary mapping for quick visual feedback
 		float v = -.5f;
-		if ((*it)->size() == 3) {
-			const unsigned char *d = (*it)->const_data();
+		if (it->size() == 3) {
+			const unsigned char *d = it->const_data();
 			if ((d[0] & 0xf0) == 0x90) { // note on
 				v = .25f + d[2] / 512.f;
 			}
@@ -1855,18 +2035,10 @@ DummyMidiPort::~DummyMidiPort () {
 	_loopback.clear ();
 }
 
-struct MidiEventSorter {
-	bool operator() (const boost::shared_ptr<DummyMidiEvent>& a, const boost::shared_ptr<DummyMidiEvent>& b) {
-		return *a < *b;
-	}
-};
-
 void DummyMidiPort::set_loopback (DummyMidiBuffer const * const src)
 {
 	_loopback.clear ();
-	for (DummyMidiBuffer::const_iterator it = src->begin (); it != src->end (); ++it) {
-		_loopback.push_back (boost::shared_ptr<DummyMidiEvent>(new DummyMidiEvent (**it)));
-	}
+	_loopback.merge (*src);
 }
 
 void DummyMidiPort::setup_generator (int seq_id, const float sr)
@@ -1889,9 +2061,7 @@ void DummyMidiPort::midi_generate (const pframes_t n_samples)
 	_gen_cycle = true;
 
 	if (_midi_seq_spb == 0 || !_midi_seq_dat) {
-		for (DummyMidiBuffer::const_iterator it = _loopback.begin (); it != _loopback.end (); ++it) {
-			_buffer.push_back (boost::shared_ptr<DummyMidiEvent>(new DummyMidiEvent (**it)));
-		}
+		_buffer.merge (_loopback);
 		return;
 	}
 
@@ -1903,11 +2073,9 @@ void DummyMidiPort::midi_generate (const pframes_t n_samples)
 		if ((pframes_t) ev_beat_time >= n_samples) {
 			break;
 		}
-		_buffer.push_back (boost::shared_ptr<DummyMidiEvent>(new DummyMidiEvent (
-						ev_beat_time,
-						_midi_seq_dat[_midi_seq_pos].event,
-						_midi_seq_dat[_midi_seq_pos].size
-						)));
+		_buffer.push_back (ev_beat_time,
+				_midi_seq_dat[_midi_seq_pos].event,
+				_midi_seq_dat[_midi_seq_pos].size);
 		++_midi_seq_pos;
 
 		if (_midi_seq_dat[_midi_seq_pos].event[0] == 0xff && _midi_seq_dat[_midi_seq_pos].event[1] == 0xff) {
@@ -1930,12 +2098,8 @@ void* DummyMidiPort::get_buffer (pframes_t n_samples)
 			if (source->is_physical() && source->is_terminal()) {
 				source->get_buffer(n_samples); // generate signal.
 			}
-			const DummyMidiBuffer *src = source->const_buffer ();
-			for (DummyMidiBuffer::const_iterator it = src->begin (); it != src->end (); ++it) {
-				_buffer.push_back (boost::shared_ptr<DummyMidiEvent>(new DummyMidiEvent (**it)));
-			}
+			_buffer.merge (*source->const_buffer ());
 		}
-		std::sort (_buffer.begin (), _buffer.end (), MidiEventSorter());
 	} else if (is_output () && is_physical () && is_terminal()) {
 		if (!_gen_cycle) {
 			midi_generate(n_samples);
@@ -1944,28 +2108,94 @@ void* DummyMidiPort::get_buffer (pframes_t n_samples)
 	return &_buffer;
 }
 
-DummyMidiEvent::DummyMidiEvent (const pframes_t timestamp, const uint8_t* data, size_t size)
-	: _size (size)
-	, _timestamp (timestamp)
-	, _data (0)
+DummyMidiBuffer::DummyMidiBuffer ()
+	: _used (0)
+	, _sorted (true)
 {
-	if (size > 0) {
-		_data = (uint8_t*) malloc (size);
-		memcpy (_data, data, size);
+	_events.reserve (max_events);
+	_data.resize (max_data);
+}
+
+int
+DummyMidiBuffer::push_back (pframes_t timestamp, const uint8_t* data, size_t size)
+{
+	if (_events.size () >= max_events || _used + size > max_data) {
+		fprintf (stderr, "DummyMidiBuffer: buffer is full, event dropped.\n");
+		return -1;
 	}
+	if (!_events.empty () && timestamp < _events.back ().timestamp ()) {
+		_sorted = false;
+	}
+	uint8_t* const dst = &_data[0] + _used;
+	memcpy (dst, data, size);
+	_used += size;
+	_events.push_back (DummyMidiEvent (timestamp, dst, size));
+	return 0;
 }
 
-DummyMidiEvent::DummyMidiEvent (const DummyMidiEvent& other)
-	: _size (other.size ())
-	, _timestamp (other.timestamp ())
-	, _data (0)
+/** Add the events of @param src to this buffer, keeping it in time order;
+ * events with the same time as some already here go after them.
+ */
+void
+DummyMidiBuffer::merge (const DummyMidiBuffer& src)
 {
-	if (other.size () && other.const_data ()) {
-		_data = (uint8_t*) malloc (other.size ());
-		memcpy (_data, other.const_data (), other.size ());
+	const size_t n = _events.size ();
+	const size_t m = src._events.size ();
+
+	if (m == 0) {
+		return;
 	}
-};
 
-DummyMidiEvent::~DummyMidiEvent () {
-	free (_data);
+	if (!_sorted || !src._sorted || n + m > max_events || _used + src._used > max_data) {
+		for (const_iterator it = src.begin (); it != src.end (); ++it) {
+			push_back (it->timestamp (), it->const_data (), it->size ());
+		}
+		sort ();
+		return;
+	}
+
+	/* copy all of the source's data in one go; its events keep their
+	 * offsets within it.
+	 */
+	uint8_t* const base = &_data[0] + _used;
+	memcpy (base, &src._data[0], src._used);
+	_used += src._used;
+
+	/* then merge the two lists from the back, so that no scratch space
+	 * is needed.
+	 */
+	_events.resize (n + m);
+
+	size_t i = n;
+	size_t j = m;
+	size_t k = n + m;
+
+	while (j > 0) {
+		const DummyMidiEvent& e = src._events[j - 1];
+		if (i > 0 && e.timestamp () < _events[i - 1].timestamp ()) {
+			_events[--k] = _events[--i];
+		} else {
+			_events[--k] = DummyMidiEvent (e.timestamp (), base + (e.const_data () - &src._data[0]), e.size ());
+			--j;
+		}
+	}
+}
+
+struct MidiEventSorter {
+	bool operator() (const DummyMidiEvent& a, const DummyMidiEvent& b) {
+		if (a.timestamp () != b.timestamp ()) {
+			return a.timestamp () < b.timestamp ();
+		}
+		/* data is stored in the order the events were added */
+		return a.const_data () < b.const_data ();
+	}
 };
+
+void
+DummyMidiBuffer::sort ()
+{
+	if (!_sorted) {
+		std::sort (_events.begin (), _events.end (), MidiEventSorter ());
+		_sorted = true;
+	}
+}
@@ -47,21 +47,58 @@ namespace DummyMidiData {
 
 class DummyMidiEvent {
 	public:
-		DummyMidiEvent (const pframes_t timestamp, const uint8_t* data, size_t size);
-		DummyMidiEvent (const DummyMidiEvent& other);
-		~DummyMidiEvent ();
+		DummyMidiEvent () : _size (0), _timestamp (0), _data (0) {};
+		DummyMidiEvent (const pframes_t timestamp, uint8_t* data, size_t size)
+			: _size (size), _timestamp (timestamp), _data (data) {};
 		size_t size () const { return _size; };
 		pframes_t timestamp () const { return _timestamp; };
 		const unsigned char* const_data () const { return _data; };
 		unsigned char* data () { return _data; };
 		bool operator< (const DummyMidiEvent &other) const { return timestamp () < other.timestamp (); };
 	private:
-		size_t _size;
+		uint32_t _size;
 		pframes_t _timestamp;
 		uint8_t *_data;
 };
 
-typedef std::vector<boost::shared_ptr<DummyMidiEvent> > DummyMidiBuffer;
+/** The MIDI events of one port for one cycle.
+ *
+ * Event data is stored in place in a pool of bytes which is allocated
+ * along with the buffer, and the events refer into it, so that filling,
+ * copying and merging buffers never allocates in the process thread.
+ * Events which do not fit are dropped.
+ */
+class DummyMidiBuffer {
+	public:
+		DummyMidiBuffer ();
+
+		typedef std::vector<DummyMidiEvent>::const_iterator const_iterator;
+
+		size_t size () const { return _events.size (); }
+		bool empty () const { return _events.empty (); }
+		const_iterator begin () const { return _events.begin (); }
+		const_iterator end () const { return _events.end (); }
+		DummyMidiEvent& operator[] (size_t i) { return _events[i]; }
+		const DummyMidiEvent& back () const { return _events.back (); }
+
+		void clear () { _events.clear (); _used = 0; _sorted = true; }
+		int push_back (pframes_t timestamp, const uint8_t* data, size_t size);
+		void merge (const DummyMidiBuffer& src);
+		void sort ();
+
+		static const size_t max_events = 2048;
+		static const size_t max_data = 8192;
+
+	private:
+		/* the events point into _data, so may not be copied elsewhere */
+		DummyMidiBuffer (const DummyMidiBuffer&);
+		DummyMidiBuffer& operator= (const DummyMidiBuffer&);
+
+		std::vector<DummyMidiEvent> _events;
+		std::vector<uint8_t> _data;
+		size_t _used;
+		bool   _sorted; ///< true if _events is in time order
+};
 
 class DummyPort {
 	protected:
@@ -226,6 +263,11 @@ class DummyAudioBackend : public AudioBackend {
 		std::string name () const;
 		bool is_realtime () const;
 
+		bool requires_driver_selection() const { return true; }
+		std::string driver_name () const;
+		std::vector<std::string> enumerate_drivers () const;
+		int set_driver (const std::string&);
+
 		std::vector<DeviceStatus> enumerate_devices () const;
 		std::vector<float> available_sample_rates (const std::string& device) const;
 		std::vector<uint32_t> available_buffer_sizes (const std::string& device) const;
@@ -374,13 +416,22 @@ class DummyAudioBackend : public AudioBackend {
 			MidiToAudio,
 		};
 
+		struct DriverSpeed {
+			std::string key;  ///< untranslated name, which set_driver() also accepts
+			std::string name;
+			float speedup; ///< process cycles per nominal period, 0: unthrottled
+			DriverSpeed (const std::string& k, const std::string& n, float s) : key (k), name (n), speedup (s) {}
+		};
+
 		std::string _instance_name;
 		static std::vector<std::string> _midi_options;
 		static std::vector<AudioBackend::DeviceStatus> _device_status;
+		static std::vector<DummyAudioBackend::DriverSpeed> _driver_speed;
 
 		bool  _running;
 		bool  _freewheel;
 		bool  _freewheeling;
+		float _speedup;
 
 		std::string _device;
 
@@ -401,6 +452,10 @@ class DummyAudioBackend : public AudioBackend {
 
 		framecnt_t _processed_samples;
 
+		/* cycles run and wall-clock time taken, reported on stop() */
+		uint64_t _process_cycles;
+		int64_t  _process_usecs;
+
 		pthread_t _main_thread;
 
 		/* process threads */
@@ -427,6 +482,11 @@ class DummyAudioBackend : public AudioBackend {
 		std::vector<DummyMidiPort *> _system_midi_out;
 		std::vector<DummyPort *> _ports;
 
+		/* _ports indexed by name, which also serves prefix queries, and by handle */
+		typedef std::map<std::string, DummyPort *> PortMap;
+		PortMap _portmap;
+		std::set<DummyPort *> _portset;
+
 		struct PortConnectData {
 			std::string a;
 			std::string b;
@@ -453,16 +513,15 @@ class DummyAudioBackend : public AudioBackend {
 		}
 
 		bool valid_port (PortHandle port) const {
-			return std::find (_ports.begin (), _ports.end (), (DummyPort*)port) != _ports.end ();
+			return _portset.find (static_cast<DummyPort*>(port)) != _portset.end ();
 		}
 
 		DummyPort * find_port (const std::string& port_name) const {
-			for (std::vector<DummyPort*>::const_iterator it = _ports.begin (); it != _ports.end (); ++it) {
-				if ((*it)->name () == port_name) {
-					return *it;
-				}
+			PortMap::const_iterator it = _portmap.find (port_name);
+			if (it == _portmap.end ()) {
+				return NULL;
 			}
-			return NULL;
+			return it->second;
 		}
 
 }; // class DummyAudioBackend
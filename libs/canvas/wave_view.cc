@@ -967,15 +967,25 @@ WaveView::generate_image (boost::shared_ptr<WaveViewThreadRequest> req, bool in_
 		
 		boost::scoped_array<ARDOUR::PeakData> peaks (new PeakData[n_peaks]);
 
-		/* Note that Region::read_peaks() takes a start position based on an
+		/* Note that Region::read_peaks() and peak_view() take a start position based on an
 		   offset into the Region's **SOURCE**, rather than an offset into
 		   the Region itself.
 		*/
 	                             
-		framecnt_t peaks_read = _region->read_peaks (peaks.get(), n_peaks,
-		                                             sample_start, sample_end - sample_start,
-		                                             req->channel,
-		                                             req->samples_per_pixel);
+		ARDOUR::PeakView view;
+		framecnt_t peaks_read;
+
+		if (_region->peak_view (view, sample_start, sample_end - sample_start, req->channel, req->samples_per_pixel)) {
+			/* reduce the stored peaks straight from the mapped
+			 * peakfile, without copying them anywhere first.
+			 */
+			peaks_read = view.read (peaks.get(), n_peaks, sample_start, req->samples_per_pixel);
+		} else {
+			peaks_read = _region->read_peaks (peaks.get(), n_peaks,
+			                                  sample_start, sample_end - sample_start,
+			                                  req->channel,
+			                                  req->samples_per_pixel);
+		}
 		
 		req->image = Cairo::ImageSurface::create (Cairo::FORMAT_ARGB32, n_peaks, req->height);
 		/* make sure we record the sample positions that were actually used */
@@ -21,6 +21,7 @@
 
 #include <cassert>
 #include <list>
+#include <vector>
 #include <stdint.h>
 
 #include <boost/pool/pool.hpp>
@@ -28,6 +29,7 @@
 
 #include <glibmm/threads.h>
 
+#include "pbd/rcu.h"
 #include "pbd/signals.h"
 
 #include "evoral/visibility.h"
@@ -114,9 +116,7 @@ public:
 	}
 	bool empty() const { return _events.empty(); }
 
-	void reset_default (double val) {
-		_default_value = val;
-	}
+	void reset_default (double val);
 
 	void clear ();
 	void x_scale (double factor);
@@ -193,28 +193,18 @@ public:
 		return unlocked_eval (where);
 	}
 
+	/** Evaluate the list from the latest snapshot, without taking the
+	 *  lock; @param ok is always set to true.
+	 */
 	double rt_safe_eval (double where, bool& ok) {
-
-		Glib::Threads::RWLock::ReaderLock lm (_lock, Glib::Threads::TRY_LOCK);
-
-		if ((ok = lm.locked())) {
-			return unlocked_eval (where);
-		} else {
-			return 0.0;
-		}
+		ok = true;
+		return snapshot()->eval (where);
 	}
 
 	static inline bool time_comparator (const ControlEvent* a, const ControlEvent* b) {
 		return a->when < b->when;
 	}
 
-	/** Lookup cache for eval functions, range contains equivalent values */
-	struct LookupCache {
-		LookupCache() : left(-1) {}
-		double left;  /* leftmost x coordinate used when finding "range" */
-		std::pair<ControlList::const_iterator,ControlList::const_iterator> range;
-	};
-
 	/** Lookup cache for point finding, range contains points after left */
 	struct SearchCache {
 		SearchCache () : left(-1) {}
@@ -227,7 +217,6 @@ public:
 
 	// FIXME: const violations for Curve
 	Glib::Threads::RWLock& lock()       const { return _lock; }
-	LookupCache& lookup_cache() const { return _lookup_cache; }
 	SearchCache& search_cache() const { return _search_cache; }
 
 	/** Called by locked entry point and various private
@@ -237,6 +226,15 @@ public:
 	 */
 	double unlocked_eval (double x) const;
 
+	/** @return the first event later than @param x, which ends the
+	 *  segment containing x.  The search starts from wherever the calling
+	 *  thread last looked in this list, so that a thread walking forwards
+	 *  through the list does not have to search it from the start each
+	 *  time, and threads evaluating the same list do not disturb each
+	 *  other.  Must be called with the lock held.
+	 */
+	const_iterator segment_end (double x) const;
+
 	bool rt_safe_earliest_event (double start, double& x, double& y, bool start_inclusive=false) const;
 	bool rt_safe_earliest_event_unlocked (double start, double& x, double& y, bool start_inclusive=false) const;
 	bool rt_safe_earliest_event_linear_unlocked (double start, double& x, double& y, bool inclusive) const;
@@ -259,6 +257,49 @@ public:
 	InterpolationStyle interpolation() const { return _interpolation; }
 	void set_interpolation (InterpolationStyle);
 
+	/** An immutable copy of the events and everything else needed to
+	 *  evaluate the list.  Each change to the list publishes a new one,
+	 *  which realtime threads can read without ever taking the lock; the
+	 *  old one is kept until no reader can still be using it.
+	 */
+	struct LIBEVORAL_API Snapshot {
+		Snapshot () : interpolation (Linear), default_value (0.0) {}
+
+		struct Point {
+			Point (double w, double v) : when (w), value (v), coeff (), has_coeff (false) {}
+
+			double when;
+			double value;
+			double coeff[4]; ///< if has_coeff, the curve between the previous point and this one
+			bool   has_coeff;
+		};
+
+		std::vector<Point> points;
+		InterpolationStyle interpolation;
+		double             default_value;
+
+		/** @return the value at @param x, as ControlList::unlocked_eval() would */
+		double eval (double x) const;
+
+		/** @return the index of the first point later than @param x,
+		 *  searching from @param hint, which must not be later than
+		 *  the result.
+		 */
+		size_t segment_end (double x, size_t hint = 0) const;
+	};
+
+	/** @return the latest snapshot; may be called from any thread without
+	 *  the lock.
+	 */
+	boost::shared_ptr<Snapshot> snapshot () const { return _snapshot.reader (); }
+
+	/** Publish a new snapshot if the list has changed since the last one.
+	 *  Must be called with the lock held (for reading or writing), from
+	 *  a thread that can allocate memory; threads which only hold it for
+	 *  reading may call this at the same time.
+	 */
+	void unlocked_publish_snapshot () const;
+
 	virtual bool touching() const { return false; }
 	virtual bool writing() const { return false; }
 	virtual bool touch_enabled() const { return false; }
@@ -294,9 +335,23 @@ protected:
 
 	void _x_scale (double factor);
 
-	mutable LookupCache   _lookup_cache;
+	/** changes whenever the events do, so that per-thread cursors into
+	 *  _events can tell when they are no longer valid; unique across all
+	 *  lists, so a new list at the address of a deleted one cannot be
+	 *  mistaken for it.
+	 */
+	mutable gint          _generation;
 	mutable SearchCache   _search_cache;
 
+	mutable SerializedRCUManager<Snapshot> _snapshot;
+	/** non-zero if the events have changed since _snapshot was published;
+	 *  atomic, since it is cleared by publishers which may only hold _lock
+	 *  for reading.
+	 */
+	mutable gint          _snapshot_stale;
+	/** serializes publishers of _snapshot */
+	mutable Glib::Threads::Mutex _snapshot_lock;
+
 	mutable Glib::Threads::RWLock _lock;
 
 	Parameter             _parameter;
@@ -23,11 +23,10 @@
 #include <boost/utility.hpp>
 
 #include "evoral/visibility.h"
+#include "evoral/ControlList.hpp"
 
 namespace Evoral {
 
-class ControlList;
-
 class LIBEVORAL_API Curve : public boost::noncopyable
 {
 public:
@@ -36,17 +35,20 @@ public:
 	bool rt_safe_get_vector (double x0, double x1, float *arg, int32_t veclen);
 	void get_vector (double x0, double x1, float *arg, int32_t veclen);
 
-	void solve ();
-
-	void mark_dirty() const { _dirty = true; }
+	/** Compute the coefficients of the constrained cubic spline through the
+	 *  points of @param s, which are needed to render it as a Curved list.
+	 */
+	static void solve (ControlList::Snapshot& s);
 
 private:
-	double unlocked_eval (double where);
-	double multipoint_eval (double x);
+	static void _get_vector (ControlList::Snapshot const &, double x0, double x1, float *arg, int32_t veclen);
 
-	void _get_vector (double x0, double x1, float *arg, int32_t veclen);
+	static int32_t elements_before (double limit, double lx, double dx, int32_t i, int32_t veclen);
+	static void fill (float* vec, int32_t start, int32_t end, float val);
+	static void render_linear (float* vec, int32_t start, int32_t end, double lx, double dx,
+	                           double before_when, double before_value, double vdelta, double trange);
+	static void render_cubic (float* vec, int32_t start, int32_t end, double lx, double dx, double const * coeff);
 
-	mutable bool       _dirty;
 	const ControlList& _list;
 };
 
@@ -60,6 +60,7 @@ public:
 
 	void seek_to_start() const;
 	int  seek_to_track(int track);
+	uint64_t seek_to_ticks(uint64_t ticks) const;
 
 	int read_event(uint32_t* delta_t, uint32_t* size, uint8_t** buf, event_id_t* note_id) const;
 
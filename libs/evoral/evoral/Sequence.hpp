@@ -120,11 +120,19 @@ public:
 		return a->time() < b->time();
 	}
 
+	/* The comparators below also take NotePtr by reference, so that the
+	   note containers can compare their elements without converting them
+	   to constNotePtr (and so touching their reference counts) each time.
+	*/
+
 	struct NoteNumberComparator {
 		inline bool operator()(const boost::shared_ptr< const Note<Time> > a,
 		                       const boost::shared_ptr< const Note<Time> > b) const {
 			return a->note() < b->note();
 		}
+		inline bool operator()(const NotePtr& a, const NotePtr& b) const {
+			return a->note() < b->note();
+		}
 	};
 
 	struct EarlierNoteComparator {
@@ -132,6 +140,9 @@ public:
 		                       const boost::shared_ptr< const Note<Time> > b) const {
 			return a->time() < b->time();
 		}
+		inline bool operator()(const NotePtr& a, const NotePtr& b) const {
+			return a->time() < b->time();
+		}
 	};
 
 	struct LaterNoteComparator {
@@ -148,6 +159,9 @@ public:
 		                       const boost::shared_ptr< const Note<Time> > b) const {
 			return a->end_time() > b->end_time();
 		}
+		inline bool operator()(const NotePtr& a, const NotePtr& b) const {
+			return a->end_time() > b->end_time();
+		}
 	};
 
 	typedef std::multiset<NotePtr, EarlierNoteComparator> Notes;
@@ -261,7 +275,7 @@ public:
 		MIDIMessageType                       _type;
 		bool                                  _is_end;
 		typename Sequence::ReadLock           _lock;
-		typename Notes::const_iterator        _note_iter;
+		size_t                                _note_index; ///< next note on, in _seq->_note_table
 		typename SysExes::const_iterator      _sysex_iter;
 		typename PatchChanges::const_iterator _patch_change_iter;
 		ControlIterators                      _control_iters;
@@ -318,6 +332,10 @@ protected:
 	OverlapPitchResolution _overlap_pitch_resolution;
 	mutable Glib::Threads::RWLock   _lock;
 	bool                   _writing;
+	/** control lists added to by the write in progress, which are frozen
+	 *  until it ends so that each publishes its new contents only once.
+	 */
+	std::set< boost::shared_ptr<ControlList> > _write_lists;
 
 	virtual int resolve_overlaps_unlocked (const NotePtr, void* /* arg */ = 0) {
 		return 0;
@@ -344,6 +362,20 @@ private:
 	void get_notes_by_pitch (Notes&, NoteOperator, uint8_t val, int chan_mask = 0) const;
 	void get_notes_by_velocity (Notes&, NoteOperator, uint8_t val, int chan_mask = 0) const;
 
+	/** A flat copy of _notes, in the same order, with each note's start
+	 *  time held in a separate contiguous array alongside it.  Iterators
+	 *  seek and step through this rather than the tree, so that reading
+	 *  a large sequence walks contiguous memory instead of chasing tree
+	 *  nodes.  Notes are still owned and identified by their NotePtr.
+	 */
+	struct NoteTable {
+		std::vector<Time>    times;
+		std::vector<NotePtr> notes;
+	};
+
+	const NoteTable& note_table () const;
+	void note_table_changed () { _note_table_dirty = true; }
+
 	const TypeMap& _type_map;
 
 	Notes        _notes;       // notes indexed by time
@@ -351,6 +383,13 @@ private:
 	SysExes      _sysexes;
 	PatchChanges _patch_changes;
 
+	/* rebuilt under _note_table_lock by readers when dirty, or when
+	   _notes has been changed directly and no longer matches it in size.
+	*/
+	mutable NoteTable              _note_table;
+	mutable bool                   _note_table_dirty;
+	mutable Glib::Threads::Mutex   _note_table_lock;
+
 	typedef std::multiset<NotePtr, EarlierNoteComparator> WriteNotes;
 	WriteNotes _write_notes[16];
 
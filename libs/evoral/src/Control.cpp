@@ -43,7 +43,11 @@ double
 Control::get_double (bool from_list, double frame) const
 {
 	if (from_list) {
-		return _list->eval(frame);
+		/* this is called from process threads, so use the snapshot
+		   rather than waiting for the list's lock.
+		*/
+		bool ok;
+		return _list->rt_safe_eval (frame, ok);
 	} else {
 		return _user_value;
 	}
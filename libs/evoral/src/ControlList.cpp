@@ -50,8 +50,40 @@ inline bool event_time_less_than (ControlEvent* a, ControlEvent* b)
 	return a->when < b->when;
 }
 
+static gint generation_counter = 0;
+
+/** @return a generation number that no list has had before */
+static gint
+next_generation ()
+{
+	return g_atomic_int_add (&generation_counter, 1) + 1;
+}
+
+/** Where a thread last looked in a list: `end' is the first event later
+ *  than the x it looked for.  Only valid while the list's generation is
+ *  still `generation'.
+ */
+struct SegmentCursor {
+	SegmentCursor () : list (0), generation (0) {}
+
+	ControlList const *         list;
+	gint                        generation;
+	ControlList::const_iterator end;
+};
+
+/** Each thread's cursors, one slot per list, chosen by the list's address.
+ *  Two lists that share a slot just cost each other a search now and then.
+ */
+struct SegmentCursors {
+	static const size_t size = 64;
+	SegmentCursor cursor[size];
+};
+
+static Glib::Threads::Private<SegmentCursors> thread_segment_cursors;
+
 ControlList::ControlList (const Parameter& id, const ParameterDescriptor& desc)
-	: _parameter(id)
+	: _snapshot (new Snapshot)
+	, _parameter(id)
 	, _desc(desc)
 	, _curve(0)
 {
@@ -61,9 +93,8 @@ ControlList::ControlList (const Parameter& id, const ParameterDescriptor& desc)
 	_min_yval = desc.lower;
 	_max_yval = desc.upper;
 	_default_value = desc.normal;
-	_lookup_cache.left = -1;
-	_lookup_cache.range.first = _events.end();
-	_lookup_cache.range.second = _events.end();
+	_generation = next_generation ();
+	_snapshot_stale = 1;
 	_search_cache.left = -1;
 	_search_cache.first = _events.end();
 	_sort_pending = false;
@@ -72,10 +103,13 @@ ControlList::ControlList (const Parameter& id, const ParameterDescriptor& desc)
 	did_write_during_pass = false;
 	insert_position = -1;
 	most_recent_insert_iterator = _events.end();
+
+	unlocked_publish_snapshot ();
 }
 
 ControlList::ControlList (const ControlList& other)
-	: _parameter(other._parameter)
+	: _snapshot (new Snapshot)
+	, _parameter(other._parameter)
 	, _desc(other._desc)
 	, _interpolation(other._interpolation)
 	, _curve(0)
@@ -85,8 +119,8 @@ ControlList::ControlList (const ControlList& other)
 	_min_yval = other._min_yval;
 	_max_yval = other._max_yval;
 	_default_value = other._default_value;
-	_lookup_cache.range.first = _events.end();
-	_lookup_cache.range.second = _events.end();
+	_generation = next_generation ();
+	_snapshot_stale = 1;
 	_search_cache.first = _events.end();
 	_sort_pending = false;
 	new_write_pass = true;
@@ -98,10 +132,12 @@ ControlList::ControlList (const ControlList& other)
 	copy_events (other);
 
 	mark_dirty ();
+	unlocked_publish_snapshot ();
 }
 
 ControlList::ControlList (const ControlList& other, double start, double end)
-	: _parameter(other._parameter)
+	: _snapshot (new Snapshot)
+	, _parameter(other._parameter)
 	, _desc(other._desc)
 	, _interpolation(other._interpolation)
 	, _curve(0)
@@ -111,8 +147,8 @@ ControlList::ControlList (const ControlList& other, double start, double end)
 	_min_yval = other._min_yval;
 	_max_yval = other._max_yval;
 	_default_value = other._default_value;
-	_lookup_cache.range.first = _events.end();
-	_lookup_cache.range.second = _events.end();
+	_generation = next_generation ();
+	_snapshot_stale = 1;
 	_search_cache.first = _events.end();
 	_sort_pending = false;
 
@@ -131,6 +167,7 @@ ControlList::ControlList (const ControlList& other, double start, double end)
 	most_recent_insert_iterator = _events.end();
 
 	mark_dirty ();
+	unlocked_publish_snapshot ();
 }
 
 ControlList::~ControlList()
@@ -207,6 +244,9 @@ ControlList::maybe_signal_changed ()
 
 	if (_frozen) {
 		_changed_when_thawed = true;
+	} else {
+		Glib::Threads::RWLock::WriterLock lm (_lock);
+		unlocked_publish_snapshot ();
 	}
 }
 
@@ -250,6 +290,10 @@ ControlList::_x_scale (double factor)
 	}
 
 	mark_dirty ();
+
+	if (!_frozen) {
+		unlocked_publish_snapshot ();
+	}
 }
 
 struct ControlEventTimeComparator {
@@ -333,6 +377,10 @@ ControlList::fast_simple_add (double when, double value)
 	_events.insert (_events.end(), new ControlEvent (when, value));
 
 	mark_dirty ();
+
+	if (!_frozen) {
+		unlocked_publish_snapshot ();
+	}
 }
 
 void
@@ -918,22 +966,19 @@ ControlList::thaw ()
 			unlocked_invalidate_insert_iterator ();
 			_sort_pending = false;
 		}
+
+		unlocked_publish_snapshot ();
 	}
 }
 
 void
 ControlList::mark_dirty () const
 {
-	_lookup_cache.left = -1;
-	_lookup_cache.range.first = _events.end();
-	_lookup_cache.range.second = _events.end();
+	g_atomic_int_set (&_generation, next_generation ());
+	g_atomic_int_set (&_snapshot_stale, 1);
 	_search_cache.left = -1;
 	_search_cache.first = _events.end();
 
-	if (_curve) {
-		_curve->mark_dirty();
-	}
-
 	Dirty (); /* EMIT SIGNAL */
 }
 
@@ -1220,56 +1265,175 @@ ControlList::multipoint_eval (double x) const
 			return (*(--i))->value;
 	}
 
-	/* Only do the range lookup if x is in a different range than last time
-	 * this was called (or if the lookup cache has been marked "dirty" (left<0) */
-	if ((_lookup_cache.left < 0) ||
-	    ((_lookup_cache.left > x) ||
-	     (_lookup_cache.range.first == _events.end()) ||
-	     ((*_lookup_cache.range.second)->when < x))) {
+	const_iterator after = segment_end (x);
 
-		const ControlEvent cp (x, 0);
+	if (after == _events.begin()) {
+		/* we're before the first point */
+		// return _default_value;
+		return _events.front()->value;
+	}
+
+	const_iterator before = after;
+	--before;
 
-		_lookup_cache.range = equal_range (_events.begin(), _events.end(), &cp, time_comparator);
+	if ((*before)->when == x) {
+		/* x is a control point in the data; if there is more than one
+		   at x, use the first.
+		*/
+		while (before != _events.begin()) {
+			const_iterator prev = before;
+			if ((*(--prev))->when != x) {
+				break;
+			}
+			before = prev;
+		}
+		return (*before)->value;
 	}
 
-	pair<const_iterator,const_iterator> range = _lookup_cache.range;
+	if (after == _events.end()) {
+		/* we're after the last point */
+		return _events.back()->value;
+	}
 
-	if (range.first == range.second) {
+	lpos = (*before)->when;
+	lval = (*before)->value;
+	upos = (*after)->when;
+	uval = (*after)->value;
 
-		/* x does not exist within the list as a control point */
+	/* linear interpolation betweeen the two points
+	   on either side of x
+	*/
 
-		_lookup_cache.left = x;
+	fraction = (double) (x - lpos) / (double) (upos - lpos);
+	return lval + (fraction * (uval - lval));
+}
 
-		if (range.first != _events.begin()) {
-			--range.first;
-			lpos = (*range.first)->when;
-			lval = (*range.first)->value;
-		}  else {
-			/* we're before the first point */
-			// return _default_value;
-			return _events.front()->value;
-		}
+ControlList::const_iterator
+ControlList::segment_end (double x) const
+{
+	SegmentCursors* cursors = thread_segment_cursors.get ();
 
-		if (range.second == _events.end()) {
-			/* we're after the last point */
-			return _events.back()->value;
+	if (!cursors) {
+		/* first use by this thread */
+		cursors = new SegmentCursors;
+		thread_segment_cursors.set (cursors);
+	}
+
+	SegmentCursor& c (cursors->cursor[((uintptr_t) this / sizeof (ControlList)) % SegmentCursors::size]);
+	const ControlEvent cp (x, 0);
+
+	if (c.list != this || c.generation != g_atomic_int_get (&_generation)) {
+		c.list = this;
+		c.generation = g_atomic_int_get (&_generation);
+		c.end = upper_bound (_events.begin(), _events.end(), &cp, time_comparator);
+		return c.end;
+	}
+
+	if (c.end != _events.begin()) {
+		const_iterator before = c.end;
+		if ((*(--before))->when > x) {
+			/* moved backwards, e.g. a locate or loop */
+			c.end = upper_bound (_events.begin(), c.end, &cp, time_comparator);
+			return c.end;
 		}
+	}
 
-		upos = (*range.second)->when;
-		uval = (*range.second)->value;
+	/* usually x has moved forward by at most a segment or two */
+	while (c.end != _events.end() && (*c.end)->when <= x) {
+		++c.end;
+	}
 
-		/* linear interpolation betweeen the two points
-		   on either side of x
+	return c.end;
+}
+
+void
+ControlList::unlocked_publish_snapshot () const
+{
+	if (!g_atomic_int_get (&_snapshot_stale) || _sort_pending) {
+		/* nothing new, or nothing that can be searched yet; thaw()
+		   will publish once the events are sorted.
 		*/
+		return;
+	}
 
-		fraction = (double) (x - lpos) / (double) (upos - lpos);
-		return lval + (fraction * (uval - lval));
+	/* several threads may get here holding _lock for reading */
+	Glib::Threads::Mutex::Lock lm (_snapshot_lock);
+
+	if (!g_atomic_int_get (&_snapshot_stale)) {
+		/* another thread published it while we waited */
+		return;
+	}
+
+	{
+		RCUWriter<Snapshot> writer (_snapshot);
+		boost::shared_ptr<Snapshot> s = writer.get_copy ();
+
+		s->interpolation = _interpolation;
+		s->default_value = _default_value;
+		s->points.clear ();
+		s->points.reserve (_events.size());
+
+		for (const_iterator i = _events.begin(); i != _events.end(); ++i) {
+			s->points.push_back (Snapshot::Point ((*i)->when, (*i)->value));
+		}
 
+		if (_interpolation == Curved) {
+			Curve::solve (*s);
+		}
 	}
 
-	/* x is a control point in the data */
-	_lookup_cache.left = -1;
-	return (*range.first)->value;
+	g_atomic_int_set (&_snapshot_stale, 0);
+}
+
+/** Compare a snapshot point with an x position */
+struct SnapshotPointTimeComparator {
+	bool operator() (ControlList::Snapshot::Point const & p, double x) const { return p.when < x; }
+	bool operator() (double x, ControlList::Snapshot::Point const & p) const { return x < p.when; }
+};
+
+size_t
+ControlList::Snapshot::segment_end (double x, size_t hint) const
+{
+	return upper_bound (points.begin() + hint, points.end(), x, SnapshotPointTimeComparator()) - points.begin();
+}
+
+double
+ControlList::Snapshot::eval (double x) const
+{
+	if (points.empty ()) {
+		return default_value;
+	}
+
+	if (points.size() == 1 || x <= points.front().when) {
+		return points.front().value;
+	}
+
+	if (x >= points.back().when) {
+		return points.back().value;
+	}
+
+	/* x is now known to be after the first point and before the last */
+
+	size_t after = segment_end (x);
+	Point const & before = points[after - 1];
+
+	if (before.when == x) {
+		/* x is a control point in the data; if there is more than
+		   one at x, use the first.
+		*/
+		return lower_bound (points.begin(), points.end(), x, SnapshotPointTimeComparator())->value;
+	}
+
+	if (interpolation == Discrete) {
+		return before.value;
+	}
+
+	/* linear interpolation betweeen the two points
+	   on either side of x
+	*/
+
+	double const fraction = (double) (x - before.when) / (double) (points[after].when - before.when);
+	return before.value + (fraction * (points[after].value - before.value));
 }
 
 void
@@ -1745,10 +1909,25 @@ ControlList::set_interpolation (InterpolationStyle s)
 		return;
 	}
 
-	_interpolation = s;
+	{
+		Glib::Threads::RWLock::WriterLock lm (_lock);
+		_interpolation = s;
+		g_atomic_int_set (&_snapshot_stale, 1);
+		unlocked_publish_snapshot ();
+	}
+
 	InterpolationChanged (s); /* EMIT SIGNAL */
 }
 
+void
+ControlList::reset_default (double val)
+{
+	Glib::Threads::RWLock::WriterLock lm (_lock);
+	_default_value = val;
+	g_atomic_int_set (&_snapshot_stale, 1);
+	unlocked_publish_snapshot ();
+}
+
 bool
 ControlList::operator!= (ControlList const & other) const
 {
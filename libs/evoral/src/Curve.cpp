@@ -36,21 +36,16 @@ namespace Evoral {
 
 
 Curve::Curve (const ControlList& cl)
-	: _dirty (true)
-	, _list (cl)
+	: _list (cl)
 {
 }
 
 void
-Curve::solve ()
+Curve::solve (ControlList::Snapshot& s)
 {
 	uint32_t npoints;
 
-	if (!_dirty) {
-		return;
-	}
-
-	if ((npoints = _list.events().size()) > 2) {
+	if ((npoints = s.points.size()) > 2) {
 
 		/* Compute coefficients needed to efficiently compute a constrained spline
 		   curve. See "Constrained Cubic Spline Interpolation" by CJC Kruger
@@ -60,11 +55,10 @@ Curve::solve ()
 		vector<double> x(npoints);
 		vector<double> y(npoints);
 		uint32_t i;
-		ControlList::EventList::const_iterator xx;
 
-		for (i = 0, xx = _list.events().begin(); xx != _list.events().end(); ++xx, ++i) {
-			x[i] = (double) (*xx)->when;
-			y[i] = (double) (*xx)->value;
+		for (i = 0; i < npoints; ++i) {
+			x[i] = s.points[i].when;
+			y[i] = s.points[i].value;
 		}
 
 		double lp0, lp1, fpone;
@@ -80,7 +74,7 @@ Curve::solve ()
 
 		double fplast = 0;
 
-		for (i = 0, xx = _list.events().begin(); xx != _list.events().end(); ++xx, ++i) {
+		for (i = 0; i < npoints; ++i) {
 
 			double xdelta;   /* gcc is wrong about possible uninitialized use */
 			double xdelta2;  /* ditto */
@@ -154,44 +148,46 @@ Curve::solve ()
 
 			/* store */
 
-			(*xx)->create_coeffs();
-			(*xx)->coeff[0] = y[i-1] - (b * x[i-1]) - (c * xim12) - (d * xim13);
-			(*xx)->coeff[1] = b;
-			(*xx)->coeff[2] = c;
-			(*xx)->coeff[3] = d;
+			ControlList::Snapshot::Point& p (s.points[i]);
+
+			p.has_coeff = true;
+			p.coeff[0] = y[i-1] - (b * x[i-1]) - (c * xim12) - (d * xim13);
+			p.coeff[1] = b;
+			p.coeff[2] = c;
+			p.coeff[3] = d;
 
 			fplast = fpi;
 		}
 
 	}
-
-	_dirty = false;
 }
 
 bool
 Curve::rt_safe_get_vector (double x0, double x1, float *vec, int32_t veclen)
 {
-	Glib::Threads::RWLock::ReaderLock lm(_list.lock(), Glib::Threads::TRY_LOCK);
-
-	if (!lm.locked()) {
-		return false;
-	} else {
-		_get_vector (x0, x1, vec, veclen);
-		return true;
-	}
+	/* no lock: render from the latest snapshot of the list */
+	_get_vector (*_list.snapshot(), x0, x1, vec, veclen);
+	return true;
 }
 
 void
 Curve::get_vector (double x0, double x1, float *vec, int32_t veclen)
 {
-	Glib::Threads::RWLock::ReaderLock lm(_list.lock());
-	_get_vector (x0, x1, vec, veclen);
+	boost::shared_ptr<ControlList::Snapshot> s;
+
+	{
+		Glib::Threads::RWLock::ReaderLock lm(_list.lock());
+		_list.unlocked_publish_snapshot ();
+		s = _list.snapshot ();
+	}
+
+	_get_vector (*s, x0, x1, vec, veclen);
 }
 
 void
-Curve::_get_vector (double x0, double x1, float *vec, int32_t veclen)
+Curve::_get_vector (ControlList::Snapshot const & s, double x0, double x1, float *vec, int32_t veclen)
 {
-	double rx, lx, hx, max_x, min_x;
+	double lx, hx, max_x, min_x;
 	int32_t i;
 	int32_t original_veclen;
 	int32_t npoints;
@@ -200,30 +196,30 @@ Curve::_get_vector (double x0, double x1, float *vec, int32_t veclen)
 		return;
 	}
 
-	if ((npoints = _list.events().size()) == 0) {
+	if ((npoints = s.points.size()) == 0) {
 		/* no events in list, so just fill the entire array with the default value */
 		for (int32_t i = 0; i < veclen; ++i) {
-			vec[i] = _list.default_value();
+			vec[i] = s.default_value;
 		}
 		return;
 	}
 
 	if (npoints == 1) {
 		for (int32_t i = 0; i < veclen; ++i) {
-			vec[i] = _list.events().front()->value;
+			vec[i] = s.points.front().value;
 		}
 		return;
 	}
 
 	/* events is now known not to be empty */
 
-	max_x = _list.events().back()->when;
-	min_x = _list.events().front()->when;
+	max_x = s.points.back().when;
+	min_x = s.points.front().when;
 
 	if (x0 > max_x) {
 		/* totally past the end - just fill the entire array with the final value */	
 		for (int32_t i = 0; i < veclen; ++i) {
-			vec[i] = _list.events().back()->value;
+			vec[i] = s.points.back().value;
 		}
 		return;
 	}
@@ -233,7 +229,7 @@ Curve::_get_vector (double x0, double x1, float *vec, int32_t veclen)
 		 * the initial value.
 		 */
 		for (int32_t i = 0; i < veclen; ++i) {
-			vec[i] = _list.events().front()->value;
+			vec[i] = s.points.front().value;
 		}
 		return;
 	}
@@ -252,7 +248,7 @@ Curve::_get_vector (double x0, double x1, float *vec, int32_t veclen)
 		fill_len = min (fill_len, (int64_t)veclen);
 
 		for (i = 0; i < fill_len; ++i) {
-			vec[i] = _list.events().front()->value;
+			vec[i] = s.points.front().value;
 		}
 
 		veclen -= fill_len;
@@ -268,7 +264,7 @@ Curve::_get_vector (double x0, double x1, float *vec, int32_t veclen)
 		float val;
 
 		fill_len = min (fill_len, (int64_t)veclen);
-		val = _list.events().back()->value;
+		val = s.points.back().value;
 
 		for (i = veclen - fill_len; i < veclen; ++i) {
 			vec[i] = val;
@@ -290,11 +286,11 @@ Curve::_get_vector (double x0, double x1, float *vec, int32_t veclen)
 		*/
 
 		/* gradient of the line */
-		double const m_num = _list.events().back()->value - _list.events().front()->value;
-		double const m_den = _list.events().back()->when - _list.events().front()->when;
+		double const m_num = s.points.back().value - s.points.front().value;
+		double const m_den = s.points.back().when - s.points.front().when;
 
 		/* y intercept of the line */
-		double const c = double (_list.events().back()->value) - (m_num * _list.events().back()->when / m_den);
+		double const c = double (s.points.back().value) - (m_num * s.points.back().when / m_den);
 
 		/* dx that we are using */
 		double dx_num = 0;
@@ -312,107 +308,141 @@ Curve::_get_vector (double x0, double x1, float *vec, int32_t veclen)
 		return;
 	}
 
-	if (_dirty) {
-		solve ();
-	}
-
-	rx = lx;
+	/* Render the vector a segment at a time: find the segment holding
+	   the next x, then fill every element that falls within it using a
+	   loop with nothing in it but arithmetic, which the compiler can
+	   vectorise.
+	*/
 
 	double dx = 0;
 	if (veclen > 1) {
 		dx = (hx - lx) / (veclen - 1);
 	}
 
-	for (i = 0; i < veclen; ++i, rx += dx) {
-		vec[i] = multipoint_eval (rx);
-	}
-}
+	ControlList::Snapshot::Point const * const points = &s.points[0];
+	size_t const n = s.points.size();
+	size_t after = 0;
 
-double
-Curve::unlocked_eval (double x)
-{
-	// I don't see the point of this...
+	i = 0;
 
-	if (_dirty) {
-		solve ();
-	}
+	while (i < veclen) {
 
-	return _list.unlocked_eval (x);
-}
+		after = s.segment_end (lx + i * dx, after);
 
-double
-Curve::multipoint_eval (double x)
-{
-	pair<ControlList::EventList::const_iterator,ControlList::EventList::const_iterator> range;
+		if (after == 0) {
+			/* we're before the first point */
+			int32_t const end = elements_before (points[0].when, lx, dx, i, veclen);
+			fill (vec, i, end, points[0].value);
+			i = end;
+			continue;
+		}
 
-	ControlList::LookupCache& lookup_cache = _list.lookup_cache();
+		ControlList::Snapshot::Point const & b (points[after - 1]);
 
-	if ((lookup_cache.left < 0) ||
-	    ((lookup_cache.left > x) ||
-	     (lookup_cache.range.first == _list.events().end()) ||
-	     ((*lookup_cache.range.second)->when < x))) {
+		int32_t const end = (after == n) ? veclen : elements_before (points[after].when, lx, dx, i, veclen);
 
-		ControlEvent cp (x, 0.0);
+		if (b.when == lx + i * dx) {
 
-		lookup_cache.range = equal_range (_list.events().begin(), _list.events().end(), &cp, ControlList::time_comparator);
-	}
+			/* x is a control point in the data; if there is more than
+			   one at x, use the first.
+			*/
 
-	range = lookup_cache.range;
+			size_t first = after - 1;
 
-	/* EITHER
+			while (first > 0 && points[first - 1].when == b.when) {
+				--first;
+			}
 
-	   a) x is an existing control point, so first == existing point, second == next point
+			vec[i++] = points[first].value;
+		}
 
-	   OR
+		if (after == n) {
+			/* we're after the last point */
+			fill (vec, i, end, points[n - 1].value);
+			break;
+		}
 
-	   b) x is between control points, so range is empty (first == second, points to where
-	       to insert x)
+		ControlList::Snapshot::Point const & a (points[after]);
 
-	*/
+		double const vdelta = a.value - b.value;
+
+		if (vdelta == 0.0) {
+			fill (vec, i, end, b.value);
+		} else if (s.interpolation == ControlList::Curved && a.has_coeff) {
+			render_cubic (vec, i, end, lx, dx, a.coeff);
+		} else {
+			render_linear (vec, i, end, lx, dx, b.when, b.value, vdelta, a.when - b.when);
+		}
 
-	if (range.first == range.second) {
+		i = end;
+	}
+}
 
-		/* x does not exist within the list as a control point */
+/** @return the index of the first element at or after @param i whose x
+ *  (lx + index * dx) is not less than @param limit, or veclen if there is
+ *  none.  The element at @param i must be less than @param limit.
+ */
+int32_t
+Curve::elements_before (double limit, double lx, double dx, int32_t i, int32_t veclen)
+{
+	if (dx <= 0) {
+		/* every element has the same x */
+		return veclen;
+	}
 
-		lookup_cache.left = x;
+	double const estimate = ceil ((limit - lx) / dx);
 
-		if (range.first == _list.events().begin()) {
-			/* we're before the first point */
-			// return default_value;
-			return _list.events().front()->value;
-		}
+	if (estimate >= veclen) {
+		return veclen;
+	}
 
-		if (range.second == _list.events().end()) {
-			/* we're after the last point */
-			return _list.events().back()->value;
-		}
+	int32_t end = max ((int32_t) estimate, i + 1);
 
-		ControlEvent* after = (*range.second);
-		range.second--;
-		ControlEvent* before = (*range.second);
+	/* the estimate may be out by one due to rounding; make it agree
+	   exactly with how the elements' x values are computed.
+	*/
 
-		double vdelta = after->value - before->value;
+	while (end > i + 1 && lx + (end - 1) * dx >= limit) {
+		--end;
+	}
 
-		if (vdelta == 0.0) {
-			return before->value;
-		}
+	while (end < veclen && lx + end * dx < limit) {
+		++end;
+	}
 
-		double tdelta = x - before->when;
-		double trange = after->when - before->when;
+	return end;
+}
 
-		if (_list.interpolation() == ControlList::Curved && after->coeff) {
-				ControlEvent* ev = after;
-				double x2 = x * x;
-				return ev->coeff[0] + (ev->coeff[1] * x) + (ev->coeff[2] * x2) + (ev->coeff[3] * x2 * x);
-		} else {
-			return before->value + (vdelta * (tdelta / trange));
-		}
+void
+Curve::fill (float* vec, int32_t start, int32_t end, float val)
+{
+	for (int32_t k = start; k < end; ++k) {
+		vec[k] = val;
 	}
+}
 
-	/* x is a control point in the data */
-	/* invalidate the cached range because its not usable */
-	lookup_cache.left = -1;
-	return (*range.first)->value;
+void
+Curve::render_linear (float* vec, int32_t start, int32_t end, double lx, double dx,
+                      double before_when, double before_value, double vdelta, double trange)
+{
+	for (int32_t k = start; k < end; ++k) {
+		vec[k] = before_value + (vdelta * (((lx + k * dx) - before_when) / trange));
+	}
+}
+
+void
+Curve::render_cubic (float* vec, int32_t start, int32_t end, double lx, double dx, double const * coeff)
+{
+	double const c0 = coeff[0];
+	double const c1 = coeff[1];
+	double const c2 = coeff[2];
+	double const c3 = coeff[3];
+
+	for (int32_t k = start; k < end; ++k) {
+		double const x = lx + k * dx;
+		double const x2 = x * x;
+		vec[k] = c0 + (c1 * x) + (c2 * x2) + (c3 * x2 * x);
+	}
 }
 
 } // namespace Evoral
@@ -216,6 +216,51 @@ SMF::seek_to_start() const
 	}
 }
 
+/** Seek so that the next event read is the first at or after the given time.
+ *
+ * libsmf holds the whole track in memory, in time order, so this is a binary
+ * search rather than a read through the track from its start.
+ *
+ * \return the time, in SMF ticks, of the event before the one that will be
+ * read next (or 0 if there is none); that event's delta time is measured
+ * from here.
+ */
+uint64_t
+SMF::seek_to_ticks(uint64_t ticks) const
+{
+	Glib::Threads::Mutex::Lock lm (_smf_lock);
+
+	if (!_smf_track) {
+		cerr << "WARNING: SMF seek_to_ticks() with no track" << endl;
+		return 0;
+	}
+
+	/* find the first event (numbered from 1) at or after ticks */
+
+	size_t const n = _smf_track->number_of_events;
+	size_t lo = 1;
+	size_t hi = n + 1;
+
+	while (lo < hi) {
+		size_t const mid = lo + (hi - lo) / 2;
+		if (smf_track_get_event_by_number (_smf_track, mid)->time_pulses < ticks) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	if (lo > n) {
+		/* past the end */
+		_smf_track->next_event_number = 0;
+	} else {
+		_smf_track->next_event_number = lo;
+		_smf_track->time_of_next_event = smf_track_get_event_by_number (_smf_track, lo)->time_pulses;
+	}
+
+	return (lo > 1) ? smf_track_get_event_by_number (_smf_track, lo - 1)->time_pulses : 0;
+}
+
 /** Read an event from the current position in file.
  *
  * File position MUST be at the beginning of a delta time, or this will die very messily.
@@ -65,6 +65,7 @@ Sequence<Time>::const_iterator::const_iterator()
 	, _active_patch_change_message (0)
 	, _type(NIL)
 	, _is_end(true)
+	, _note_index(0)
 	, _control_iter(_control_iters.end())
 	, _force_discrete(false)
 {
@@ -81,7 +82,7 @@ Sequence<Time>::const_iterator::const_iterator(const Sequence<Time>&
 	, _active_patch_change_message (0)
 	, _type(NIL)
 	, _is_end((t == DBL_MAX) || seq.empty())
-	, _note_iter(seq.notes().end())
+	, _note_index(0)
 	, _sysex_iter(seq.sysexes().end())
 	, _patch_change_iter(seq.patch_changes().end())
 	, _control_iter(_control_iters.end())
@@ -107,7 +108,8 @@ Sequence<Time>::const_iterator::const_iterator(const Sequence<Time>&
 	}
 
 	// Find first note which begins at or after t
-	_note_iter = seq.note_lower_bound(t);
+	const NoteTable& notes (seq.note_table());
+	_note_index = std::lower_bound (notes.times.begin(), notes.times.end(), t) - notes.times.begin();
 
 	// Find first sysex event at or after t
 	for (typename Sequence<Time>::SysExes::const_iterator i = seq.sysexes().begin();
@@ -220,7 +222,7 @@ Sequence<Time>::const_iterator::invalidate(std::set< boost::weak_ptr< Note<Time>
 	_type = NIL;
 	_is_end = true;
 	if (_seq) {
-		_note_iter = _seq->notes().end();
+		_note_index = _seq->_note_table.times.size();
 		_sysex_iter = _seq->sysexes().end();
 		_patch_change_iter = _seq->patch_changes().end();
 		_active_patch_change_message = 0;
@@ -237,9 +239,9 @@ Sequence<Time>::const_iterator::choose_next(Time earliest_t)
 	_type = NIL;
 
 	// Next earliest note on
-	if (_note_iter != _seq->notes().end()) {
+	if (_note_index < _seq->_note_table.times.size()) {
 		_type      = NOTE_ON;
-		earliest_t = (*_note_iter)->time();
+		earliest_t = _seq->_note_table.times[_note_index];
 	}
 
 	// Use the next note off iff it's earlier or the same time as the note on
@@ -284,8 +286,8 @@ Sequence<Time>::const_iterator::set_event()
 	switch (_type) {
 	case NOTE_ON:
 		DEBUG_TRACE(DEBUG::Sequence, "iterator = note on\n");
-		*_event = (*_note_iter)->on_event();
-		_active_notes.push(*_note_iter);
+		*_event = _seq->_note_table.notes[_note_index]->on_event();
+		_active_notes.push(_seq->_note_table.notes[_note_index]);
 		break;
 	case NOTE_OFF:
 		DEBUG_TRACE(DEBUG::Sequence, "iterator = note off\n");
@@ -348,7 +350,7 @@ Sequence<Time>::const_iterator::operator++()
 	// Increment past current event
 	switch (_type) {
 	case NOTE_ON:
-		++_note_iter;
+		++_note_index;
 		break;
 	case NOTE_OFF:
 		_active_notes.pop();
@@ -430,7 +432,7 @@ Sequence<Time>::const_iterator::operator=(const const_iterator& other)
 	_active_notes  = other._active_notes;
 	_type          = other._type;
 	_is_end        = other._is_end;
-	_note_iter     = other._note_iter;
+	_note_index    = other._note_index;
 	_sysex_iter    = other._sysex_iter;
 	_patch_change_iter = other._patch_change_iter;
 	_control_iters = other._control_iters;
@@ -462,6 +464,7 @@ Sequence<Time>::Sequence(const TypeMap& type_map)
 	, _overlap_pitch_resolution (FirstOnFirstOff)
 	, _writing(false)
 	, _type_map(type_map)
+	, _note_table_dirty(true)
 	, _end_iter(*this, std::numeric_limits<Time>::max(), false, std::set<Evoral::Parameter> ())
 	, _percussive(false)
 	, _lowest_note(127)
@@ -484,6 +487,7 @@ Sequence<Time>::Sequence(const Sequence<Time>& other)
 	, _overlap_pitch_resolution (other._overlap_pitch_resolution)
 	, _writing(false)
 	, _type_map(other._type_map)
+	, _note_table_dirty(true)
 	, _end_iter(*this, std::numeric_limits<Time>::max(), false, std::set<Evoral::Parameter> ())
 	, _percussive(other._percussive)
 	, _lowest_note(other._lowest_note)
@@ -597,6 +601,9 @@ Sequence<Time>::clear()
 {
 	WriteLock lock(write_lock());
 	_notes.clear();
+	_note_table.times.clear ();
+	_note_table.notes.clear ();
+	note_table_changed ();
 	for (Controls::iterator li = _controls.begin(); li != _controls.end(); ++li)
 		li->second->list()->clear();
 }
@@ -666,10 +673,19 @@ Sequence<Time>::end_write (StuckNoteOption option, Time when)
 		n = next;
 	}
 
+	if (option != Relax) {
+		note_table_changed ();
+	}
+
 	for (int i = 0; i < 16; ++i) {
 		_write_notes[i].clear();
 	}
 
+	for (std::set< boost::shared_ptr<ControlList> >::iterator l = _write_lists.begin(); l != _write_lists.end(); ++l) {
+		(*l)->thaw ();
+	}
+	_write_lists.clear ();
+
 	_writing = false;
 }
 
@@ -700,6 +716,17 @@ Sequence<Time>::add_note_unlocked(const NotePtr note, void* arg)
 	_notes.insert (note);
 	_pitches[note->channel()].insert (note);
 
+	if (!_note_table_dirty && _note_table.notes.size() == _notes.size() - 1 &&
+	    (_note_table.times.empty() || _note_table.times.back() <= note->time())) {
+		/* appended in time order, as when recording or loading: the
+		   table can simply grow rather than being rebuilt.
+		*/
+		_note_table.times.push_back (note->time());
+		_note_table.notes.push_back (note);
+	} else {
+		note_table_changed ();
+	}
+
 	_edited = true;
 
 	return true;
@@ -834,6 +861,7 @@ Sequence<Time>::remove_note_unlocked(const constNotePtr note)
 			warning << string_compose ("erased note %1 not found in pitches for channel %2", *note, (int) note->channel()) << endmsg;
 		}
 
+		note_table_changed ();
 		_edited = true;
 	
 	} else {
@@ -1043,7 +1071,11 @@ Sequence<Time>::append_control_unlocked(const Parameter& param, Time time, doubl
 	DEBUG_TRACE (DEBUG::Sequence, string_compose ("%1 %2 @ %3 = %4 # controls: %5\n",
 	                                              this, _type_map.to_symbol(param), time, value, _controls.size()));
 	boost::shared_ptr<Control> c = control(param, true);
-	c->list()->add (time.to_double(), value);
+	boost::shared_ptr<ControlList> l = c->list();
+	if (_writing && _write_lists.insert (l).second) {
+		l->freeze ();
+	}
+	l->add (time.to_double(), value);
 	/* XXX control events should use IDs */
 }
 
@@ -1168,6 +1200,34 @@ void
 Sequence<Time>::set_notes (const typename Sequence<Time>::Notes& n)
 {
 	_notes = n;
+	note_table_changed ();
+}
+
+/** @return the note table, first bringing it up to date with _notes if
+ *  necessary.  The caller must hold at least a read lock.
+ */
+template<typename Time>
+const typename Sequence<Time>::NoteTable&
+Sequence<Time>::note_table () const
+{
+	Glib::Threads::Mutex::Lock lm (_note_table_lock);
+
+	if (_note_table_dirty || _note_table.notes.size() != _notes.size()) {
+
+		_note_table.times.clear ();
+		_note_table.notes.clear ();
+		_note_table.times.reserve (_notes.size());
+		_note_table.notes.reserve (_notes.size());
+
+		for (typename Notes::const_iterator i = _notes.begin(); i != _notes.end(); ++i) {
+			_note_table.times.push_back ((*i)->time());
+			_note_table.notes.push_back (*i);
+		}
+
+		_note_table_dirty = false;
+	}
+
+	return _note_table;
 }
 
 // CONST iterator implementations (x3)
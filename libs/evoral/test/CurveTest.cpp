@@ -228,6 +228,120 @@ CurveTest::ctrlListEval ()
 	CPPUNIT_ASSERT_EQUAL(9.0, cl->unlocked_eval(999.));
 }
 
+/* render the curve for [x0, x0 + 63] and check that every element is what
+   ControlList::unlocked_eval() says it should be.
+*/
+#define BLOCK64EVALCMP(CL, X0)                                                 \
+    (CL)->curve ().get_vector ((X0), (X0) + 63.0, vec, 64);                    \
+    for (int i = 0; i < 64; ++i) {                                             \
+        char msg[64];                                                          \
+        snprintf (msg, 64, "at x=%.1f", (X0) + i);                             \
+        CPPUNIT_ASSERT_EQUAL_MESSAGE (                                         \
+            msg, (float) (CL)->unlocked_eval ((X0) + i), vec[i]);              \
+    }
+
+void
+CurveTest::blockwiseLinear ()
+{
+	float vec[64];
+
+	boost::shared_ptr<Evoral::ControlList> a = TestCtrlList();
+	boost::shared_ptr<Evoral::ControlList> b = TestCtrlList();
+
+	a->create_curve ();
+	b->create_curve ();
+	a->set_interpolation (ControlList::Linear);
+	b->set_interpolation (ControlList::Linear);
+
+	/* segments both longer and shorter than a block, and a flat one */
+	for (int x = 0; x <= 1200; x += 100) {
+		a->fast_simple_add (x, (x / 100) % 2 ? 1.0 : 0.25);
+	}
+	a->fast_simple_add (1250.0, 0.25);
+	for (int x = 0; x <= 1300; x += 10) {
+		b->fast_simple_add (x, (x % 30) / 30.0);
+	}
+	b->fast_simple_add (1305.0, 0.5);
+	b->fast_simple_add (1400.0, 0.5);
+
+	/* play forwards, interleaving the two lists as two tracks would */
+	for (double x0 = 0; x0 < 1280; x0 += 64) {
+		BLOCK64EVALCMP (a, x0);
+		BLOCK64EVALCMP (b, x0);
+	}
+
+	/* locate backwards, and to a position that is not block aligned */
+	BLOCK64EVALCMP (a, 300.0);
+	BLOCK64EVALCMP (a, 17.0);
+	BLOCK64EVALCMP (b, 1001.0);
+
+	/* and again after a change to the list */
+	a->fast_simple_add (1300.0, 0.75);
+	BLOCK64EVALCMP (a, 1001.0);
+	BLOCK64EVALCMP (a, 1236.0);
+}
+
+void
+CurveTest::rtSnapshot ()
+{
+	boost::shared_ptr<Evoral::ControlList> cl = TestCtrlList();
+	bool ok;
+
+	cl->create_curve ();
+
+	/* an empty list gives the default */
+	CPPUNIT_ASSERT_EQUAL (cl->unlocked_eval (50.), cl->rt_safe_eval (50., ok));
+	CPPUNIT_ASSERT (ok);
+
+	cl->fast_simple_add (   0.0 , 2.0);
+	cl->fast_simple_add ( 100.0 , 4.0);
+	cl->fast_simple_add ( 100.0 , 5.0);
+	cl->fast_simple_add ( 200.0 , 0.0);
+	cl->fast_simple_add ( 300.0 , 8.0);
+
+	const ControlList::InterpolationStyle styles[] = { ControlList::Discrete, ControlList::Linear };
+
+	for (size_t s = 0; s < sizeof (styles) / sizeof (styles[0]); ++s) {
+		cl->set_interpolation (styles[s]);
+		for (double x = -10.0; x < 320.0; x += 2.5) {
+			CPPUNIT_ASSERT_EQUAL (cl->unlocked_eval (x), cl->rt_safe_eval (x, ok));
+			CPPUNIT_ASSERT (ok);
+		}
+	}
+
+	/* readers are not held up by a writer */
+	{
+		Glib::Threads::RWLock::WriterLock lm (cl->lock ());
+		CPPUNIT_ASSERT_EQUAL (3.0, cl->rt_safe_eval (50., ok));
+		CPPUNIT_ASSERT (ok);
+	}
+
+	/* a reader keeps the snapshot it has while the list changes */
+	boost::shared_ptr<ControlList::Snapshot> old = cl->snapshot ();
+
+	cl->fast_simple_add (400.0, 10.0);
+
+	CPPUNIT_ASSERT_EQUAL (8.0, old->eval (350.));
+	CPPUNIT_ASSERT_EQUAL (9.0, cl->rt_safe_eval (350., ok));
+
+	/* changes made while frozen are published together on thaw */
+	cl->freeze ();
+	cl->fast_simple_add (500.0, 0.0);
+	cl->fast_simple_add (600.0, 4.0);
+	CPPUNIT_ASSERT_EQUAL (10.0, cl->rt_safe_eval (550., ok));
+	cl->thaw ();
+	CPPUNIT_ASSERT_EQUAL (2.0, cl->rt_safe_eval (550., ok));
+
+	/* rendering without the lock gives the same as with it */
+	float locked[64];
+	float unlocked[64];
+	cl->curve ().get_vector (0, 630.0, locked, 64);
+	CPPUNIT_ASSERT (cl->curve ().rt_safe_get_vector (0, 630.0, unlocked, 64));
+	for (int i = 0; i < 64; ++i) {
+		CPPUNIT_ASSERT_EQUAL (locked[i], unlocked[i]);
+	}
+}
+
 void
 CurveTest::constrainedCubic ()
 {
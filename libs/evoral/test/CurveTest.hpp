@@ -11,6 +11,8 @@ class CurveTest : public CppUnit::TestFixture
 	CPPUNIT_TEST (threePointDiscete);
 	CPPUNIT_TEST (constrainedCubic);
 	CPPUNIT_TEST (ctrlListEval);
+	CPPUNIT_TEST (blockwiseLinear);
+	CPPUNIT_TEST (rtSnapshot);
 	CPPUNIT_TEST_SUITE_END ();
 
 public:
@@ -19,6 +21,8 @@ public:
 	void threePointDiscete ();
 	void constrainedCubic ();
 	void ctrlListEval ();
+	void blockwiseLinear ();
+	void rtSnapshot ();
 
 private:
 	boost::shared_ptr<Evoral::ControlList> TestCtrlList() {
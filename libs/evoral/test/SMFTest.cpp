@@ -1,5 +1,9 @@
 #include "SMFTest.hpp"
 
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
 #include <glibmm/fileutils.h>
 #include <glibmm/miscutils.h>
 
@@ -67,3 +71,65 @@ SMFTest::takeFiveTest ()
 	                Evoral::Beats::ticks_at_rate(time, smf.ppqn()));
 	CPPUNIT_ASSERT(!seq->empty());
 }
+
+/** Seeking to a time should leave the file ready to read the events from that
+ *  time on, just as reading from the start and skipping the earlier ones would.
+ */
+void
+SMFTest::seekTest ()
+{
+	TestSMF smf;
+	string testdata_path;
+	CPPUNIT_ASSERT (find_file (test_search_path (), "TakeFive.mid", testdata_path));
+	smf.open(testdata_path);
+	CPPUNIT_ASSERT(!smf.is_empty());
+
+	/* read the whole track, noting the time and first byte of each event */
+
+	vector<uint64_t> times;
+	vector<int> firsts;
+
+	smf.seek_to_start();
+
+	uint64_t time = 0; /* in SMF ticks */
+	uint32_t delta_t = 0;
+	uint32_t size    = 0;
+	uint8_t* buf     = NULL;
+	int ret;
+	while ((ret = smf.read_event(&delta_t, &size, &buf)) >= 0) {
+		time += delta_t;
+		times.push_back (time);
+		firsts.push_back (ret > 0 ? buf[0] : -1);
+	}
+
+	CPPUNIT_ASSERT (times.size() > 2);
+
+	/* seek to the start, between events, onto them and past the end */
+
+	vector<uint64_t> targets;
+	targets.push_back (0);
+	targets.push_back (times[times.size() / 3]);
+	targets.push_back (times[times.size() / 2] + 1);
+	targets.push_back (times.back());
+	targets.push_back (times.back() + 1);
+
+	for (vector<uint64_t>::const_iterator t = targets.begin(); t != targets.end(); ++t) {
+
+		size_t i = lower_bound (times.begin(), times.end(), *t) - times.begin();
+
+		time = smf.seek_to_ticks (*t);
+		CPPUNIT_ASSERT_EQUAL (i > 0 ? times[i - 1] : 0, time);
+
+		while ((ret = smf.read_event(&delta_t, &size, &buf)) >= 0) {
+			time += delta_t;
+			CPPUNIT_ASSERT (i < times.size());
+			CPPUNIT_ASSERT_EQUAL (times[i], time);
+			CPPUNIT_ASSERT_EQUAL (firsts[i], ret > 0 ? (int) buf[0] : -1);
+			++i;
+		}
+
+		CPPUNIT_ASSERT_EQUAL (times.size(), i);
+	}
+
+	free (buf);
+}
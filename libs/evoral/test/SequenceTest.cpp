@@ -1,5 +1,7 @@
 #include "SequenceTest.hpp"
 #include <cassert>
+#include <iostream>
+#include <glib.h>
 
 CPPUNIT_TEST_SUITE_REGISTRATION(SequenceTest);
 
@@ -154,3 +156,95 @@ SequenceTest::controlInterpolationTest ()
 		last_value = i->second;
 	}
 }
+
+/** Check that iteration sees notes added and removed since the last
+ *  iterator was made, including ones added out of time order.
+ */
+void
+SequenceTest::noteEditIterationTest ()
+{
+	seq->clear();
+
+	for (Notes::const_iterator i = test_notes.begin(); i != test_notes.end(); ++i) {
+		seq->add_note_unlocked (*i);
+	}
+
+	size_t num_on = 0;
+	for (Sequence<Time>::const_iterator i = seq->begin(); i != seq->end(); ++i) {
+		if (((const MIDIEvent<Time>&)*i).is_note_on()) {
+			++num_on;
+		}
+	}
+	CPPUNIT_ASSERT_EQUAL (size_t(12), num_on);
+
+	seq->remove_note_unlocked (test_notes[3]);
+	seq->remove_note_unlocked (test_notes[7]);
+
+	boost::shared_ptr<Note<Time> > early (new Note<Time>(0, Beats(150), Beats(10), 40, 64));
+	seq->add_note_unlocked (early);
+
+	vector<Time> on_times;
+	Time last (0);
+	for (Sequence<Time>::const_iterator i = seq->begin(Beats(100)); i != seq->end(); ++i) {
+		CPPUNIT_ASSERT (last <= i->time());
+		last = i->time();
+		if (((const MIDIEvent<Time>&)*i).is_note_on()) {
+			on_times.push_back (i->time());
+		}
+	}
+
+	/* notes at 100 .. 1100, less 300 and 700, plus 150 */
+	CPPUNIT_ASSERT_EQUAL (size_t(10), on_times.size());
+	CPPUNIT_ASSERT (on_times[0] == Beats(100));
+	CPPUNIT_ASSERT (on_times[1] == Beats(150));
+	CPPUNIT_ASSERT (on_times[2] == Beats(200));
+	CPPUNIT_ASSERT (on_times[3] == Beats(400));
+	CPPUNIT_ASSERT (on_times[6] == Beats(800));
+
+	seq->clear();
+	CPPUNIT_ASSERT (seq->begin() == seq->end());
+}
+
+void
+SequenceTest::iterationBenchmark ()
+{
+	seq->clear();
+
+	int const n = 100000;
+
+	gint64 start = g_get_monotonic_time ();
+
+	for (int i = 0; i < n; ++i) {
+		boost::shared_ptr<Note<Time> > note (
+			new Note<Time>(i % 16, Beats(i * 0.25), Beats(1), 36 + (i % 48), 100));
+		seq->add_note_unlocked (note);
+	}
+
+	gint64 const add_time = g_get_monotonic_time () - start;
+
+	size_t events = 0;
+
+	start = g_get_monotonic_time ();
+
+	for (Sequence<Time>::const_iterator i = seq->begin(); i != seq->end(); ++i) {
+		++events;
+	}
+
+	gint64 const iterate_time = g_get_monotonic_time () - start;
+
+	CPPUNIT_ASSERT_EQUAL (size_t(2 * n), events);
+
+	/* seek into the middle many times, as playback of a loop does */
+
+	start = g_get_monotonic_time ();
+
+	for (int i = 0; i < 1000; ++i) {
+		Sequence<Time>::const_iterator j = seq->begin(Beats((i * 97) % (n / 4)));
+		CPPUNIT_ASSERT (j != seq->end());
+	}
+
+	gint64 const seek_time = g_get_monotonic_time () - start;
+
+	cout << "\n" << n << " notes: add " << add_time / 1000.0 << " ms, iterate "
+	     << iterate_time / 1000.0 << " ms, 1000 seeks " << seek_time / 1000.0 << " ms\n";
+}
@@ -110,6 +110,8 @@ class SequenceTest : public CppUnit::TestFixture
 	CPPUNIT_TEST (preserveEventOrderingTest);
 	CPPUNIT_TEST (iteratorSeekTest);
 	CPPUNIT_TEST (controlInterpolationTest);
+	CPPUNIT_TEST (noteEditIterationTest);
+	CPPUNIT_TEST (iterationBenchmark);
 	CPPUNIT_TEST_SUITE_END ();
 
 public:
@@ -139,6 +141,8 @@ public:
 	void preserveEventOrderingTest ();
 	void iteratorSeekTest ();
 	void controlInterpolationTest ();
+	void noteEditIterationTest ();
+	void iterationBenchmark ();
 
 private:
 	DummyTypeMap*       type_map;
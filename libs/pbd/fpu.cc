@@ -27,6 +27,8 @@
 
 #ifdef PLATFORM_WINDOWS
 #include <intrin.h>
+#elif (defined __x86_64__) || (defined __i386__)
+#include <cpuid.h>
 #endif
 
 #include "pbd/fpu.h"
@@ -104,6 +106,8 @@ FPU::FPU ()
 		_flags = Flags (_flags | HasSSE2);
 	}
 
+	check_avx ();
+
 	if (cpuflags & (1 << 24)) {
 		
 		char** fxbuf = 0;
@@ -178,6 +182,80 @@ FPU::FPU ()
 #endif
 }			
 
+/** Look for AVX and its successors.  Each needs support from the CPU
+ *  (cpuid) and from the OS, which has to save and restore the wider
+ *  registers on a context switch (xgetbv).
+ */
+void
+FPU::check_avx ()
+{
+#if ( (defined __x86_64__) || (defined __i386__) || (defined _M_X64) || (defined _M_IX86) )
+	uint32_t regs[4]; /* eax, ebx, ecx, edx */
+
+#ifdef PLATFORM_WINDOWS
+	__cpuid ((int*) regs, 0);
+#else
+	__cpuid (0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+	uint32_t const max_leaf = regs[0];
+
+#ifdef PLATFORM_WINDOWS
+	__cpuid ((int*) regs, 1);
+#else
+	__cpuid (1, regs[0], regs[1], regs[2], regs[3]);
+#endif
+
+	bool const osxsave = regs[2] & (1<<27);
+	bool const avx = regs[2] & (1<<28);
+	bool const fma = regs[2] & (1<<12);
+
+	if (!osxsave || !avx) {
+		return;
+	}
+
+	/* XCR0: which register state the OS saves */
+
+	uint32_t xcr0_lo;
+#ifdef COMPILER_MSVC
+	xcr0_lo = (uint32_t) _xgetbv (0);
+#else
+	uint32_t xcr0_hi;
+	/* xgetbv, spelled out for assemblers that do not know it */
+	asm volatile (".byte 0x0f, 0x01, 0xd0" : "=a" (xcr0_lo), "=d" (xcr0_hi) : "c" (0));
+#endif
+
+	if ((xcr0_lo & 0x6) != 0x6) {
+		/* XMM and YMM state not saved */
+		return;
+	}
+
+	_flags = Flags (_flags | HasAVX);
+
+	if (fma) {
+		_flags = Flags (_flags | HasFMA);
+	}
+
+	if (max_leaf < 7) {
+		return;
+	}
+
+#ifdef PLATFORM_WINDOWS
+	__cpuidex ((int*) regs, 7, 0);
+#else
+	__cpuid_count (7, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+
+	if (regs[1] & (1<<5)) {
+		_flags = Flags (_flags | HasAVX2);
+	}
+
+	if ((regs[1] & (1<<16)) && (xcr0_lo & 0xe6) == 0xe6) {
+		/* AVX-512 foundation, with opmask and ZMM state saved */
+		_flags = Flags (_flags | HasAVX512F);
+	}
+#endif
+}
+
 FPU::~FPU ()
 {
 }
@@ -31,7 +31,10 @@ class LIBPBD_API FPU {
 		HasDenormalsAreZero = 0x2,
 		HasSSE = 0x4,
 		HasSSE2 = 0x8,
-		HasAVX = 0x10
+		HasAVX = 0x10,
+		HasAVX2 = 0x20,
+		HasFMA = 0x40,
+		HasAVX512F = 0x80
 	};
 
   public:
@@ -43,9 +46,14 @@ class LIBPBD_API FPU {
 	bool has_sse () const { return _flags & HasSSE; }
 	bool has_sse2 () const { return _flags & HasSSE2; }
 	bool has_avx () const { return _flags & HasAVX; }
+	bool has_avx2 () const { return _flags & HasAVX2; }
+	bool has_fma () const { return _flags & HasFMA; }
+	bool has_avx512f () const { return _flags & HasAVX512F; }
 	
   private:
 	Flags _flags;
+
+	void check_avx ();
 };
 
 }
@@ -301,6 +301,12 @@ class /*LIBPBD_API*/ SequenceProperty : public PropertyBase
 		}
 		_val.clear ();
 	}
+
+	/* reordering the sequence adds or removes nothing, so there are no changes to record */
+	template<typename Compare>
+	void sort (Compare cmp) {
+		_val.sort (cmp);
+	}
 	
 	typename Container::size_type size() const { 
 		return _val.size();
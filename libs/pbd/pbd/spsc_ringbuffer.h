@@ -0,0 +1,300 @@
+/*
+    Copyright (C) 2015 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __libpbd_spsc_ringbuffer_h__
+#define __libpbd_spsc_ringbuffer_h__
+
+#include <cstring>
+#include <glib.h>
+
+#include "pbd/libpbd_visibility.h"
+#include "pbd/malign.h"
+
+namespace PBD {
+
+/** A single-producer, single-consumer ringbuffer of any (non-power-of-two)
+ *  size, with the same interface as RingBufferNPT.
+ *
+ *  RingBufferNPT keeps both of its indices next to each other, so every
+ *  time one side moves its index the cache line holding the other side's
+ *  index is invalidated as well.  Here each index lives on its own cache
+ *  line together with a private copy of the other side's index.  read()
+ *  and write() only look at the other side's index when their cached copy
+ *  says there is not enough data or space, so while a buffer is neither
+ *  nearly empty nor nearly full the two threads hardly ever touch each
+ *  other's cache lines.  Indices are published with release and read with
+ *  acquire semantics, rather than the full barriers of g_atomic_int_*.
+ *
+ *  The buffer itself is cache-line aligned and copied with memcpy(), which
+ *  does the vectorised bulk copy; T must therefore be a type that can be
+ *  copied with memcpy().
+ *
+ *  read() and the read-pointer methods must only be called by the
+ *  consumer; write() and increment_write_ptr() only by the producer.
+ *  read_space(), write_space(), get_read_vector() and get_write_vector()
+ *  change nothing, and may be called by either side or any other thread.
+ */
+template<class T>
+class /*LIBPBD_API*/ SPSCRingBuffer
+{
+  public:
+	SPSCRingBuffer (size_t sz) {
+		size = sz;
+		void* mem;
+		cache_aligned_malloc (&mem, size * sizeof (T));
+		buf = (T*) mem;
+		reset ();
+	}
+
+	virtual ~SPSCRingBuffer () {
+		cache_aligned_free (buf);
+	}
+
+	void reset () {
+		/* !!! NOT THREAD SAFE !!! */
+		store (&producer.ptr, 0);
+		store (&consumer.ptr, 0);
+		producer.cached = 0;
+		consumer.cached = 0;
+	}
+
+	void set (size_t r, size_t w) {
+		/* !!! NOT THREAD SAFE !!! */
+		store (&producer.ptr, w);
+		store (&consumer.ptr, r);
+		producer.cached = r;
+		consumer.cached = w;
+	}
+
+	size_t  read  (T *dest, size_t cnt);
+	size_t  write (const T *src, size_t cnt);
+
+	struct rw_vector {
+	    T *buf[2];
+	    size_t len[2];
+	};
+
+	void get_read_vector (rw_vector *);
+	void get_write_vector (rw_vector *);
+
+	void decrement_read_ptr (size_t cnt) {
+		store (&consumer.ptr, (own (&consumer.ptr) + size - (cnt % size)) % size);
+	}
+
+	/* the caller may have used read_space() or write_space() to decide
+	   how far to move, in which case the pointer may move past our cached
+	   copy of the other side's pointer; so refresh it as well.
+	*/
+
+	void increment_read_ptr (size_t cnt) {
+		store (&consumer.ptr, (own (&consumer.ptr) + cnt) % size);
+		consumer.cached = load (&producer.ptr);
+	}
+
+	void increment_write_ptr (size_t cnt) {
+		store (&producer.ptr, (own (&producer.ptr) + cnt) % size);
+		producer.cached = load (&consumer.ptr);
+	}
+
+	size_t write_space () const {
+		return space_for_write (load (&producer.ptr), load (&consumer.ptr));
+	}
+
+	size_t read_space () const {
+		return space_for_read (load (&producer.ptr), load (&consumer.ptr));
+	}
+
+	T *buffer () { return buf; }
+	size_t get_write_ptr () const { return load (&producer.ptr); }
+	size_t get_read_ptr () const { return load (&consumer.ptr); }
+	size_t bufsize () const { return size; }
+
+  protected:
+	T *buf;
+	size_t size;
+
+  private:
+	/** One side's index, and that side's cached copy of the other side's
+	 *  index, followed by a whole cache line of padding.  Objects may be
+	 *  allocated with new, which does not honour any alignment beyond the
+	 *  usual, so padding to a multiple of the line size would not stop two
+	 *  Indexes sharing a line; a full line between them always does.
+	 */
+	struct Index {
+		gint   ptr;
+		size_t cached;
+		char   pad[64];
+	};
+
+	/* keep the indices off the line holding buf and size, which both
+	   sides read all the time.
+	*/
+	char  pad0[64];
+	Index producer;
+	Index consumer;
+
+	size_t space_for_write (size_t w, size_t r) const {
+		if (w > r) {
+			return ((r - w + size) % size) - 1;
+		} else if (w < r) {
+			return (r - w) - 1;
+		} else {
+			return size - 1;
+		}
+	}
+
+	size_t space_for_read (size_t w, size_t r) const {
+		if (w > r) {
+			return w - r;
+		} else {
+			return (w - r + size) % size;
+		}
+	}
+
+#if defined(__ATOMIC_ACQUIRE)
+	/** read the other side's index */
+	static size_t load (gint const * p) { return __atomic_load_n (p, __ATOMIC_ACQUIRE); }
+	/** read our own index; nobody else writes it */
+	static size_t own (gint const * p) { return __atomic_load_n (p, __ATOMIC_RELAXED); }
+	static void store (gint* p, size_t v) { __atomic_store_n (p, (gint) v, __ATOMIC_RELEASE); }
+#else
+	static size_t load (gint const * p) { return g_atomic_int_get (p); }
+	static size_t own (gint const * p) { return g_atomic_int_get (p); }
+	static void store (gint* p, size_t v) { g_atomic_int_set (p, (gint) v); }
+#endif
+};
+
+template<class T> /*LIBPBD_API*/ size_t
+SPSCRingBuffer<T>::read (T *dest, size_t cnt)
+{
+	size_t const r = own (&consumer.ptr);
+	size_t avail = space_for_read (consumer.cached, r);
+
+	if (avail < cnt) {
+		consumer.cached = load (&producer.ptr);
+		avail = space_for_read (consumer.cached, r);
+	}
+
+	if (avail == 0) {
+		return 0;
+	}
+
+	size_t const to_read = cnt > avail ? avail : cnt;
+	size_t const n1 = (r + to_read > size) ? size - r : to_read;
+	size_t const n2 = to_read - n1;
+
+	memcpy (dest, &buf[r], n1 * sizeof (T));
+
+	if (n2) {
+		memcpy (dest + n1, buf, n2 * sizeof (T));
+	}
+
+	store (&consumer.ptr, (r + to_read) % size);
+	return to_read;
+}
+
+template<class T> /*LIBPBD_API*/ size_t
+SPSCRingBuffer<T>::write (const T *src, size_t cnt)
+{
+	size_t const w = own (&producer.ptr);
+	size_t avail = space_for_write (w, producer.cached);
+
+	if (avail < cnt) {
+		producer.cached = load (&consumer.ptr);
+		avail = space_for_write (w, producer.cached);
+	}
+
+	if (avail == 0) {
+		return 0;
+	}
+
+	size_t const to_write = cnt > avail ? avail : cnt;
+	size_t const n1 = (w + to_write > size) ? size - w : to_write;
+	size_t const n2 = to_write - n1;
+
+	memcpy (&buf[w], src, n1 * sizeof (T));
+
+	if (n2) {
+		memcpy (buf, src + n1, n2 * sizeof (T));
+	}
+
+	store (&producer.ptr, (w + to_write) % size);
+	return to_write;
+}
+
+template<class T> /*LIBPBD_API*/ void
+SPSCRingBuffer<T>::get_read_vector (typename SPSCRingBuffer<T>::rw_vector *vec)
+{
+	/* this may be called from threads other than the consumer, so it
+	   must not touch consumer.cached.
+	*/
+	size_t const r = load (&consumer.ptr);
+	size_t const w = load (&producer.ptr);
+
+	size_t const free_cnt = space_for_read (w, r);
+	size_t const cnt2 = r + free_cnt;
+
+	if (cnt2 > size) {
+		/* Two part vector: the rest of the buffer after the
+		   current read ptr, plus some from the start of
+		   the buffer.
+		*/
+		vec->buf[0] = &buf[r];
+		vec->len[0] = size - r;
+		vec->buf[1] = buf;
+		vec->len[1] = cnt2 % size;
+	} else {
+		/* Single part vector: just the rest of the buffer */
+		vec->buf[0] = &buf[r];
+		vec->len[0] = free_cnt;
+		vec->buf[1] = 0;
+		vec->len[1] = 0;
+	}
+}
+
+template<class T> /*LIBPBD_API*/ void
+SPSCRingBuffer<T>::get_write_vector (typename SPSCRingBuffer<T>::rw_vector *vec)
+{
+	/* as for get_read_vector(), leave producer.cached alone */
+	size_t const w = load (&producer.ptr);
+	size_t const r = load (&consumer.ptr);
+
+	size_t const free_cnt = space_for_write (w, r);
+	size_t const cnt2 = w + free_cnt;
+
+	if (cnt2 > size) {
+		/* Two part vector: the rest of the buffer after the
+		   current write ptr, plus some from the start of
+		   the buffer.
+		*/
+		vec->buf[0] = &buf[w];
+		vec->len[0] = size - w;
+		vec->buf[1] = buf;
+		vec->len[1] = cnt2 % size;
+	} else {
+		vec->buf[0] = &buf[w];
+		vec->len[0] = free_cnt;
+		vec->buf[1] = 0;
+		vec->len[1] = 0;
+	}
+}
+
+} /* namespace */
+
+#endif /* __libpbd_spsc_ringbuffer_h__ */
@@ -0,0 +1,147 @@
+/*
+    Copyright (C) 2015 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __libpbd_work_stealing_deque_h__
+#define __libpbd_work_stealing_deque_h__
+
+#include <glib.h>
+
+#include "pbd/libpbd_visibility.h"
+
+namespace PBD {
+
+/** A fixed-size, lock-free work-stealing deque of pointers (Chase & Lev, 2005).
+ *
+ *  One thread owns the deque and is the only one allowed to push() and pop();
+ *  it works on the bottom end in LIFO order.  Any other thread may steal()
+ *  from the top end.  The buffer is allocated once, at construction time, so
+ *  none of the operations allocate memory and all of them are safe to call
+ *  from a realtime thread.  When the deque is full push() fails and the
+ *  caller is expected to hand the item on via some other route.
+ *
+ *  Indices are free-running and only ever compared by difference, so they
+ *  are allowed to wrap.  glib's atomic operations are full barriers, which
+ *  gives the orderings the algorithm requires.
+ */
+template<class T>
+class /*LIBPBD_API*/ WorkStealingDeque
+{
+  public:
+	WorkStealingDeque (guint sz) {
+		guint power_of_two;
+		for (power_of_two = 1; 1U<<power_of_two < sz; power_of_two++) {}
+		size = 1<<power_of_two;
+		size_mask = size - 1;
+		buf = new T*[size];
+		g_atomic_int_set (&top, 0);
+		g_atomic_int_set (&bottom, 0);
+	}
+
+	~WorkStealingDeque () {
+		delete [] buf;
+	}
+
+	/** Owner only: add @param item at the bottom end.
+	 *  @return false if the deque is full.
+	 */
+	bool push (T* item) {
+		guint b = g_atomic_int_get (&bottom);
+		guint t = g_atomic_int_get (&top);
+
+		if (b - t >= size) {
+			return false;
+		}
+
+		g_atomic_pointer_set (&buf[b & size_mask], item);
+		g_atomic_int_set (&bottom, b + 1);
+		return true;
+	}
+
+	/** Owner only: remove the most recently pushed item.
+	 *  @return the item, or 0 if the deque is empty.
+	 */
+	T* pop () {
+		guint b = g_atomic_int_get (&bottom) - 1;
+		g_atomic_int_set (&bottom, b);
+		guint t = g_atomic_int_get (&top);
+
+		if ((gint) (b - t) < 0) {
+			/* empty: restore bottom */
+			g_atomic_int_set (&bottom, b + 1);
+			return 0;
+		}
+
+		T* item = (T*) g_atomic_pointer_get (&buf[b & size_mask]);
+
+		if (b != t) {
+			/* more than one item left, no thief can reach this one */
+			return item;
+		}
+
+		/* last item: race against any thieves for it */
+		if (!g_atomic_int_compare_and_exchange (&top, t, t + 1)) {
+			item = 0;
+		}
+		g_atomic_int_set (&bottom, t + 1);
+		return item;
+	}
+
+	/** Any thread: remove the oldest item.
+	 *  @return the item, or 0 if the deque was empty or another thread
+	 *  won the race for the item.
+	 */
+	T* steal () {
+		guint t = g_atomic_int_get (&top);
+		guint b = g_atomic_int_get (&bottom);
+
+		if ((gint) (b - t) <= 0) {
+			return 0;
+		}
+
+		T* item = (T*) g_atomic_pointer_get (&buf[t & size_mask]);
+
+		if (!g_atomic_int_compare_and_exchange (&top, t, t + 1)) {
+			return 0;
+		}
+
+		return item;
+	}
+
+	/** @return an estimate of the number of items; exact only when
+	 *  called by the owner with no thieves active.
+	 */
+	guint read_space () const {
+		gint n = (gint) ((guint) g_atomic_int_get (&bottom) - (guint) g_atomic_int_get (&top));
+		return n > 0 ? (guint) n : 0;
+	}
+
+	bool empty () const { return read_space () == 0; }
+	guint bufsize () const { return size; }
+
+  private:
+	T** buf;
+	guint size;
+	guint size_mask;
+	mutable gint top;
+	mutable gint bottom;
+};
+
+} /* namespace */
+
+#endif /* __libpbd_work_stealing_deque_h__ */
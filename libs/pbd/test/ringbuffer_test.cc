@@ -0,0 +1,244 @@
+#include "ringbuffer_test.h"
+
+#include <iostream>
+#include <vector>
+
+#include <glib.h>
+#include <glibmm/threads.h>
+
+#include "pbd/ringbufferNPT.h"
+#include "pbd/spsc_ringbuffer.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (RingBufferTest);
+
+using namespace std;
+using namespace PBD;
+
+/* deliberately not a power of two */
+static const size_t buffer_size = 8191;
+
+template<class RB>
+static void
+produce (RB* rb, uint32_t total, uint32_t block)
+{
+	vector<uint32_t> data (block);
+	uint32_t n = 0;
+
+	while (n < total) {
+		uint32_t const cnt = min (block, total - n);
+
+		for (uint32_t i = 0; i < cnt; ++i) {
+			data[i] = n + i;
+		}
+
+		uint32_t done = 0;
+
+		while (done < cnt) {
+			size_t const w = rb->write (&data[done], cnt - done);
+			if (w == 0) {
+				Glib::Threads::Thread::yield ();
+			}
+			done += w;
+		}
+
+		n += cnt;
+	}
+}
+
+/** @return number of values that were not in sequence */
+template<class RB>
+static uint32_t
+consume (RB* rb, uint32_t total, uint32_t block)
+{
+	vector<uint32_t> data (block);
+	uint32_t n = 0;
+	uint32_t errors = 0;
+
+	while (n < total) {
+		size_t const r = rb->read (&data[0], block);
+
+		if (r == 0) {
+			Glib::Threads::Thread::yield ();
+			continue;
+		}
+
+		for (size_t i = 0; i < r; ++i) {
+			if (data[i] != n + i) {
+				++errors;
+			}
+		}
+
+		n += r;
+	}
+
+	return errors;
+}
+
+/** Stream @param total values through @param rb from a new thread.
+ *  @return number of values that arrived out of sequence.
+ */
+template<class RB>
+static uint32_t
+stream (RB* rb, uint32_t total, uint32_t block, gint64& usecs)
+{
+	gint64 const before = g_get_monotonic_time ();
+
+	Glib::Threads::Thread* t = Glib::Threads::Thread::create (
+		sigc::bind (sigc::ptr_fun (&produce<RB>), rb, total, block));
+
+	uint32_t const errors = consume (rb, total, block);
+
+	t->join ();
+
+	usecs = g_get_monotonic_time () - before;
+	return errors;
+}
+
+void
+RingBufferTest::testReadWrite ()
+{
+	SPSCRingBuffer<uint32_t> rb (buffer_size);
+	RingBufferNPT<uint32_t> ref (buffer_size);
+
+	CPPUNIT_ASSERT_EQUAL (buffer_size - 1, rb.write_space ());
+	CPPUNIT_ASSERT_EQUAL ((size_t) 0, rb.read_space ());
+
+	vector<uint32_t> in (buffer_size);
+	vector<uint32_t> out (buffer_size);
+	vector<uint32_t> ref_out (buffer_size);
+
+	uint32_t n = 0;
+
+	/* move through the buffer in steps that are coprime with its size,
+	   so that we wrap at every possible offset.
+	*/
+
+	for (int i = 0; i < 100; ++i) {
+		size_t const cnt = 997 + (i * 7) % 50;
+
+		for (size_t j = 0; j < cnt; ++j) {
+			in[j] = n++;
+		}
+
+		CPPUNIT_ASSERT_EQUAL (ref.write (&in[0], cnt), rb.write (&in[0], cnt));
+		CPPUNIT_ASSERT_EQUAL (ref.read_space (), rb.read_space ());
+		CPPUNIT_ASSERT_EQUAL (ref.write_space (), rb.write_space ());
+
+		size_t const got = rb.read (&out[0], cnt);
+		CPPUNIT_ASSERT_EQUAL (ref.read (&ref_out[0], cnt), got);
+
+		for (size_t j = 0; j < got; ++j) {
+			CPPUNIT_ASSERT_EQUAL (ref_out[j], out[j]);
+		}
+
+		CPPUNIT_ASSERT_EQUAL (ref.get_read_ptr (), rb.get_read_ptr ());
+		CPPUNIT_ASSERT_EQUAL (ref.get_write_ptr (), rb.get_write_ptr ());
+	}
+
+	/* fill it up completely */
+
+	CPPUNIT_ASSERT_EQUAL (buffer_size - 1, rb.write (&in[0], buffer_size));
+	CPPUNIT_ASSERT_EQUAL ((size_t) 0, rb.write_space ());
+	CPPUNIT_ASSERT_EQUAL ((size_t) 0, rb.write (&in[0], 1));
+
+	rb.reset ();
+	CPPUNIT_ASSERT_EQUAL ((size_t) 0, rb.read_space ());
+	CPPUNIT_ASSERT_EQUAL ((size_t) 0, rb.read (&out[0], 1));
+}
+
+void
+RingBufferTest::testVectors ()
+{
+	SPSCRingBuffer<uint32_t> rb (buffer_size);
+	RingBufferNPT<uint32_t> ref (buffer_size);
+
+	SPSCRingBuffer<uint32_t>::rw_vector v;
+	RingBufferNPT<uint32_t>::rw_vector rv;
+
+	for (int i = 0; i < 50; ++i) {
+		size_t const cnt = 1500 + i;
+
+		rb.get_write_vector (&v);
+		ref.get_write_vector (&rv);
+
+		CPPUNIT_ASSERT_EQUAL (rv.len[0], v.len[0]);
+		CPPUNIT_ASSERT_EQUAL (rv.len[1], v.len[1]);
+
+		/* fill via the vector and commit */
+
+		size_t const n1 = min (cnt, v.len[0]);
+		size_t const n2 = min (cnt - n1, v.len[1]);
+
+		for (size_t j = 0; j < n1; ++j) {
+			v.buf[0][j] = i;
+		}
+		for (size_t j = 0; j < n2; ++j) {
+			v.buf[1][j] = i;
+		}
+
+		rb.increment_write_ptr (n1 + n2);
+		ref.increment_write_ptr (n1 + n2);
+
+		rb.get_read_vector (&v);
+		ref.get_read_vector (&rv);
+
+		CPPUNIT_ASSERT_EQUAL (rv.len[0], v.len[0]);
+		CPPUNIT_ASSERT_EQUAL (rv.len[1], v.len[1]);
+		CPPUNIT_ASSERT_EQUAL (n1 + n2, v.len[0] + v.len[1]);
+		CPPUNIT_ASSERT_EQUAL ((uint32_t) i, v.buf[0][0]);
+
+		rb.increment_read_ptr (v.len[0] + v.len[1]);
+		ref.increment_read_ptr (rv.len[0] + rv.len[1]);
+
+		CPPUNIT_ASSERT_EQUAL (ref.get_read_ptr (), rb.get_read_ptr ());
+	}
+
+	/* move the read pointer using read_space() rather than a vector, then
+	   check that read() does not trust a stale idea of the write pointer.
+	*/
+
+	vector<uint32_t> data (100, 42);
+	rb.write (&data[0], 100);
+	rb.increment_read_ptr (rb.read_space ());
+	CPPUNIT_ASSERT_EQUAL ((size_t) 0, rb.read (&data[0], 100));
+}
+
+void
+RingBufferTest::testThreaded ()
+{
+	uint32_t const total = 4000000;
+	gint64 usecs;
+
+	SPSCRingBuffer<uint32_t> rb (buffer_size);
+
+	CPPUNIT_ASSERT_EQUAL ((uint32_t) 0, stream (&rb, total, 61, usecs));
+	CPPUNIT_ASSERT_EQUAL ((uint32_t) 0, stream (&rb, total, 1024, usecs));
+	CPPUNIT_ASSERT_EQUAL ((size_t) 0, rb.read_space ());
+}
+
+void
+RingBufferTest::testThroughput ()
+{
+	uint32_t const total = 50000000;
+	uint32_t const blocks[] = { 64, 256, 1024 };
+
+	for (size_t b = 0; b < sizeof (blocks) / sizeof (blocks[0]); ++b) {
+
+		gint64 npt_usecs;
+		gint64 spsc_usecs;
+
+		RingBufferNPT<uint32_t> npt (buffer_size * 8);
+		SPSCRingBuffer<uint32_t> spsc (buffer_size * 8);
+
+		CPPUNIT_ASSERT_EQUAL ((uint32_t) 0, stream (&npt, total, blocks[b], npt_usecs));
+		CPPUNIT_ASSERT_EQUAL ((uint32_t) 0, stream (&spsc, total, blocks[b], spsc_usecs));
+
+		double const mbytes = total * sizeof (uint32_t) / 1048576.0;
+
+		cout << endl << "ringbuffer throughput, " << blocks[b] << " element blocks: "
+		     << "RingBufferNPT " << mbytes / (npt_usecs / 1e6) << " MB/s, "
+		     << "SPSCRingBuffer " << mbytes / (spsc_usecs / 1e6) << " MB/s";
+	}
+
+	cout << endl;
+}
@@ -0,0 +1,24 @@
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+/**
+ * Checks SPSCRingBuffer against the behaviour of RingBufferNPT, both from
+ * a single thread and with a producer and consumer on separate threads,
+ * and reports the throughput of each when streaming blocks of data
+ * from one thread to another.
+ */
+class RingBufferTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE (RingBufferTest);
+	CPPUNIT_TEST (testReadWrite);
+	CPPUNIT_TEST (testVectors);
+	CPPUNIT_TEST (testThreaded);
+	CPPUNIT_TEST (testThroughput);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	void testReadWrite ();
+	void testVectors ();
+	void testThreaded ();
+	void testThroughput ();
+};
@@ -41,6 +41,7 @@
 #include "ardour/audio_track.h"
 #include "ardour/midi_track.h"
 #include "ardour/dB.h"
+#include "ardour/dsp_profiler.h"
 #include "ardour/filesystem_paths.h"
 #include "ardour/panner.h"
 #include "ardour/plugin.h"
@@ -334,6 +335,7 @@ OSC::register_callbacks()
 #define REGISTER_CALLBACK(serv,path,types, function) lo_server_add_method (serv, path, types, OSC::_ ## function, this)
 
 		REGISTER_CALLBACK (serv, "/routes/list", "", routes_list);
+		REGISTER_CALLBACK (serv, "/routes/dsp_profile", "", routes_dsp_profile);
 		REGISTER_CALLBACK (serv, "/ardour/add_marker", "", add_marker);
 		REGISTER_CALLBACK (serv, "/ardour/access_action", "s", access_action);
 		REGISTER_CALLBACK (serv, "/ardour/loop_toggle", "", loop_toggle);
@@ -784,6 +786,71 @@ OSC::routes_list (lo_message msg)
 	lo_message_free (reply);
 }
 
+static void
+add_dsp_stats (lo_message reply, void const* object)
+{
+	DSPProfiler::Stats s;
+
+	DSPProfiler::stats (object, s);
+
+	lo_message_add_int32 (reply, s.count);
+	lo_message_add_float (reply, s.min);
+	lo_message_add_float (reply, s.avg);
+	lo_message_add_float (reply, s.max);
+	lo_message_add_float (reply, s.p95);
+	lo_message_add_float (reply, s.p99);
+}
+
+/** Reply with recent DSP timings (in microseconds per cycle) for every route,
+ *  followed by those of each of its processors.  Timings are only
+ *  collected while the "dsp-profiling" option is enabled.
+ */
+void
+OSC::routes_dsp_profile (lo_message msg)
+{
+	for (int n = 0; n < (int) session->nroutes(); ++n) {
+
+		boost::shared_ptr<Route> r = session->route_by_remote_id (n);
+
+		if (!r) {
+			continue;
+		}
+
+		lo_message reply = lo_message_new ();
+
+		lo_message_add_string (reply, "route");
+		lo_message_add_int32 (reply, r->remote_control_id());
+		lo_message_add_string (reply, r->name().c_str());
+		add_dsp_stats (reply, r.get());
+
+		lo_send_message (lo_message_get_source (msg), "#reply", reply);
+		lo_message_free (reply);
+
+		boost::shared_ptr<Processor> p;
+
+		for (uint32_t i = 0; (p = r->nth_processor (i)) != 0; ++i) {
+
+			reply = lo_message_new ();
+
+			lo_message_add_string (reply, "processor");
+			lo_message_add_int32 (reply, r->remote_control_id());
+			lo_message_add_string (reply, p->name().c_str());
+			add_dsp_stats (reply, p.get());
+
+			lo_send_message (lo_message_get_source (msg), "#reply", reply);
+			lo_message_free (reply);
+		}
+	}
+
+	lo_message reply = lo_message_new ();
+
+	lo_message_add_string (reply, "end_dsp_profile");
+
+	lo_send_message (lo_message_get_source (msg), "#reply", reply);
+
+	lo_message_free (reply);
+}
+
 void
 OSC::transport_frame (lo_message msg)
 {
@@ -121,6 +121,7 @@ class OSC : public ARDOUR::ControlProtocol, public AbstractUI<OSCUIRequest>
 	static int _catchall (const char *path, const char *types, lo_arg **argv, int argc, void *data, void *user_data);
 
 	void routes_list (lo_message msg);
+	void routes_dsp_profile (lo_message msg);
 	void transport_frame(lo_message msg);
 
 #define PATH_CALLBACK_MSG(name)					\
@@ -133,6 +134,7 @@ class OSC : public ARDOUR::ControlProtocol, public AbstractUI<OSCUIRequest>
 	}
 	
 	PATH_CALLBACK_MSG(routes_list);
+	PATH_CALLBACK_MSG(routes_dsp_profile);
 	PATH_CALLBACK_MSG(transport_frame);
 	
 #define PATH_CALLBACK(name) \